@@ -0,0 +1,496 @@
+/**
+ *******************************************************************************
+ * @file    bench_event_queue.c
+ * @brief   Event queue / broker microbenchmark and contention stress suite.
+ *          Measures push/pop throughput, latency percentiles and fairness
+ *          for 1-8 producers and 1-5 consumers and prints results as JSON.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "utils.h"
+
+#include "event.h"
+#include "event_queue.h"
+#include "event_broker.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define MAX_PRODUCERS               8
+#define MAX_CONSUMERS               5
+#define DEFAULT_EVENTS_PER_PRODUCER 20000
+#define NS_PER_SEC                  1000000000ULL
+
+STATIC_ASSERT(MAX_CONSUMERS <= COMPONENT_COUNT, 
+    "Every consumer has to be a distinct component");
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+/* 
+ * To benchmark another queue implementation, add an entry to g_impls. 
+ * init() is called before each scenario; push()/pop() must be thread-safe.
+ */
+typedef struct {
+    const char * name;
+    result_t (*init)( void );
+    result_t (*push)( event_t * e );
+    result_t (*pop)( sys_component_t c, event_t * e );
+} bench_queue_impl_t;
+
+typedef struct {
+    uint64_t push_ns;
+    uint32_t producer;
+    uint32_t seq;
+} bench_payload_t;
+
+typedef struct {
+    const bench_queue_impl_t * impl;
+    int producers;
+    int consumers;
+    size_t payload_size;
+    int events_per_producer;
+
+    pthread_barrier_t start;
+} bench_scenario_t;
+
+typedef struct {
+    bench_scenario_t * scenario;
+    int id;
+
+    uint64_t push_retries;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} producer_ctx_t;
+
+typedef struct {
+    bench_scenario_t * scenario;
+    int id;
+
+    uint64_t * latencies_ns;
+    size_t expected;
+    size_t received;
+    uint64_t pop_misses;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} consumer_ctx_t;
+
+typedef struct {
+    const char * name;
+    uint32_t type;
+    uint64_t config;
+    int fd;
+} perf_counter_t;
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static event_queue_t g_bench_queue;
+
+static perf_counter_t g_perf_counters[] = {
+    { "task_clock_ns",    PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,       -1 },
+    { "context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, -1 },
+    { "cpu_migrations",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS,   -1 },
+    { "cycles",           PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       -1 },
+    { "instructions",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     -1 },
+    { "cache_misses",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,     -1 },
+};
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+// === QUEUE IMPLEMENTATIONS ===
+
+static result_t impl_queue_init( void ) {
+    return event_queue_init(&g_bench_queue);
+}
+
+static result_t impl_queue_push( event_t * e ) {
+    return event_queue_push(&g_bench_queue, e);
+}
+
+static result_t impl_queue_pop( sys_component_t c, event_t * e ) {
+    return event_queue_pop(&g_bench_queue, c, e);
+}
+
+static const bench_queue_impl_t g_impls[] = {
+    { "event_queue", impl_queue_init, impl_queue_push, impl_queue_pop },
+    { "broker",      broker_init,     broker_publish,  broker_pop     },
+};
+
+// === TIME AND STATISTICS ===
+
+static uint64_t now_ns( void ) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u64( const void * a, const void * b ) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t percentile( const uint64_t * sorted, size_t n, double p ) {
+    if( n == 0 ) {
+        return 0;
+    }
+    size_t idx = (size_t)(p * (double)(n - 1) + 0.5);
+    return sorted[idx < n ? idx : n - 1];
+}
+
+// Jain's fairness index: 1.0 means perfectly fair, 1/n means one takes all
+static double jain_index( const double * x, int n ) {
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    for( int i = 0; i < n; i++ ) {
+        sum += x[i];
+        sum_sq += x[i] * x[i];
+    }
+    return (sum_sq > 0.0) ? (sum * sum) / ((double)n * sum_sq) : 1.0;
+}
+
+// === PERF COUNTERS ===
+
+static void perf_counters_open( void ) {
+    for( size_t i = 0; i < NELEMS(g_perf_counters); i++ ) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = g_perf_counters[i].type;
+        attr.config = g_perf_counters[i].config;
+        attr.disabled = 1;
+        attr.inherit = 1;           // Count worker threads spawned later on
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        g_perf_counters[i].fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+}
+
+static void perf_counters_start( void ) {
+    for( size_t i = 0; i < NELEMS(g_perf_counters); i++ ) {
+        if( g_perf_counters[i].fd >= 0 ) {
+            ioctl(g_perf_counters[i].fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(g_perf_counters[i].fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+static void perf_counters_stop_and_print( FILE * out ) {
+    fprintf(out, "\"perf\": {");
+    for( size_t i = 0; i < NELEMS(g_perf_counters); i++ ) {
+        uint64_t value = 0;
+        int fd = g_perf_counters[i].fd;
+        fprintf(out, "%s\"%s\": ", (i > 0) ? ", " : "", g_perf_counters[i].name);
+        if( fd >= 0 && ioctl(fd, PERF_EVENT_IOC_DISABLE, 0) == 0 && 
+                read(fd, &value, sizeof(value)) == (ssize_t)sizeof(value) ) {
+            fprintf(out, "%llu", (unsigned long long)value);
+        } else {
+            fprintf(out, "null");
+        }
+    }
+    fprintf(out, "}");
+}
+
+static void perf_counters_close( void ) {
+    for( size_t i = 0; i < NELEMS(g_perf_counters); i++ ) {
+        if( g_perf_counters[i].fd >= 0 ) {
+            close(g_perf_counters[i].fd);
+            g_perf_counters[i].fd = -1;
+        }
+    }
+}
+
+// === WORKERS ===
+
+static void * producer_thread( void * arg ) {
+    producer_ctx_t * ctx = (producer_ctx_t *)arg;
+    bench_scenario_t * s = ctx->scenario;
+
+    uint8_t data[EVENT_MAX_DATA_SIZE] = {0};
+    size_t data_size = s->payload_size > sizeof(bench_payload_t) ? 
+        s->payload_size : sizeof(bench_payload_t);
+
+    pthread_barrier_wait(&s->start);
+    ctx->start_ns = now_ns();
+
+    for( int i = 0; i < s->events_per_producer; i++ ) {
+        event_t e;
+        bench_payload_t payload = {
+            .producer = (uint32_t)ctx->id,
+            .seq = (uint32_t)i
+        };
+        sys_component_t dest = (sys_component_t)(i % s->consumers);
+
+        payload.push_ns = now_ns();
+        memcpy(data, &payload, sizeof(payload));
+        event_create(COMPONENT_CONTROLS, dest, EVENT_BUT_PRESSED, 
+            data, data_size, &e);
+
+        while( s->impl->push(&e) != RES_OK ) {
+            ctx->push_retries++;
+            sched_yield();
+        }
+    }
+
+    ctx->end_ns = now_ns();
+
+    return NULL;
+}
+
+static void * consumer_thread( void * arg ) {
+    consumer_ctx_t * ctx = (consumer_ctx_t *)arg;
+    bench_scenario_t * s = ctx->scenario;
+
+    pthread_barrier_wait(&s->start);
+    ctx->start_ns = now_ns();
+
+    while( ctx->received < ctx->expected ) {
+        event_t e;
+        if( s->impl->pop((sys_component_t)ctx->id, &e) != RES_OK ) {
+            ctx->pop_misses++;
+            sched_yield();
+            continue;
+        }
+
+        bench_payload_t payload;
+        memcpy(&payload, e.data, sizeof(payload));
+        ctx->latencies_ns[ctx->received++] = now_ns() - payload.push_ns;
+    }
+
+    ctx->end_ns = now_ns();
+
+    return NULL;
+}
+
+// === SCENARIO ===
+
+static result_t run_scenario( bench_scenario_t * s, bool * first, FILE * out ) {
+    producer_ctx_t producers[MAX_PRODUCERS];
+    consumer_ctx_t consumers[MAX_CONSUMERS];
+    pthread_t threads[MAX_PRODUCERS + MAX_CONSUMERS];
+    size_t total = (size_t)s->producers * (size_t)s->events_per_producer;
+
+    RETURN_ON_ERROR( s->impl->init() );
+
+    uint64_t * latencies = malloc(total * sizeof(uint64_t));
+    RETURN_IF_NULL(latencies);
+    pthread_barrier_init(&s->start, NULL, (unsigned)(s->producers + s->consumers));
+
+    // Producer p sends its i-th event to consumer (i % consumers)
+    size_t offset = 0;
+    for( int c = 0; c < s->consumers; c++ ) {
+        size_t per_producer = (size_t)(s->events_per_producer / s->consumers) + 
+            ((c < s->events_per_producer % s->consumers) ? 1 : 0);
+        consumers[c] = (consumer_ctx_t) {
+            .scenario = s,
+            .id = c,
+            .latencies_ns = &latencies[offset],
+            .expected = per_producer * (size_t)s->producers
+        };
+        offset += consumers[c].expected;
+    }
+    for( int p = 0; p < s->producers; p++ ) {
+        producers[p] = (producer_ctx_t) { .scenario = s, .id = p };
+    }
+
+    perf_counters_start();
+    uint64_t start_ns = now_ns();
+
+    int n_threads = 0;
+    for( int c = 0; c < s->consumers; c++ ) {
+        pthread_create(&threads[n_threads++], NULL, consumer_thread, &consumers[c]);
+    }
+    for( int p = 0; p < s->producers; p++ ) {
+        pthread_create(&threads[n_threads++], NULL, producer_thread, &producers[p]);
+    }
+    for( int t = 0; t < n_threads; t++ ) {
+        pthread_join(threads[t], NULL);
+    }
+
+    uint64_t duration_ns = now_ns() - start_ns;
+    pthread_barrier_destroy(&s->start);
+
+    // Statistics
+    double producer_rates[MAX_PRODUCERS];
+    double consumer_rates[MAX_CONSUMERS];
+    uint64_t push_retries = 0;
+    uint64_t pop_misses = 0;
+    for( int p = 0; p < s->producers; p++ ) {
+        uint64_t ns = producers[p].end_ns - producers[p].start_ns;
+        producer_rates[p] = (double)s->events_per_producer / ((double)(ns ? ns : 1) / NS_PER_SEC);
+        push_retries += producers[p].push_retries;
+    }
+    for( int c = 0; c < s->consumers; c++ ) {
+        uint64_t ns = consumers[c].end_ns - consumers[c].start_ns;
+        consumer_rates[c] = (double)consumers[c].received / ((double)(ns ? ns : 1) / NS_PER_SEC);
+        pop_misses += consumers[c].pop_misses;
+    }
+
+    uint64_t sum_ns = 0;
+    for( size_t i = 0; i < total; i++ ) {
+        sum_ns += latencies[i];
+    }
+    qsort(latencies, total, sizeof(uint64_t), compare_u64);
+
+    fprintf(out, "%s\n    {\"impl\": \"%s\", \"producers\": %d, \"consumers\": %d, "
+        "\"payload_bytes\": %zu, \"events\": %zu, \"duration_ns\": %llu, "
+        "\"throughput_eps\": %.1f, ",
+        *first ? "" : ",", s->impl->name, s->producers, s->consumers, 
+        s->payload_size, total, (unsigned long long)duration_ns,
+        (double)total / ((double)duration_ns / NS_PER_SEC));
+    fprintf(out, "\"latency_ns\": {\"mean\": %llu, \"p50\": %llu, \"p99\": %llu, "
+        "\"p999\": %llu, \"max\": %llu}, ",
+        (unsigned long long)(sum_ns / total),
+        (unsigned long long)percentile(latencies, total, 0.50),
+        (unsigned long long)percentile(latencies, total, 0.99),
+        (unsigned long long)percentile(latencies, total, 0.999),
+        (unsigned long long)latencies[total - 1]);
+    fprintf(out, "\"fairness\": {\"producers_jain\": %.4f, \"consumers_jain\": %.4f}, ",
+        jain_index(producer_rates, s->producers), 
+        jain_index(consumer_rates, s->consumers));
+    fprintf(out, "\"contention\": {\"push_retries\": %llu, \"pop_misses\": %llu}, ",
+        (unsigned long long)push_retries, (unsigned long long)pop_misses);
+    perf_counters_stop_and_print(out);
+    fprintf(out, "}");
+    fflush(out);
+
+    *first = false;
+    free(latencies);
+
+    return RES_OK;
+}
+
+static int parse_list( const char * arg, int * values, int max_values ) {
+    int n = 0;
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for( char * tok = strtok(buf, ","); tok && n < max_values; tok = strtok(NULL, ",") ) {
+        values[n++] = atoi(tok);
+    }
+    return n;
+}
+
+static void print_usage( const char * prog ) {
+    fprintf(stderr, 
+        "Usage: %s [-i impl] [-p producers] [-c consumers] [-s payload_sizes] "
+        "[-n events_per_producer] [-o output.json]\n"
+        "  Lists are comma separated, e.g. -p 1,2,4,8 -c 1,3,5 -s 0,128,512\n"
+        "  Implementations:", prog);
+    for( size_t i = 0; i < NELEMS(g_impls); i++ ) {
+        fprintf(stderr, " %s", g_impls[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+/*****************
+ * MAIN FUNCTION *
+ *****************/
+
+int main( int argc, char * argv[] ) {
+    int producers[MAX_PRODUCERS] = { 1, 2, 4, 8 };
+    int n_producers = 4;
+    int consumers[MAX_CONSUMERS] = { 1, 3, 5 };
+    int n_consumers = 3;
+    int payloads[8] = { 0, 128, EVENT_MAX_DATA_SIZE };
+    int n_payloads = 3;
+    int events_per_producer = DEFAULT_EVENTS_PER_PRODUCER;
+    const char * impl_filter = NULL;
+    FILE * out = stdout;
+
+    int opt;
+    while( (opt = getopt(argc, argv, "i:p:c:s:n:o:h")) != -1 ) {
+        switch( opt ) {
+            case 'i': impl_filter = optarg; break;
+            case 'p': n_producers = parse_list(optarg, producers, MAX_PRODUCERS); break;
+            case 'c': n_consumers = parse_list(optarg, consumers, MAX_CONSUMERS); break;
+            case 's': n_payloads = parse_list(optarg, payloads, (int)NELEMS(payloads)); break;
+            case 'n': events_per_producer = atoi(optarg); break;
+            case 'o': 
+                out = fopen(optarg, "w");
+                if( !out ) {
+                    perror(optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if( events_per_producer <= 0 ) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    perf_counters_open();
+
+    fprintf(out, "{\"benchmark\": \"event_queue\", \"queue_size\": %d, "
+        "\"max_data_size\": %d, \"results\": [", 
+        EVENT_QUEUE_SIZE, EVENT_MAX_DATA_SIZE);
+
+    bool first = true;
+    for( size_t i = 0; i < NELEMS(g_impls); i++ ) {
+        if( impl_filter && strcmp(impl_filter, g_impls[i].name) != 0 ) {
+            continue;
+        }
+
+        for( int p = 0; p < n_producers; p++ ) {
+            for( int c = 0; c < n_consumers; c++ ) {
+                for( int s = 0; s < n_payloads; s++ ) {
+                    if( producers[p] < 1 || producers[p] > MAX_PRODUCERS ||
+                            consumers[c] < 1 || consumers[c] > MAX_CONSUMERS ||
+                            payloads[s] < 0 || payloads[s] > EVENT_MAX_DATA_SIZE ) {
+                        fprintf(stderr, "Skipping invalid scenario p=%d c=%d s=%d\n",
+                            producers[p], consumers[c], payloads[s]);
+                        continue;
+                    }
+
+                    bench_scenario_t scenario = {
+                        .impl = &g_impls[i],
+                        .producers = producers[p],
+                        .consumers = consumers[c],
+                        .payload_size = (size_t)payloads[s],
+                        .events_per_producer = events_per_producer
+                    };
+                    if( run_scenario(&scenario, &first, out) != RES_OK ) {
+                        fprintf(stderr, "Scenario failed: %s p=%d c=%d s=%d\n", 
+                            g_impls[i].name, producers[p], consumers[c], payloads[s]);
+                    }
+                }
+            }
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+
+    perf_counters_close();
+    if( out != stdout ) {
+        fclose(out);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -4565,6 +4565,223 @@ uint8_t st7789_write_string(st7789_handle_t *handle, uint16_t x, uint16_t y, cha
     return 0;                                                                /* success return 0 */
 }
 
+/**
+ * @brief         put a pixel to the inner buffer
+ * @param[in]     *handle pointer to an st7789 handle structure
+ * @param[in,out] *offset pointer to a buffer offset
+ * @param[in]     pixel pixel index in the run
+ * @param[in]     color pixel color
+ * @note          rgb444 packs two pixels into three bytes
+ */
+static void a_st7789_put_pixel(st7789_handle_t *handle, uint32_t *offset, uint32_t pixel, uint32_t color)
+{
+    uint32_t i = *offset;
+
+    if ((handle->format & 0x03) == 0x03)                                     /* rgb444 */
+    {
+        if ((pixel % 2) == 0)                                                /* first pixel */
+        {
+            handle->buf[i] = (uint8_t)((((color >> 8) & 0xF) << 4) |
+                                       (((color >> 4) & 0xF) << 0));         /* set the color */
+            handle->buf[i + 1] = (uint8_t)(((color >> 0) & 0xF) << 4);       /* set the color */
+            *offset = i + 1;                                                 /* shared byte */
+        }
+        else                                                                 /* second pixel */
+        {
+            handle->buf[i] |= (uint8_t)(((color >> 8) & 0xF) << 0);          /* set the color */
+            handle->buf[i + 1] = (uint8_t)((((color >> 4) & 0xF) << 4) |
+                                           (((color >> 0) & 0xF) << 0));     /* set the color */
+            *offset = i + 2;                                                 /* next pair */
+        }
+    }
+    else if ((handle->format & 0x05) == 0x05)                                /* rgb565 */
+    {
+        handle->buf[i] = (uint8_t)((color >> 8) & 0xFF);                     /* set the color */
+        handle->buf[i + 1] = (uint8_t)((color >> 0) & 0xFF);                 /* set the color */
+        *offset = i + 2;                                                     /* next pixel */
+    }
+    else                                                                     /* rgb666 */
+    {
+        handle->buf[i] = (uint8_t)(((color >> 12) & 0x3F) << 2);             /* set the color */
+        handle->buf[i + 1] = (uint8_t)(((color >> 6) & 0x3F) << 2);          /* set the color */
+        handle->buf[i + 2] = (uint8_t)(((color >> 0) & 0x3F) << 2);          /* set the color */
+        *offset = i + 3;                                                     /* next pixel */
+    }
+}
+
+/**
+ * @brief     get a font glyph
+ * @param[in] chr printable ascii char
+ * @param[in] font string font
+ * @return    pointer to the glyph, NULL if the font is invalid
+ * @note      glyph is stored column by column, msb on top
+ */
+static const uint8_t *a_st7789_glyph(char chr, st7789_font_t font)
+{
+    uint8_t index = (uint8_t)(chr - ' ');                                    /* get index */
+
+    if (font == ST7789_FONT_12)                                              /* if size 12 */
+    {
+        return gsc_st7789_ascii_1206[index];                                 /* get ascii 1206 */
+    }
+    else if (font == ST7789_FONT_16)                                         /* if size 16 */
+    {
+        return gsc_st7789_ascii_1608[index];                                 /* get ascii 1608 */
+    }
+    else if (font == ST7789_FONT_24)                                         /* if size 24 */
+    {
+        return gsc_st7789_ascii_2412[index];                                 /* get ascii 2412 */
+    }
+    else
+    {
+        return NULL;                                                         /* invalid font */
+    }
+}
+
+/**
+ * @brief     flush the inner buffer to the display memory
+ * @param[in] *handle pointer to an st7789 handle structure
+ * @param[in] len buffer length
+ * @param[in] first 1 for the first chunk of the window
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ */
+static uint8_t a_st7789_flush_run(st7789_handle_t *handle, uint32_t len, uint8_t first)
+{
+    if (first != 0)                                                          /* first chunk */
+    {
+        return st7789_memory_write(handle, handle->buf, (uint16_t)len);      /* memory write */
+    }
+    else
+    {
+        return st7789_memory_continue_write(handle, handle->buf, (uint16_t)len); /* memory continue write */
+    }
+}
+
+/**
+ * @brief     write a string line with background in the display
+ * @param[in] *handle pointer to an st7789 handle structure
+ * @param[in] x coordinate x
+ * @param[in] y coordinate y
+ * @param[in] *str pointer to a write string address
+ * @param[in] len length of the string
+ * @param[in] color display color
+ * @param[in] background background color
+ * @param[in] font string font
+ * @return    status code
+ *            - 0 success
+ *            - 1 write string failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 x or y is invalid
+ *            - 5 font is invalid
+ * @note      x < column && y + font <= row, string stops at the first not
+ *            printable char and is clipped at the right edge instead of
+ *            wrapped, one address window is set for the whole line
+ */
+uint8_t st7789_write_string_fast(st7789_handle_t *handle, uint16_t x, uint16_t y, char *str, uint16_t len,
+                                 uint32_t color, uint32_t background, st7789_font_t font)
+{
+    uint16_t chars;
+    uint16_t width;
+    uint16_t row;
+    uint16_t col;
+    uint16_t c;
+    uint8_t col_bytes;
+    uint8_t first;
+    uint32_t pixel;
+    uint32_t offset;
+    const uint8_t *glyph;
+
+    if (handle == NULL)                                                      /* check handle */
+    {
+        return 2;                                                            /* return error */
+    }
+    if (handle->inited != 1)                                                 /* check handle initialization */
+    {
+        return 3;                                                            /* return error */
+    }
+    if ((x >= handle->column) || ((uint32_t)y + (uint32_t)font > handle->row)) /* check x, y */
+    {
+        handle->debug_print("st7789: x or y is invalid.\n");                 /* x or y is invalid */
+
+        return 4;                                                            /* return error */
+    }
+    if (a_st7789_glyph(' ', font) == NULL)                                   /* check font */
+    {
+        handle->debug_print("st7789: font is invalid.\n");                   /* font is invalid */
+
+        return 5;                                                            /* return error */
+    }
+
+    chars = 0;                                                               /* init 0 */
+    while ((chars < len) && (str[chars] >= ' ') && (str[chars] <= '~'))      /* printable run */
+    {
+        chars++;                                                             /* chars++ */
+    }
+    if (chars > (handle->column - x) / (font / 2))                           /* clip at right edge */
+    {
+        chars = (uint16_t)((handle->column - x) / (font / 2));               /* set chars */
+    }
+    if (chars == 0)                                                          /* nothing to write */
+    {
+        return 0;                                                            /* success return 0 */
+    }
+    width = (uint16_t)(chars * (font / 2));                                  /* line width */
+    col_bytes = (uint8_t)(font / 8 + ((font % 8) ? 1 : 0));                  /* bytes per glyph column */
+
+    if (st7789_set_column_address(handle, x, (uint16_t)(x + width - 1)) != 0) /* set column window */
+    {
+        return 1;                                                            /* return error */
+    }
+    if (st7789_set_row_address(handle, y, (uint16_t)(y + font - 1)) != 0)   /* set row window */
+    {
+        return 1;                                                            /* return error */
+    }
+
+    first = 1;                                                               /* first chunk */
+    offset = 0;                                                              /* init 0 */
+    pixel = 0;                                                               /* init 0 */
+    for (row = 0; row < (uint16_t)font; row++)                               /* window is filled row by row */
+    {
+        for (c = 0; c < chars; c++)                                          /* all chars */
+        {
+            glyph = a_st7789_glyph(str[c], font);                            /* get glyph */
+            for (col = 0; col < (uint16_t)(font / 2); col++)                 /* one glyph row */
+            {
+                if (((pixel % 2) == 0) && (offset + 3 > ST7789_BUFFER_SIZE)) /* buffer is full */
+                {
+                    if (a_st7789_flush_run(handle, offset, first) != 0)      /* flush */
+                    {
+                        handle->debug_print("st7789: write data failed.\n"); /* write data failed */
+
+                        return 1;                                            /* return error */
+                    }
+                    first = 0;                                               /* continue write */
+                    offset = 0;                                              /* reset offset */
+                }
+                a_st7789_put_pixel(handle, &offset, pixel,
+                                   ((glyph[col * col_bytes + row / 8] & (0x80 >> (row % 8))) != 0) ?
+                                   color : background);                      /* put pixel */
+                pixel++;                                                     /* pixel++ */
+            }
+        }
+    }
+    if ((pixel % 2) != 0)                                                    /* rgb444 half pair */
+    {
+        offset += ((handle->format & 0x03) == 0x03) ? 1 : 0;                 /* send the shared byte */
+    }
+    if (a_st7789_flush_run(handle, offset, first) != 0)                      /* flush the last */
+    {
+        handle->debug_print("st7789: write data failed.\n");                 /* write data failed */
+
+        return 1;                                                            /* return error */
+    }
+
+    return 0;                                                                /* success return 0 */
+}
+
 /**
  * @brief     draw a point in the display
  * @param[in] *handle pointer to an st7789 handle structure
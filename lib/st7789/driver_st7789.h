@@ -821,6 +821,30 @@ uint8_t st7789_draw_point(st7789_handle_t *handle, uint16_t x, uint16_t y, uint3
  */
 uint8_t st7789_write_string(st7789_handle_t *handle, uint16_t x, uint16_t y, char *str, uint16_t len, uint32_t color, st7789_font_t font);
 
+/**
+ * @brief     write a string line with background in the display
+ * @param[in] *handle pointer to an st7789 handle structure
+ * @param[in] x coordinate x
+ * @param[in] y coordinate y
+ * @param[in] *str pointer to a write string address
+ * @param[in] len length of the string
+ * @param[in] color display color
+ * @param[in] background background color
+ * @param[in] font string font
+ * @return    status code
+ *            - 0 success
+ *            - 1 write string failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 x or y is invalid
+ *            - 5 font is invalid
+ * @note      x < column && y + font <= row, string stops at the first not
+ *            printable char and is clipped at the right edge instead of
+ *            wrapped, one address window is set for the whole line
+ */
+uint8_t st7789_write_string_fast(st7789_handle_t *handle, uint16_t x, uint16_t y, char *str, uint16_t len,
+                                 uint32_t color, uint32_t background, st7789_font_t font);
+
 /**
  * @brief     fill the rect
  * @param[in] *handle pointer to an st7789 handle structure
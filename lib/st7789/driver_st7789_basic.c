@@ -698,6 +698,42 @@ uint8_t st7789_basic_display_off(void)
     return 0;
 }
 
+/**
+ * @brief  basic example idle mode on
+ * @return status code
+ *         - 0 success
+ *         - 1 idle mode on failed
+ * @note   frame memory is kept, it is shown with 8 colors only
+ */
+uint8_t st7789_basic_idle_mode_on(void)
+{
+    /* idle mode on */
+    if (st7789_idle_mode_on(&gs_handle) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  basic example idle mode off
+ * @return status code
+ *         - 0 success
+ *         - 1 idle mode off failed
+ * @note   none
+ */
+uint8_t st7789_basic_idle_mode_off(void)
+{
+    /* idle mode off */
+    if (st7789_idle_mode_off(&gs_handle) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
 /**
  * @brief     basic example draw a string
  * @param[in] x coordinate x
@@ -722,6 +758,32 @@ uint8_t st7789_basic_string(uint16_t x, uint16_t y, char *str, uint16_t len, uin
     return 0;
 }
 
+/**
+ * @brief     basic example draw a string line with background
+ * @param[in] x coordinate x
+ * @param[in] y coordinate y
+ * @param[in] *str pointer to a written string address
+ * @param[in] len length of the string
+ * @param[in] color display color
+ * @param[in] background background color
+ * @param[in] font display font size
+ * @return    status code
+ *            - 0 success
+ *            - 1 draw string failed
+ * @note      string is clipped at the right edge
+ */
+uint8_t st7789_basic_string_fast(uint16_t x, uint16_t y, char *str, uint16_t len, uint32_t color,
+                                 uint32_t background, st7789_font_t font)
+{
+    /* write string line */
+    if (st7789_write_string_fast(&gs_handle, x, y, str, len, color, background, font) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
 /**
  * @brief     basic example write a point
  * @param[in] x coordinate x
@@ -193,6 +193,24 @@ uint8_t st7789_basic_display_on(void);
  */
 uint8_t st7789_basic_display_off(void);
 
+/**
+ * @brief  basic example idle mode on
+ * @return status code
+ *         - 0 success
+ *         - 1 idle mode on failed
+ * @note   frame memory is kept, it is shown with 8 colors only
+ */
+uint8_t st7789_basic_idle_mode_on(void);
+
+/**
+ * @brief  basic example idle mode off
+ * @return status code
+ *         - 0 success
+ *         - 1 idle mode off failed
+ * @note   none
+ */
+uint8_t st7789_basic_idle_mode_off(void);
+
 /**
  * @brief     basic example draw a string
  * @param[in] x coordinate x
@@ -208,6 +226,23 @@ uint8_t st7789_basic_display_off(void);
  */
 uint8_t st7789_basic_string(uint16_t x, uint16_t y, char *str, uint16_t len, uint32_t color, st7789_font_t font);
 
+/**
+ * @brief     basic example draw a string line with background
+ * @param[in] x coordinate x
+ * @param[in] y coordinate y
+ * @param[in] *str pointer to a written string address
+ * @param[in] len length of the string
+ * @param[in] color display color
+ * @param[in] background background color
+ * @param[in] font display font size
+ * @return    status code
+ *            - 0 success
+ *            - 1 draw string failed
+ * @note      string is clipped at the right edge
+ */
+uint8_t st7789_basic_string_fast(uint16_t x, uint16_t y, char *str, uint16_t len, uint32_t color,
+                                 uint32_t background, st7789_font_t font);
+
 /**
  * @brief     basic example write a point
  * @param[in] x coordinate x
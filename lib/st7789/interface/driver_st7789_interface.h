@@ -59,6 +59,30 @@ extern "C"{
  */
 uint8_t st7789_interface_spi_init(void);
 
+/**
+ * @brief     interface spi bus clock set
+ * @param[in] freq spi clock frequency in Hz
+ * @return    status code
+ *            - 0 success
+ *            - 1 set failed
+ * @note      applied at once if the bus is initialized, else by the next init
+ */
+uint8_t st7789_interface_spi_set_clock(uint32_t freq);
+
+/**
+ * @brief      interface spi bus write read
+ * @param[in]  *in_buf pointer to an input buffer
+ * @param[in]  in_len input length
+ * @param[out] *out_buf pointer to an output buffer
+ * @param[in]  out_len output length
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       none
+ */
+uint8_t st7789_interface_spi_write_read(uint8_t *in_buf, uint32_t in_len, 
+                                        uint8_t *out_buf, uint32_t out_len);
+
 /**
  * @brief  interface spi bus deinit
  * @return status code
@@ -88,6 +88,17 @@ uint8_t spi_init(char *name, int *fd, spi_mode_type_t mode, uint32_t freq);
  */
 uint8_t spi_deinit(int fd);
 
+/**
+ * @brief     spi bus frequency set
+ * @param[in] fd is the spi handle
+ * @param[in] freq is the spi clock frequency
+ * @return    status code
+ *            - 0 success
+ *            - 1 set failed
+ * @note      none
+ */
+uint8_t spi_set_freq(int fd, uint32_t freq);
+
 /**
  * @brief      spi bus read command
  * @param[in]  fd is the spi handle
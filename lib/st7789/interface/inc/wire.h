@@ -74,7 +74,7 @@ uint8_t wire_deinit(void);
  * @return     status code
  *             - 0 success
  *             - 1 read failed
- * @note       none
+ * @note       the line stays an output, so the driven value is read
  */
 uint8_t wire_read(uint8_t *value);
 
@@ -44,11 +44,26 @@
  */
 #define SPI_DEVICE_NAME "/dev/spidev0.0"    /**< spi device name */
 
+/**
+ * @brief spi default clock definition
+ */
+#define SPI_DEFAULT_CLOCK (1000 * 1000 * 8) /**< 8 MHz */
+
 /**
  * @brief spi device handle definition
  */
 static int gs_fd;                           /**< spi handle */
 
+/**
+ * @brief spi clock definition
+ */
+static uint32_t gs_spi_clock = SPI_DEFAULT_CLOCK; /**< spi clock in Hz */
+
+/**
+ * @brief spi init flag definition
+ */
+static uint8_t gs_spi_inited = 0;           /**< spi init flag */
+
 /**
  * @brief  interface spi bus init
  * @return status code
@@ -58,7 +73,32 @@ static int gs_fd;                           /**< spi handle */
  */
 uint8_t st7789_interface_spi_init(void)
 {
-    return spi_init(SPI_DEVICE_NAME, &gs_fd, SPI_MODE_TYPE_3, 1000 * 1000 * 8);
+    if (spi_init(SPI_DEVICE_NAME, &gs_fd, SPI_MODE_TYPE_3, gs_spi_clock) != 0)
+    {
+        return 1;
+    }
+    gs_spi_inited = 1;
+    
+    return 0;
+}
+
+/**
+ * @brief     interface spi bus clock set
+ * @param[in] freq spi clock frequency in Hz
+ * @return    status code
+ *            - 0 success
+ *            - 1 set failed
+ * @note      applied at once if the bus is initialized, else by the next init
+ */
+uint8_t st7789_interface_spi_set_clock(uint32_t freq)
+{
+    gs_spi_clock = freq;
+    if (gs_spi_inited == 0)
+    {
+        return 0;
+    }
+    
+    return spi_set_freq(gs_fd, freq);
 }
 
 /**
@@ -70,6 +110,8 @@ uint8_t st7789_interface_spi_init(void)
  */
 uint8_t st7789_interface_spi_deinit(void)
 {
+    gs_spi_inited = 0;
+    
     return spi_deinit(gs_fd);
 }
 
@@ -87,6 +129,23 @@ uint8_t st7789_interface_spi_write_cmd(uint8_t *buf, uint16_t len)
     return spi_write_cmd(gs_fd, buf, len);
 }
 
+/**
+ * @brief      interface spi bus write read
+ * @param[in]  *in_buf pointer to an input buffer
+ * @param[in]  in_len input length
+ * @param[out] *out_buf pointer to an output buffer
+ * @param[in]  out_len output length
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       none
+ */
+uint8_t st7789_interface_spi_write_read(uint8_t *in_buf, uint32_t in_len, 
+                                        uint8_t *out_buf, uint32_t out_len)
+{
+    return spi_write_read(gs_fd, in_buf, in_len, out_buf, out_len);
+}
+
 /**
  * @brief     interface delay ms
  * @param[in] ms time
@@ -48,24 +48,42 @@
 #define GPIO_DEVICE_LINE 17                      /**< gpio device line */
 #define GPIO_DEVICE_CLOCK_LINE 27                /**< gpio device clock line */
 
+/**
+ * @brief gpio bulk index definition
+ */
+#define WIRE_INDEX_LINE       0                  /**< line index in bulk */
+#define WIRE_INDEX_CLOCK_LINE 1                  /**< clock line index in bulk */
+#define WIRE_LINES            2                  /**< lines in bulk */
+
 /**
  * @brief global var definition
  */
 static struct gpiod_chip *gs_chip;               /**< gpio chip handle */
-static struct gpiod_line *gs_line;               /**< gpio line handle */
-static struct gpiod_chip *gs_clock_chip;         /**< gpio clock chip handle */
-static struct gpiod_line *gs_clock_line;         /**< gpio clock line handle */
-static volatile uint8_t gs_read_write_flag;      /**< read write flag */
+static struct gpiod_line_bulk gs_bulk;           /**< gpio lines handle */
+static int gs_values[WIRE_LINES];                /**< cached line values */
+static uint8_t gs_users;                         /**< users bit mask */
 
 /**
- * @brief  wire bus init
- * @return status code
- *         - 0 success
- *         - 1 init failed
- * @note   none
+ * @brief     request both lines once
+ * @param[in] index is the user line index
+ * @return    status code
+ *            - 0 success
+ *            - 1 request failed
+ * @note      both lines are requested as outputs set high,
+ *            the second user only gets its line marked as used
  */
-uint8_t wire_init(void)
+static uint8_t a_wire_request(uint8_t index)
 {
+    unsigned int offsets[WIRE_LINES] = {GPIO_DEVICE_LINE, GPIO_DEVICE_CLOCK_LINE};
+    
+    /* check requested */
+    if (gs_users != 0)
+    {
+        gs_users |= (uint8_t)(1U << index);
+        
+        return 0;
+    }
+    
     /* open the gpio group */
     gs_chip = gpiod_chip_open(GPIO_DEVICE_NAME);
     if (gs_chip == NULL)
@@ -75,9 +93,8 @@ uint8_t wire_init(void)
         return 1;
     }
     
-    /* get the gpio line */
-    gs_line = gpiod_chip_get_line(gs_chip, GPIO_DEVICE_LINE);
-    if (gs_line == NULL) 
+    /* get the gpio lines */
+    if (gpiod_chip_get_lines(gs_chip, offsets, WIRE_LINES, &gs_bulk) != 0) 
     {
         perror("gpio: get line failed.\n");
         gpiod_chip_close(gs_chip);
@@ -85,8 +102,87 @@ uint8_t wire_init(void)
         return 1;
     }
     
+    /* set output high */
+    gs_values[WIRE_INDEX_LINE] = 1;
+    gs_values[WIRE_INDEX_CLOCK_LINE] = 1;
+    if (gpiod_line_request_bulk_output(&gs_bulk, "gpio_output", gs_values) != 0)
+    {
+        perror("gpio: request output failed.\n");
+        gpiod_chip_close(gs_chip);
+        
+        return 1;
+    }
+    
     /* set the flag */
-    gs_read_write_flag = 2;
+    gs_users = (uint8_t)(1U << index);
+    
+    return 0;
+}
+
+/**
+ * @brief     release both lines after the last user
+ * @param[in] index is the user line index
+ * @note      none
+ */
+static void a_wire_release(uint8_t index)
+{
+    /* check the flag */
+    if (gs_users == 0)
+    {
+        return;
+    }
+    gs_users &= (uint8_t)~(1U << index);
+    if (gs_users != 0)
+    {
+        return;
+    }
+    
+    /* release and close the chip */
+    gpiod_line_release_bulk(&gs_bulk);
+    gpiod_chip_close(gs_chip);
+}
+
+/**
+ * @brief     write a line if its value changes
+ * @param[in] index is the line index
+ * @param[in] value is the write data
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      the cached value makes repeated writes free of syscalls
+ */
+static uint8_t a_wire_set(uint8_t index, uint8_t value)
+{
+    /* check the cache */
+    if (gs_values[index] == (int)value)
+    {
+        return 0;
+    }
+    
+    /* set the value */
+    if (gpiod_line_set_value(gpiod_line_bulk_get_line(&gs_bulk, index), value) != 0)
+    {
+        return 1;
+    }
+    gs_values[index] = (int)value;
+    
+    return 0;
+}
+
+/**
+ * @brief  wire bus init
+ * @return status code
+ *         - 0 success
+ *         - 1 init failed
+ * @note   none
+ */
+uint8_t wire_init(void)
+{
+    /* request the lines */
+    if (a_wire_request(WIRE_INDEX_LINE) != 0)
+    {
+        return 1;
+    }
     
     /* set high */
     return wire_write(1);
@@ -100,8 +196,8 @@ uint8_t wire_init(void)
  */
 uint8_t wire_deinit(void)
 {
-    /* close the chip */
-    gpiod_chip_close(gs_chip);
+    /* release the lines */
+    a_wire_release(WIRE_INDEX_LINE);
     
     return 0;
 }
@@ -112,34 +208,14 @@ uint8_t wire_deinit(void)
  * @return     status code
  *             - 0 success
  *             - 1 read failed
- * @note       none
+ * @note       the line stays an output, so the driven value is read
  */
 uint8_t wire_read(uint8_t *value)
 {
     int res;
     
-    /* check the flag */
-    if (gs_read_write_flag != 0)
-    {
-        /* check requested */
-        if (gpiod_line_is_requested(gs_line) != 0) 
-        {
-            /* release */
-            gpiod_line_release(gs_line);
-        }
-        
-        /* set input */
-        if (gpiod_line_request_input(gs_line, "gpio_input") != 0) 
-        {
-            return 1;
-        }
-        
-        /* flag read */
-        gs_read_write_flag = 0;
-    }
-    
     /* read the value */
-    res = gpiod_line_get_value(gs_line);
+    res = gpiod_line_get_value(gpiod_line_bulk_get_line(&gs_bulk, WIRE_INDEX_LINE));
     if (res < 0)
     {
         return 1;
@@ -161,33 +237,7 @@ uint8_t wire_read(uint8_t *value)
  */
 uint8_t wire_write(uint8_t value)
 {
-    /* check the flag */
-    if (gs_read_write_flag != 1)
-    {
-        /* check requested */
-        if (gpiod_line_is_requested(gs_line) != 0) 
-        {
-            /* release */
-            gpiod_line_release(gs_line);
-        }
-        
-        /* set output */
-        if (gpiod_line_request_output(gs_line, "gpio_output", GPIOD_LINE_ACTIVE_STATE_HIGH) != 0)
-        {
-            return 1;
-        }
-        
-        /* flag write */
-        gs_read_write_flag = 1;
-    }
-    
-    /* set the value */
-    if (gpiod_line_set_value(gs_line, value) != 0)
-    {
-        return 1;
-    }
-    
-    return 0;
+    return a_wire_set(WIRE_INDEX_LINE, value);
 }
 
 /**
@@ -199,27 +249,8 @@ uint8_t wire_write(uint8_t value)
  */
 uint8_t wire_clock_init(void)
 {
-    /* open the gpio group */
-    gs_clock_chip = gpiod_chip_open(GPIO_DEVICE_NAME);
-    if (gs_clock_chip == NULL)
-    {
-        perror("gpio: open failed.\n");
-        
-        return 1;
-    }
-    
-    /* get the gpio line */
-    gs_clock_line = gpiod_chip_get_line(gs_clock_chip, GPIO_DEVICE_CLOCK_LINE);
-    if (gs_clock_line == NULL) 
-    {
-        perror("gpio: get line failed.\n");
-        gpiod_chip_close(gs_clock_chip);
-
-        return 1;
-    }
-    
-    /* set output */
-    if (gpiod_line_request_output(gs_clock_line, "gpio_output", GPIOD_LINE_ACTIVE_STATE_HIGH) != 0)
+    /* request the lines */
+    if (a_wire_request(WIRE_INDEX_CLOCK_LINE) != 0)
     {
         return 1;
     }
@@ -236,8 +267,8 @@ uint8_t wire_clock_init(void)
  */
 uint8_t wire_clock_deinit(void)
 {
-    /* close the chip */
-    gpiod_chip_close(gs_clock_chip);
+    /* release the lines */
+    a_wire_release(WIRE_INDEX_CLOCK_LINE);
     
     return 0;
 }
@@ -252,11 +283,5 @@ uint8_t wire_clock_deinit(void)
  */
 uint8_t wire_clock_write(uint8_t value)
 {
-    /* write the value */
-    if (gpiod_line_set_value(gs_clock_line, value) != 0)
-    {
-        return 1;
-    }
-    
-    return 0;
+    return a_wire_set(WIRE_INDEX_CLOCK_LINE, value);
 }
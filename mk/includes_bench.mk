@@ -0,0 +1,8 @@
+BENCH_LDFLAGS_EXTRA = -pthread
+BENCH_CFLAGS_EXTRA = \
+	-Isrc/utils \
+	-Isrc/event_broker
+BENCH_REQUIRED_SRCS := \
+	src/event_broker/event.c \
+	src/event_broker/event_queue.c \
+	src/event_broker/event_broker.c
@@ -1,10 +1,12 @@
 LDFLAGS_EXTRA = -pthread -lgpiod -lasound -lvosk -lcjson -lcurl
 CFLAGS_EXTRA = \
 	-Isrc/utils \
+	-Isrc/timer \
 	-Isrc/event_broker \
 	-Isrc/core \
 	-Isrc/controls \
 	-Isrc/display \
 	-Isrc/audio_input \
 	-Isrc/speech_to_text \
-	-Isrc/llm
\ No newline at end of file
+	-Isrc/llm \
+	-Isrc/config
\ No newline at end of file
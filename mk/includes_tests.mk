@@ -1,8 +1,39 @@
 TESTS_LDFLAGS_EXTRA = -lcmocka -lgcov
 TESTS_CFLAGS_EXTRA = \
 	-Isrc/utils \
-	-Isrc/event_broker
+	-Isrc/timer \
+	-Isrc/event_broker \
+	-Isrc/llm \
+	-Isrc/config \
+	-Isrc/controls \
+	-Isrc/display \
+	-Isrc/audio_input \
+	-Itests/utils \
+	-Ilib/st7789 \
+	-Ilib/st7789/interface
 TESTS_REQUIRED_SRCS := \
     src/event_broker/event.c \
 	src/event_broker/event_queue.c \
-	src/event_broker/event_broker.c
\ No newline at end of file
+	src/event_broker/event_broker.c \
+	src/timer/timer_service.c \
+	src/utils/cancel_token.c \
+	src/llm/answer_cache.c \
+	src/llm/think_filter.c \
+	src/config/config.c \
+	src/llm/ollama_request.c \
+	src/controls/gesture.c \
+	src/controls/controls_script.c \
+	src/display/font.c \
+	src/display/display.c \
+	src/display/display_hw.c \
+	src/display/text_layout.c \
+	src/display/fonts/font_pack_6x12.c \
+	src/audio_input/wav_writer.c \
+	src/audio_input/audio_input.c
+TESTS_REQUIRED_LIB_SRCS := \
+	lib/st7789/driver_st7789.c \
+	lib/st7789/driver_st7789_basic.c
+TESTS_SUPPORT_SRCS := \
+	tests/display/fake_st7789.c \
+	tests/audio_input/fake_rec_ops.c \
+	tests/utils/temp_file.c
\ No newline at end of file
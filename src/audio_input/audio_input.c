@@ -18,18 +18,21 @@
 #include <errno.h>
 
 #include "utils.h"
+#include "cancel_token.h"
+#include "config.h"
 
 #include "audio_input.h"
 #include "audio_input_rec_ops.h"
 #include "event_broker.h"
+#include "timer_service.h"
 
 /******************************
  * PRIVATE MACROS AND DEFINES *
  ******************************/
 
 #define DEFAULT_REC_FOLDER      "data"
-#define DEFAULT_MAX_REC_DUR_S   60      // TODO: make it configurable
 #define MAX_FILEPATH_SIZE       512
+#define REC_PROGRESS_PERIOD_MS  500
 
 /********************
  * PRIVATE TYPEDEFS *
@@ -46,8 +49,9 @@ typedef struct {
     char wav_filepath[MAX_FILEPATH_SIZE];
     int duration_s;
 
-    volatile int * rec_stop_flag;
+    cancel_token_t * rec_cancel;
     volatile int * rec_progress;
+    timer_id_t progress_timer;
 
     rec_status_t status;
 } rec_context_t;
@@ -56,7 +60,7 @@ typedef struct {
  * STATIC VARIABLES *
  ********************/
 
-static volatile int rec_stop_flag = 0;
+static cancel_token_t rec_cancel;
 static volatile int rec_progress = 0;
 
 /********************
@@ -91,9 +95,8 @@ static result_t create_wav_filepath_with_date( char * filepath,
 static void * record_thread( void * arg ) {
     rec_context_t * params = (rec_context_t *)arg;
 
-    params->status = REC_STATUS_IN_PROGRESS;
     result_t res = record_audio_to_wav(params->wav_filepath, params->duration_s, 
-        params->rec_stop_flag, params->rec_progress);
+        params->rec_cancel, params->rec_progress);
     params->status = (res == RES_OK) ? REC_STATUS_FINISHED_OK : 
                                        REC_STATUS_FINISHED_ERROR;
 
@@ -114,6 +117,20 @@ static void stt_request_event_publish( char * wav_filepath,
     }
 }
 
+static void rec_progress_event_publish( const char * progress_msg, 
+        size_t progress_msg_size ) {    
+    event_t event = STRUCT_INIT_ALL_ZEROS;
+    result_t res = event_create(
+        COMPONENT_AUDIO_INPUT, COMPONENT_CORE_DISP,
+        EVENT_REC_STATUS, 
+        progress_msg, progress_msg_size,
+        &event);
+
+    if( res == RES_OK ) {
+        broker_publish_coalesced(&event);
+    }
+}
+
 static void rec_status_event_publish( const char * status_msg, 
         size_t status_msg_size ) {    
     event_t event = STRUCT_INIT_ALL_ZEROS;
@@ -131,12 +148,23 @@ static void rec_status_event_publish( const char * status_msg,
 static void rec_context_clear( rec_context_t * context ) {
     memset(context->wav_filepath, 0, sizeof(context->wav_filepath));
     
-    rec_stop_flag = 0;
+    cancel_token_reset(context->rec_cancel);
     rec_progress = 0;
+    context->progress_timer = TIMER_ID_INVALID;
 
     context->status = REC_STATUS_NOT_STARTED;
 }
 
+static void rec_progress_timer_callback( void * user_data ) {
+    rec_context_t * context = (rec_context_t *)user_data;
+
+    char progress_msg[32];
+    snprintf(progress_msg, sizeof(progress_msg), 
+        "Recording progress: %d/%ds", *context->rec_progress,
+        context->duration_s);
+    rec_progress_event_publish(progress_msg, strlen(progress_msg));
+}
+
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
@@ -144,10 +172,11 @@ static void rec_context_clear( rec_context_t * context ) {
 void * audio_input_thread( void * arg UNUSED_PARAM ) {
     pthread_t rec_thread;
     rec_context_t context = {
-        .duration_s = DEFAULT_MAX_REC_DUR_S,
+        .duration_s = 0,
 
-        .rec_stop_flag = &rec_stop_flag,
+        .rec_cancel = &rec_cancel,
         .rec_progress = &rec_progress,
+        .progress_timer = TIMER_ID_INVALID,
 
         .status = REC_STATUS_NOT_STARTED
     };
@@ -159,18 +188,13 @@ void * audio_input_thread( void * arg UNUSED_PARAM ) {
                 break;
 
             case REC_STATUS_IN_PROGRESS: {
-                DO_WITH_INTERVAL_MS(500, {
-                    char status_msg[32];
-                    snprintf(status_msg, sizeof(status_msg), 
-                        "Recording progress: %d/%ds", *context.rec_progress,
-                        context.duration_s);
-                    rec_status_event_publish(status_msg, 
-                        strlen(status_msg));
-                });
+                // Progress is reported by the periodic timer
                 break;
             }
 
             case REC_STATUS_FINISHED_OK: {
+                pthread_join(rec_thread, NULL);
+                timer_service_stop(context.progress_timer);
                 const char * status_msg = "Recording finished.\n";
                 rec_status_event_publish(status_msg, 
                     strlen(status_msg));
@@ -181,6 +205,8 @@ void * audio_input_thread( void * arg UNUSED_PARAM ) {
             }
 
             case REC_STATUS_FINISHED_ERROR: {
+                pthread_join(rec_thread, NULL);
+                timer_service_stop(context.progress_timer);
                 const char * error_msg = "\nError: Recording failed.\n";
                 rec_status_event_publish(error_msg, 
                     strlen(error_msg));
@@ -194,7 +220,8 @@ void * audio_input_thread( void * arg UNUSED_PARAM ) {
 
         // Action based on incomming event
         event_t e = STRUCT_INIT_ALL_ZEROS;
-        if( broker_pop(COMPONENT_AUDIO_INPUT, &e) == RES_OK ) {
+        uint32_t wait_ms = broker_worker_wait_ms(context.status != REC_STATUS_NOT_STARTED);
+        if( broker_pop_timeout(COMPONENT_AUDIO_INPUT, &e, wait_ms) == RES_OK ) {
             switch( e.type ) {
                 case EVENT_REC_REQUEST: {
                     if( context.status != REC_STATUS_NOT_STARTED ) {
@@ -215,11 +242,27 @@ void * audio_input_thread( void * arg UNUSED_PARAM ) {
                         continue;
                     }
 
+                    config_t config;
+                    config_get(&config);
+                    context.duration_s = (int)config.audio.max_duration_s;
+
                     const char * msg = "Recording start.\n";
                     rec_status_event_publish(msg, strlen(msg));
 
-                    rec_stop_flag = 0;
-                    pthread_create(&rec_thread, NULL, record_thread, &context);
+                    // Status is set before the thread exists, so the loop 
+                    // keeps polling until the thread reports it finished
+                    cancel_token_reset(&rec_cancel);
+                    context.status = REC_STATUS_IN_PROGRESS;
+                    if( pthread_create(&rec_thread, NULL, record_thread, &context) != 0 ) {
+                        const char * error_msg = "\nError: Recording failed.\n";
+                        rec_status_event_publish(error_msg, 
+                            strlen(error_msg));
+                        rec_context_clear(&context);
+                        continue;
+                    }
+                    timer_service_start_periodic(REC_PROGRESS_PERIOD_MS, 
+                        rec_progress_timer_callback, &context, 
+                        &context.progress_timer);
 
                     break;
                 }
@@ -233,8 +276,9 @@ void * audio_input_thread( void * arg UNUSED_PARAM ) {
                         continue;
                     }
 
-                    rec_stop_flag = 1;
-                    pthread_join(rec_thread, NULL);
+                    // Recording thread wakes up on the token and finishes on its 
+                    // own, it is joined once its status is reported
+                    cancel_token_cancel(&rec_cancel);
                     
                     break;
                 }
@@ -243,13 +287,11 @@ void * audio_input_thread( void * arg UNUSED_PARAM ) {
                     break;
             }
         }
-
-        usleep(30000);
     }
 
     return NULL;
 }
 
 result_t audio_input_init( void ) {
-    return RES_OK;
+    return cancel_token_init(&rec_cancel);
 }
@@ -14,17 +14,21 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <poll.h>
 #include <alsa/asoundlib.h>
 
 #include "utils.h"
+#include "cancel_token.h"
+#include "config.h"
 
 #include "audio_input_rec_ops.h"
+#include "wav_writer.h"
 
 /******************************
  * PRIVATE MACROS AND DEFINES *
  ******************************/
 
-#define WAV_HEADER_SIZE_BYTES   44
+#define MAX_PCM_POLL_FDS        8
 
 /********************
  * PRIVATE TYPEDEFS *
@@ -37,7 +41,6 @@ typedef struct {
     snd_pcm_format_t format;
     snd_pcm_uframes_t period_size;
     snd_pcm_uframes_t buffer_size;
-    uint16_t bits_per_sample;
 } audio_settings_t;
 
 /********************
@@ -132,61 +135,36 @@ static result_t setup_pcm_capture( snd_pcm_t ** handle,
     return RES_OK;
 }
 
-static result_t write_little_endian_16( FILE * fp, uint16_t value ) {
-    RETURN_IF_NULL(fp);
-
-    uint8_t data[2];
-    for( int i = 0; i < 2; i++ ) {
-        data[i] = (uint8_t)(value & 0xFF);
-        value >>= 8;
-    }
-
-    RETURN_ERROR_IF( fwrite(data, 1, 2, fp) != 2, 
-        RES_ERR_GENERIC );
-
-    return RES_OK;
-}
+// Waits until a period can be read or the token is cancelled
+static result_t wait_for_capture_or_cancel( snd_pcm_t * capture_handle, 
+        cancel_token_t * cancel, bool * cancelled OUTPUT ) {
+    struct pollfd pfds[MAX_PCM_POLL_FDS + 1];
+    int nfds = snd_pcm_poll_descriptors(capture_handle, pfds, MAX_PCM_POLL_FDS);
+    RETURN_ERROR_IF( nfds <= 0, RES_ERR_GENERIC );
+
+    pfds[nfds].fd = cancel_token_fd(cancel);
+    pfds[nfds].events = POLLIN;
+    pfds[nfds].revents = 0;
+
+    *cancelled = false;
+    while(1) {
+        if( poll(pfds, (nfds_t)nfds + 1, -1) < 0 ) {
+            RETURN_ERROR_IF( errno != EINTR, RES_ERR_GENERIC );
+            continue;
+        }
 
-static result_t write_little_endian_32( FILE * fp, uint32_t value ) {
-    RETURN_IF_NULL(fp);
+        if( pfds[nfds].revents & POLLIN || cancel_token_is_cancelled(cancel) ) {
+            *cancelled = true;
+            return RES_OK;
+        }
 
-    uint8_t data[4];
-    for( int i = 0; i < 4; i++ ) {
-        data[i] = (uint8_t)(value & 0xFF);
-        value >>= 8;
+        unsigned short revents = 0;
+        snd_pcm_poll_descriptors_revents(capture_handle, pfds, (unsigned)nfds, &revents);
+        if( revents & (POLLIN | POLLERR) ) {
+            // On POLLERR (overrun) the following read reports -EPIPE
+            return RES_OK;
+        }
     }
-    
-    RETURN_ERROR_IF( fwrite(data, 1, 4, fp) != 4, 
-        RES_ERR_GENERIC );
-
-    return RES_OK;
-}
-
-static result_t write_wav_header( FILE * fp, uint32_t data_chunk_size, 
-        const audio_settings_t * settings ) {
-    RETURN_IF_NULL(fp);
-    RETURN_IF_NULL(settings);
-
-    uint32_t riff_chunk_size = data_chunk_size + (WAV_HEADER_SIZE_BYTES - 8);
-
-    rewind(fp);
-    RETURN_ERROR_IF( fwrite("RIFF", 1, 4, fp) != 4, RES_ERR_GENERIC );
-    RETURN_ON_ERROR( write_little_endian_32(fp, riff_chunk_size) );
-    RETURN_ERROR_IF( fwrite("WAVE", 1, 4, fp) != 4, RES_ERR_GENERIC );
-    RETURN_ERROR_IF( fwrite("fmt ", 1, 4, fp) != 4, RES_ERR_GENERIC );
-    RETURN_ON_ERROR( write_little_endian_32(fp, 16) );
-    RETURN_ON_ERROR( write_little_endian_16(fp, 1) );
-    RETURN_ON_ERROR( write_little_endian_16(fp, (uint16_t)settings->channels) ); 
-    RETURN_ON_ERROR( write_little_endian_32(fp, settings->rate) );  
-    RETURN_ON_ERROR( write_little_endian_32(fp, settings->rate * settings->channels 
-        * settings->bits_per_sample / 8) );  
-    RETURN_ON_ERROR( write_little_endian_16(fp, (uint16_t)(settings->channels 
-        * settings->bits_per_sample / 8)) ); 
-    RETURN_ON_ERROR( write_little_endian_16(fp, settings->bits_per_sample) );
-    RETURN_ERROR_IF( fwrite("data", 1, 4, fp) != 4, RES_ERR_GENERIC );
-    RETURN_ON_ERROR( write_little_endian_32(fp, data_chunk_size) );
-
-    return RES_OK;
 }
 
 /********************
@@ -194,26 +172,28 @@ static result_t write_wav_header( FILE * fp, uint32_t data_chunk_size,
  ********************/
 
 result_t record_audio_to_wav( const char * wav_filepath, int duration_s, 
-        volatile int * stop_flag, volatile int * progress ) {
+        cancel_token_t * cancel, volatile int * progress ) {
     RETURN_IF_NULL(wav_filepath);
     RETURN_ERROR_IF( duration_s <= 0, RES_ERR_WRONG_ARGS );
-    RETURN_IF_NULL(stop_flag);
+    RETURN_IF_NULL(cancel);
     RETURN_IF_NULL(progress);
 
+    config_t config;
+    config_get(&config);
+
     audio_settings_t settings = {
-        .device_name = "plughw:1",
+        .device_name = config.audio.device,
         .rate = 16000,
         .channels = 1,
         .format = SND_PCM_FORMAT_S16_LE,
-        .period_size = 6000,
-        .buffer_size = 24000,
-        .bits_per_sample = 32
+        .period_size = config.audio.period_frames,
+        .buffer_size = config.audio.buffer_frames
     };
 
     snd_pcm_t * capture_handle = NULL;
     snd_pcm_hw_params_t * hw_params = NULL;
     char * buffer = NULL;
-    FILE * fp = NULL;
+    wav_writer_t wav = WAV_WRITER_INIT;
 
     if( setup_pcm_capture(&capture_handle, &hw_params, &settings) < 0 ) {
         return RES_ERR_GENERIC;
@@ -231,27 +211,42 @@ result_t record_audio_to_wav( const char * wav_filepath, int duration_s,
         return RES_ERR_GENERIC;
     }
 
-    fp = fopen(wav_filepath, "wb");
-    if( !fp ) {
-        free(buffer);
-        snd_pcm_hw_params_free(hw_params);
-        snd_pcm_close(capture_handle);
-        return RES_ERR_GENERIC;
-    }
+    snd_pcm_uframes_t frames_recorded = 0;
+    snd_pcm_uframes_t total_frames = (snd_pcm_uframes_t)duration_s * settings.rate;
 
-    if( fseek(fp, WAV_HEADER_SIZE_BYTES, SEEK_SET) != 0 ) {
-        fclose(fp);
+    wav_format_t format = {
+        .rate = settings.rate,
+        .channels = (uint16_t)settings.channels,
+        .bits_per_sample = (uint16_t)snd_pcm_format_physical_width(settings.format)
+    };
+    if( wav_writer_open(&wav, wav_filepath, &format,
+            (uint64_t)total_frames * bytes_per_frame) != RES_OK ) {
         free(buffer);
         snd_pcm_hw_params_free(hw_params);
         snd_pcm_close(capture_handle);
         return RES_ERR_GENERIC;
     }
 
-    snd_pcm_uframes_t frames_recorded = 0;
-    snd_pcm_uframes_t total_frames = (snd_pcm_uframes_t)duration_s * settings.rate;
     int last_reported_seconds = -1;
 
-    while( frames_recorded < total_frames && !(*stop_flag) ) {
+    // Capture has to be started explicitly, as we poll before the first read
+    snd_pcm_start(capture_handle);
+
+    while( frames_recorded < total_frames ) {
+        // Stopping is the normal way to finish a recording, so the samples
+        // recorded so far are kept and the header is still written
+        bool cancelled = false;
+        if( wait_for_capture_or_cancel(capture_handle, cancel, &cancelled) != RES_OK ) {
+            wav_writer_close(&wav);
+            free(buffer);
+            snd_pcm_hw_params_free(hw_params);
+            snd_pcm_close(capture_handle);
+            return RES_ERR_GENERIC;
+        }
+        if( cancelled ) {
+            break;
+        }
+
         snd_pcm_uframes_t frames_to_read = buffer_frames;
         if( frames_recorded + frames_to_read > total_frames ) {
             frames_to_read = total_frames - frames_recorded;
@@ -260,17 +255,18 @@ result_t record_audio_to_wav( const char * wav_filepath, int duration_s,
         snd_pcm_sframes_t rc = snd_pcm_readi(capture_handle, buffer, frames_to_read);
         if( rc == -EPIPE ) {
             snd_pcm_prepare(capture_handle);
+            snd_pcm_start(capture_handle);
             continue;
         } else if( rc < 0 ) {
-            fclose(fp);
+            wav_writer_close(&wav);
             free(buffer);
             snd_pcm_hw_params_free(hw_params);
             snd_pcm_close(capture_handle);
             return RES_ERR_GENERIC;
         } else if( rc > 0 ) {
             size_t bytes_to_write = (size_t)rc * bytes_per_frame;
-            if( fwrite(buffer, 1, bytes_to_write, fp) != bytes_to_write ) {
-                fclose(fp);
+            if( wav_writer_append(&wav, buffer, bytes_to_write) != RES_OK ) {
+                wav_writer_close(&wav);
                 free(buffer);
                 snd_pcm_hw_params_free(hw_params);
                 snd_pcm_close(capture_handle);
@@ -288,19 +284,9 @@ result_t record_audio_to_wav( const char * wav_filepath, int duration_s,
     }
 
     free(buffer);
-    snd_pcm_drain(capture_handle);
+    snd_pcm_drop(capture_handle);   // Discard the partial period, do not wait
     snd_pcm_close(capture_handle);
     snd_pcm_hw_params_free(hw_params);
 
-    long file_size = ftell(fp);
-    if( file_size < WAV_HEADER_SIZE_BYTES ) {
-        fclose(fp);
-        return RES_ERR_GENERIC;
-    }
-
-    uint32_t data_chunk_size = (uint32_t)(file_size - WAV_HEADER_SIZE_BYTES);
-    write_wav_header(fp, data_chunk_size, &settings);
-    fclose(fp);
-
-    return RES_OK;
+    return wav_writer_close(&wav);
 }
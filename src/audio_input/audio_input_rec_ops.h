@@ -17,13 +17,14 @@ extern "C" {
  ************/
 
 #include "utils.h"
+#include "cancel_token.h"
 
 /******************************
  * GLOBAL FUNCTION PROTOTYPES *
  ******************************/
 
 extern result_t record_audio_to_wav( const char * wav_filepath, int duration_s, 
-    volatile int * stop_flag, volatile int * progress );
+    cancel_token_t * cancel, volatile int * progress );
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,201 @@
+/**
+ *******************************************************************************
+ * @file    wav_writer.c
+ * @brief   WAV file writer source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <endian.h>
+#include <unistd.h>
+
+#include "utils.h"
+
+#include "wav_writer.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define BLOCK_ALIGN             4096u
+#define WAV_FORMAT_PCM          1
+#define WAV_FMT_CHUNK_SIZE      16
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+// Canonical 44-byte PCM header, all fields little-endian
+typedef struct {
+    char riff_id[4];
+    uint32_t riff_size;
+    char wave_id[4];
+    char fmt_id[4];
+    uint32_t fmt_size;
+    uint16_t audio_format;
+    uint16_t channels;
+    uint32_t rate;
+    uint32_t byte_rate;
+    uint16_t block_align;
+    uint16_t bits_per_sample;
+    char data_id[4];
+    uint32_t data_size;
+} wav_header_t;
+
+STATIC_ASSERT(sizeof(wav_header_t) == WAV_WRITER_HEADER_SIZE, "WAV header has padding");
+STATIC_ASSERT(WAV_WRITER_BLOCK_SIZE % BLOCK_ALIGN == 0, "Block breaks alignment");
+STATIC_ASSERT(WAV_WRITER_BLOCK_SIZE > WAV_WRITER_HEADER_SIZE, "Header doesn't fit in block");
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static void make_header( const wav_format_t * format, uint32_t data_size,
+        wav_header_t * header OUTPUT ) {
+    uint16_t frame_size = (uint16_t)(format->channels * format->bits_per_sample / 8);
+
+    memcpy(header->riff_id, "RIFF", sizeof(header->riff_id));
+    header->riff_size = htole32(data_size + (WAV_WRITER_HEADER_SIZE - 8));
+    memcpy(header->wave_id, "WAVE", sizeof(header->wave_id));
+    memcpy(header->fmt_id, "fmt ", sizeof(header->fmt_id));
+    header->fmt_size = htole32(WAV_FMT_CHUNK_SIZE);
+    header->audio_format = htole16(WAV_FORMAT_PCM);
+    header->channels = htole16(format->channels);
+    header->rate = htole32(format->rate);
+    header->byte_rate = htole32(format->rate * frame_size);
+    header->block_align = htole16(frame_size);
+    header->bits_per_sample = htole16(format->bits_per_sample);
+    memcpy(header->data_id, "data", sizeof(header->data_id));
+    header->data_size = htole32(data_size);
+}
+
+static result_t write_all( int fd, const uint8_t * buf, size_t size, uint64_t offset ) {
+    while( size > 0 ) {
+        ssize_t n = pwrite(fd, buf, size, (off_t)offset);
+        if( n < 0 ) {
+            RETURN_ERROR_IF( errno != EINTR, RES_ERR_GENERIC );
+            continue;
+        }
+        RETURN_ERROR_IF( n == 0, RES_ERR_GENERIC );
+
+        buf += n;
+        size -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+
+    return RES_OK;
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t wav_writer_open( wav_writer_t * w, const char * path,
+        const wav_format_t * format, uint64_t max_data_size ) {
+    RETURN_IF_NULL(w);
+    RETURN_IF_NULL(path);
+    RETURN_IF_NULL(format);
+    RETURN_ERROR_IF( format->rate == 0 || format->channels == 0 ||
+        format->bits_per_sample == 0 || format->bits_per_sample % 8 != 0,
+        RES_ERR_WRONG_ARGS );
+    RETURN_ERROR_IF( max_data_size > UINT32_MAX - (WAV_WRITER_HEADER_SIZE - 8),
+        RES_ERR_INVALID_SIZE );
+
+    *w = (wav_writer_t)WAV_WRITER_INIT;
+    w->format = *format;
+
+    void * block = NULL;
+    RETURN_ERROR_IF( posix_memalign(&block, BLOCK_ALIGN, WAV_WRITER_BLOCK_SIZE) != 0,
+        RES_ERR_GENERIC );
+    w->block = block;
+
+    w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if( w->fd < 0 ) {
+        free(w->block);
+        w->block = NULL;
+        return RES_ERR_GENERIC;
+    }
+
+    // Extents are reserved at once instead of growing with every block.
+    // Not all filesystems support it, then the file just grows as written.
+    if( max_data_size > 0 && fallocate(w->fd, 0, 0,
+            (off_t)(WAV_WRITER_HEADER_SIZE + max_data_size)) != 0 ) {
+        WARN("WAV file space not preallocated (errno %d).", errno);
+    }
+
+    // First block starts with placeholder header, final one is written on close
+    wav_header_t header;
+    make_header(&w->format, 0, &header);
+    memcpy(w->block, &header, sizeof(header));
+    w->block_used = sizeof(header);
+
+    return RES_OK;
+}
+
+result_t wav_writer_append( wav_writer_t * w, const void * data, size_t size ) {
+    RETURN_IF_NULL(w);
+    RETURN_IF_NULL(w->block);
+    RETURN_ERROR_IF( size > 0 && !data, RES_ERR_WRONG_ARGS );
+    RETURN_ERROR_IF( w->data_size + size > UINT32_MAX - (WAV_WRITER_HEADER_SIZE - 8),
+        RES_ERR_INVALID_SIZE );
+
+    const uint8_t * src = data;
+    while( size > 0 ) {
+        size_t n = WAV_WRITER_BLOCK_SIZE - w->block_used;
+        if( n > size ) {
+            n = size;
+        }
+        memcpy(&w->block[w->block_used], src, n);
+        w->block_used += n;
+        w->data_size += n;
+        src += n;
+        size -= n;
+
+        if( w->block_used == WAV_WRITER_BLOCK_SIZE ) {
+            RETURN_ON_ERROR( write_all(w->fd, w->block, WAV_WRITER_BLOCK_SIZE,
+                w->block_offset) );
+            w->block_offset += WAV_WRITER_BLOCK_SIZE;
+            w->block_used = 0;
+        }
+    }
+
+    return RES_OK;
+}
+
+// Preallocated tail is cut off before the header says how much data is valid
+result_t wav_writer_close( wav_writer_t * w ) {
+    RETURN_IF_NULL(w);
+    RETURN_IF_NULL(w->block);
+
+    result_t res = RES_OK;
+    if( w->block_used > 0 ) {
+        res = write_all(w->fd, w->block, w->block_used, w->block_offset);
+    }
+
+    if( res == RES_OK &&
+            ftruncate(w->fd, (off_t)(WAV_WRITER_HEADER_SIZE + w->data_size)) != 0 ) {
+        res = RES_ERR_GENERIC;
+    }
+
+    if( res == RES_OK ) {
+        wav_header_t header;
+        make_header(&w->format, (uint32_t)w->data_size, &header);
+        res = write_all(w->fd, (const uint8_t *)&header, sizeof(header), 0);
+    }
+
+    if( close(w->fd) != 0 && res == RES_OK ) {
+        res = RES_ERR_GENERIC;
+    }
+    free(w->block);
+    *w = (wav_writer_t)WAV_WRITER_INIT;
+
+    return res;
+}
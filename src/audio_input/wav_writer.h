@@ -0,0 +1,78 @@
+/**
+ *******************************************************************************
+ * @file    wav_writer.h
+ * @brief   WAV file writer header file.
+ *          Space for the longest recording is preallocated, samples are
+ *          staged and written in large block-aligned chunks and the header
+ *          is written once, when the file is closed.
+ *******************************************************************************
+ */
+
+#ifndef WAV_WRITER_H
+#define WAV_WRITER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdint.h>
+
+#include "utils.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define WAV_WRITER_HEADER_SIZE      44
+#define WAV_WRITER_BLOCK_SIZE       (64u * 1024u)   // Multiple of SD erase page
+
+#define WAV_WRITER_INIT { \
+    .fd = -1, \
+    .block = NULL, \
+    .block_used = 0, \
+    .block_offset = 0, \
+    .data_size = 0 \
+}
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef struct {
+    uint32_t rate;
+    uint16_t channels;
+    uint16_t bits_per_sample;
+} wav_format_t;
+
+typedef struct {
+    int fd;
+    wav_format_t format;
+
+    uint8_t * block;            // Mirrors file block at block_offset
+    size_t block_used;
+    uint64_t block_offset;
+
+    uint64_t data_size;         // Samples written so far, in bytes
+} wav_writer_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t wav_writer_open( wav_writer_t * w, const char * path,
+    const wav_format_t * format, uint64_t max_data_size );
+extern result_t wav_writer_append( wav_writer_t * w, const void * data,
+    size_t size );
+
+// Always closes the file, even if writing the rest of it fails
+extern result_t wav_writer_close( wav_writer_t * w );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WAV_WRITER_H */
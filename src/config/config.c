@@ -0,0 +1,443 @@
+/**
+ *******************************************************************************
+ * @file    config.c
+ * @brief   Runtime configuration source file.
+ *          Simple INI parser: [section], key = value, # and ; comments.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "utils.h"
+
+#include "config.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define MAX_LINE_SIZE           512
+
+#define FIELD_STRING(section_, key_, member_, choices_, reloadable_) { \
+    .section = section_, .key = key_, .type = CONFIG_TYPE_STRING, \
+    .offset = offsetof(config_t, member_), \
+    .size = sizeof(((config_t *)0)->member_), \
+    .choices = choices_, .reloadable = reloadable_ \
+}
+
+#define FIELD_UINT(section_, key_, member_, min_, max_, reloadable_) { \
+    .section = section_, .key = key_, .type = CONFIG_TYPE_UINT, \
+    .offset = offsetof(config_t, member_), \
+    .size = sizeof(unsigned int), \
+    .min = min_, .max = max_, .reloadable = reloadable_ \
+}
+
+#define FIELD_DOUBLE(section_, key_, member_, min_, max_, reloadable_) { \
+    .section = section_, .key = key_, .type = CONFIG_TYPE_DOUBLE, \
+    .offset = offsetof(config_t, member_), \
+    .size = sizeof(double), \
+    .min = min_, .max = max_, .reloadable = reloadable_ \
+}
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef enum {
+    CONFIG_TYPE_STRING,
+    CONFIG_TYPE_UINT,
+    CONFIG_TYPE_DOUBLE,
+} config_type_t;
+
+typedef struct {
+    const char * section;
+    const char * key;
+    config_type_t type;
+    size_t offset;
+    size_t size;
+
+    double min;                         // Only for numbers
+    double max;
+    const char * const * choices;       // Only for strings, NULL means any
+
+    bool reloadable;                    // Not only read at initialization
+} config_field_t;
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static const char * const think_modes[] = {
+    "show", "hide", "collapse", "archive", NULL
+};
+
+static const char * const control_inputs[] = {
+    "gpio", "script", NULL
+};
+
+static const config_field_t fields[] = {
+    FIELD_STRING("audio", "device", audio.device, NULL, true),
+    FIELD_UINT("audio", "period_frames", audio.period_frames, 256, 65536, true),
+    FIELD_UINT("audio", "buffer_frames", audio.buffer_frames, 512, 262144, true),
+    FIELD_UINT("audio", "max_duration_s", audio.max_duration_s, 1, 600, true),
+
+    FIELD_STRING("stt", "vosk_model", stt.vosk_model, NULL, true),
+    FIELD_UINT("stt", "early_llm_dispatch", stt.early_llm_dispatch, 0, 1, true),
+
+    FIELD_STRING("llm", "backend", llm.backend, NULL, false),
+    FIELD_STRING("llm", "think_mode", llm.think_mode, think_modes, true),
+    FIELD_UINT("llm", "max_answer_tokens", llm.max_answer_tokens, 16, 32768, true),
+    FIELD_DOUBLE("llm", "temperature", llm.temperature, 0.0, 2.0, true),
+    FIELD_STRING("llm", "ollama_url", llm.ollama_url, NULL, false),
+    FIELD_STRING("llm", "ollama_model", llm.ollama_model, NULL, false),
+    FIELD_UINT("llm", "ollama_num_thread", llm.ollama_num_thread, 0, 64, true),
+    FIELD_UINT("llm", "ollama_num_ctx", llm.ollama_num_ctx, 0, 131072, true),
+    FIELD_STRING("llm", "llama_model", llm.llama_model, NULL, false),
+    FIELD_UINT("llm", "llama_threads", llm.llama_threads, 1, 64, false),
+    FIELD_UINT("llm", "llama_ctx_size", llm.llama_ctx_size, 1024, 131072, false),
+    FIELD_UINT("llm", "answer_cache_max_kb", llm.answer_cache_max_kb, 64, 1048576, false),
+    FIELD_UINT("llm", "session_reuse", llm.session_reuse, 0, 1, true),
+
+    FIELD_UINT("display", "spi_clock_hz", display.spi_clock_hz,
+        1000000, 125000000, false),
+    FIELD_UINT("display", "spi_probe", display.spi_probe, 0, 1, false),
+    FIELD_UINT("display", "spi_probe_max_hz", display.spi_probe_max_hz,
+        1000000, 125000000, false),
+    FIELD_UINT("display", "max_fps", display.max_fps, 0, 120, false),
+    FIELD_UINT("display", "idle_timeout_s", display.idle_timeout_s, 0, 86400, false),
+
+    FIELD_STRING("controls", "input", controls.input, control_inputs, false),
+    FIELD_STRING("controls", "script", controls.script, NULL, false),
+    FIELD_UINT("controls", "debounce_us", controls.debounce_us, 0, 1000000, true),
+    FIELD_UINT("controls", "long_press_ms", controls.long_press_ms, 200, 5000, true),
+    FIELD_UINT("controls", "double_press_ms", controls.double_press_ms, 50, 1000, true),
+};
+
+static pthread_mutex_t config_lock = PTHREAD_MUTEX_INITIALIZER;
+static config_t active_config;
+static char active_filepath[CONFIG_MAX_PATH_SIZE];
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static char * trim( char * str ) {
+    while( isspace((unsigned char)*str) ) {
+        str++;
+    }
+
+    size_t len = strlen(str);
+    while( len > 0 && isspace((unsigned char)str[len - 1]) ) {
+        str[--len] = '\0';
+    }
+
+    return str;
+}
+
+static const config_field_t * find_field( const char * section, const char * key ) {
+    for( size_t i = 0; i < NELEMS(fields); i++ ) {
+        if( strcmp(fields[i].section, section) == 0 &&
+                strcmp(fields[i].key, key) == 0 ) {
+            return &fields[i];
+        }
+    }
+
+    return NULL;
+}
+
+static bool is_choice( const config_field_t * field, const char * value ) {
+    if( !field->choices ) {
+        return true;
+    }
+
+    for( size_t i = 0; field->choices[i]; i++ ) {
+        if( strcmp(field->choices[i], value) == 0 ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static result_t set_field( config_t * config, const config_field_t * field,
+        const char * value ) {
+    void * dst = (char *)config + field->offset;
+
+    if( field->type == CONFIG_TYPE_STRING ) {
+        size_t len = strlen(value);
+        RETURN_ERROR_IF( len == 0, RES_ERR_WRONG_ARGS );
+        RETURN_ERROR_IF( len >= field->size, RES_ERR_INVALID_SIZE );
+        RETURN_ERROR_IF( !is_choice(field, value), RES_ERR_WRONG_ARGS );
+        // Whole buffer is compared on reload
+        memset(dst, 0, field->size);
+        memcpy(dst, value, len);
+        return RES_OK;
+    }
+
+    char * end = NULL;
+    errno = 0;
+    if( field->type == CONFIG_TYPE_DOUBLE ) {
+        double number = strtod(value, &end);
+        RETURN_ERROR_IF( errno != 0 || end == value || *end != '\0', 
+            RES_ERR_WRONG_ARGS );
+        RETURN_ERROR_IF( !(number >= field->min && number <= field->max), 
+            RES_ERR_WRONG_ARGS );
+        *(double *)dst = number;
+        return RES_OK;
+    }
+
+    unsigned long number = strtoul(value, &end, 0);
+    RETURN_ERROR_IF( errno != 0 || end == value || *end != '\0' || value[0] == '-',
+        RES_ERR_WRONG_ARGS );
+    RETURN_ERROR_IF( (double)number < field->min || (double)number > field->max, 
+        RES_ERR_WRONG_ARGS );
+    *(unsigned int *)dst = (unsigned int)number;
+
+    return RES_OK;
+}
+
+static result_t parse_line( config_t * config, char * line,
+        char * section, size_t section_size,
+        const char * filepath UNUSED_PARAM, int line_no UNUSED_PARAM ) {
+    // Location is only used in log messages
+    char * text = trim(line);
+    if( text[0] == '\0' || text[0] == '#' || text[0] == ';' ) {
+        return RES_OK;
+    }
+
+    if( text[0] == '[' ) {
+        char * close = strchr(text, ']');
+        if( !close || close[1] != '\0' || (size_t)(close - text - 1) >= section_size ) {
+            ERROR("%s:%d: wrong section header.", filepath, line_no);
+            return RES_ERR_WRONG_ARGS;
+        }
+        *close = '\0';
+        snprintf(section, section_size, "%s", trim(text + 1));
+        return RES_OK;
+    }
+
+    char * eq = strchr(text, '=');
+    if( !eq ) {
+        ERROR("%s:%d: expected 'key = value'.", filepath, line_no);
+        return RES_ERR_WRONG_ARGS;
+    }
+    *eq = '\0';
+    char * key = trim(text);
+    char * value = trim(eq + 1);
+
+    // Quoted value may contain comment characters, otherwise they end it
+    if( value[0] == '"' ) {
+        char * quote = strchr(value + 1, '"');
+        if( !quote ) {
+            ERROR("%s:%d: missing closing quote.", filepath, line_no);
+            return RES_ERR_WRONG_ARGS;
+        }
+        *quote = '\0';
+        value++;
+    } else {
+        value[strcspn(value, "#;")] = '\0';
+        value = trim(value);
+    }
+
+    const config_field_t * field = find_field(section, key);
+    if( !field ) {
+        WARN("%s:%d: unknown setting %s.%s ignored.", filepath, line_no,
+            section, key);
+        return RES_OK;
+    }
+
+    if( set_field(config, field, value) != RES_OK ) {
+        ERROR("%s:%d: wrong value '%s' for %s.%s.", filepath, line_no,
+            value, section, key);
+        return RES_ERR_WRONG_ARGS;
+    }
+
+    return RES_OK;
+}
+
+static result_t validate( const config_t * config ) {
+    // Capture needs at least two periods to avoid overruns
+    if( config->audio.buffer_frames < 2 * config->audio.period_frames ) {
+        ERROR("audio.buffer_frames must be at least 2 * audio.period_frames.");
+        return RES_ERR_WRONG_ARGS;
+    }
+
+    return RES_OK;
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+void config_defaults( config_t * config OUTPUT ) {
+    *config = (config_t){
+        .audio = {
+            .device = "plughw:1",
+            .period_frames = 6000,
+            .buffer_frames = 24000,
+            .max_duration_s = 60,
+        },
+        .stt = {
+            .vosk_model = "models/vosk-model-small-en-us-0.15",
+            .early_llm_dispatch = 1,
+        },
+        .llm = {
+            .backend = "ollama",
+            .think_mode = "collapse",
+            .max_answer_tokens = 1024,              // Small screen anyway
+            .temperature = 0.6,
+            .ollama_url = "http://localhost:11434/api/generate",
+            .ollama_model = "deepseek-r1:1.5b",
+            .ollama_num_thread = 3,                 // One core for Vosk and UI
+            .ollama_num_ctx = 2048,
+            .llama_model = "models/DeepSeek-R1-Distill-Qwen-1.5B-Q4_K_M.gguf",
+            .llama_threads = 4,
+            .llama_ctx_size = 4096,
+            .answer_cache_max_kb = 4096,
+            .session_reuse = 1,
+        },
+        .display = {
+            .spi_clock_hz = 8000000,
+            .spi_probe = 0,
+            .spi_probe_max_hz = 62500000,
+            .max_fps = 30,
+            .idle_timeout_s = 60,
+        },
+        .controls = {
+            .input = "gpio",
+            .script = "/tmp/pitalkster.input",
+            .debounce_us = 20000,
+            .long_press_ms = 600,
+            .double_press_ms = 300,
+        },
+    };
+}
+
+result_t config_load( const char * filepath, config_t * config OUTPUT ) {
+    RETURN_IF_NULL(filepath);
+    RETURN_IF_NULL(config);
+
+    FILE * file = fopen(filepath, "r");
+    RETURN_ERROR_IF( !file, RES_ERR_NOT_READY );
+
+    // Settings missing in file keep their defaults
+    config_defaults(config);
+
+    result_t res = RES_OK;
+    char line[MAX_LINE_SIZE];
+    char section[CONFIG_MAX_NAME_SIZE] = "";
+    int line_no = 0;
+    while( fgets(line, sizeof(line), file) ) {
+        line_no++;
+        if( !strchr(line, '\n') && !feof(file) ) {
+            ERROR("%s:%d: line too long.", filepath, line_no);
+            res = RES_ERR_INVALID_SIZE;
+            break;
+        }
+
+        res = parse_line(config, line, section, sizeof(section), filepath, line_no);
+        if( res != RES_OK ) {
+            break;
+        }
+    }
+    fclose(file);
+
+    RETURN_ON_ERROR( res );
+    return validate(config);
+}
+
+result_t config_init( const char * filepath ) {
+    RETURN_IF_NULL(filepath);
+    RETURN_ERROR_IF( strlen(filepath) >= sizeof(active_filepath), RES_ERR_INVALID_SIZE );
+
+    // Reload signal is only received by config thread, so it has to be
+    // blocked before any other thread is created
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGHUP);
+    RETURN_ERROR_IF( pthread_sigmask(SIG_BLOCK, &set, NULL) != 0, RES_ERR_GENERIC );
+
+    config_t config;
+    result_t res = config_load(filepath, &config);
+    if( res == RES_ERR_NOT_READY ) {
+        WARN("No config file %s, using defaults.", filepath);
+        config_defaults(&config);
+    } else {
+        RETURN_ON_ERROR( res );
+    }
+
+    pthread_mutex_lock(&config_lock);
+    snprintf(active_filepath, sizeof(active_filepath), "%s", filepath);
+    active_config = config;
+    pthread_mutex_unlock(&config_lock);
+
+    return RES_OK;
+}
+
+result_t config_reload( void ) {
+    pthread_mutex_lock(&config_lock);
+    char filepath[CONFIG_MAX_PATH_SIZE];
+    memcpy(filepath, active_filepath, sizeof(filepath));
+    pthread_mutex_unlock(&config_lock);
+
+    // Broken file doesn't change anything
+    config_t config;
+    RETURN_ON_ERROR( config_load(filepath, &config) );
+
+    pthread_mutex_lock(&config_lock);
+    for( size_t i = 0; i < NELEMS(fields); i++ ) {
+        const config_field_t * field = &fields[i];
+        char * dst = (char *)&active_config + field->offset;
+        const char * src = (const char *)&config + field->offset;
+        if( memcmp(dst, src, field->size) == 0 ) {
+            continue;
+        }
+
+        if( field->reloadable ) {
+            memcpy(dst, src, field->size);
+        } else {
+            WARN("%s.%s change needs restart.", field->section, field->key);
+        }
+    }
+    pthread_mutex_unlock(&config_lock);
+
+    return RES_OK;
+}
+
+void config_get( config_t * config OUTPUT ) {
+    pthread_mutex_lock(&config_lock);
+    *config = active_config;
+    pthread_mutex_unlock(&config_lock);
+}
+
+void * config_thread( void * arg UNUSED_PARAM ) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGHUP);
+
+    while(1) {
+        int sig = 0;
+        if( sigwait(&set, &sig) != 0 || sig != SIGHUP ) {
+            continue;
+        }
+
+        if( config_reload() == RES_OK ) {
+            INFO("Configuration reloaded.");
+        } else {
+            ERROR("Configuration not reloaded, old one is kept.");
+        }
+    }
+
+    return NULL;
+}
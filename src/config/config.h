@@ -0,0 +1,99 @@
+/**
+ *******************************************************************************
+ * @file    config.h
+ * @brief   Runtime configuration header file.
+ *          Settings are loaded from INI file at startup. SIGHUP reloads
+ *          everything that isn't only used during initialization.
+ *******************************************************************************
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include "utils.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define DEFAULT_CONFIG_FILEPATH "pitalkster.ini"
+
+#define CONFIG_MAX_NAME_SIZE    64
+#define CONFIG_MAX_PATH_SIZE    256
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef struct {
+    struct {
+        char device[CONFIG_MAX_NAME_SIZE];
+        unsigned int period_frames;
+        unsigned int buffer_frames;
+        unsigned int max_duration_s;
+    } audio;
+
+    struct {
+        char vosk_model[CONFIG_MAX_PATH_SIZE];
+        unsigned int early_llm_dispatch;            // 0 or 1
+    } stt;
+
+    struct {
+        char backend[CONFIG_MAX_NAME_SIZE];         // Structural
+        char think_mode[CONFIG_MAX_NAME_SIZE];
+        unsigned int max_answer_tokens;
+        double temperature;
+        char ollama_url[CONFIG_MAX_PATH_SIZE];      // Structural
+        char ollama_model[CONFIG_MAX_NAME_SIZE];    // Structural
+        unsigned int ollama_num_thread;             // 0 leaves server default
+        unsigned int ollama_num_ctx;                // 0 leaves server default
+        char llama_model[CONFIG_MAX_PATH_SIZE];     // Structural
+        unsigned int llama_threads;                 // Structural
+        unsigned int llama_ctx_size;                // Structural
+        unsigned int answer_cache_max_kb;           // Structural
+        unsigned int session_reuse;                 // 0 or 1
+    } llm;
+
+    struct {
+        unsigned int spi_clock_hz;                  // Structural
+        unsigned int spi_probe;                     // Structural, 0 or 1
+        unsigned int spi_probe_max_hz;              // Structural
+        unsigned int max_fps;                       // Structural, 0 is unpaced
+        unsigned int idle_timeout_s;                // Structural, 0 never idles
+    } display;
+
+    struct {
+        char input[CONFIG_MAX_NAME_SIZE];           // Structural
+        char script[CONFIG_MAX_PATH_SIZE];          // Structural
+        unsigned int debounce_us;
+        unsigned int long_press_ms;
+        unsigned int double_press_ms;
+    } controls;
+} config_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern void config_defaults( config_t * config OUTPUT );
+extern result_t config_load( const char * filepath, config_t * config OUTPUT );
+
+extern result_t config_init( const char * filepath );
+extern result_t config_reload( void );
+extern void config_get( config_t * config OUTPUT );
+
+extern void * config_thread( void * arg );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_H */
@@ -12,36 +12,67 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "config.h"
+
 #include "controls.h"
 #include "controls_hw.h"
+#include "controls_script.h"
 #include "controls_gpio.h"
+#include "gesture.h"
 #include "event_broker.h"
 
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static gesture_recognizer_t recognizer = GESTURE_RECOGNIZER_INIT;
+
 /********************
  * STATIC FUNCTIONS *
  ********************/
 
-static void button_event_publish( button_gpio_t button_gpio ) {
+static void gesture_event_publish( const gesture_t * gesture, 
+        void * user_data UNUSED_PARAM ) {
     event_t event = STRUCT_INIT_ALL_ZEROS;
     result_t res = event_create(
         COMPONENT_CONTROLS, COMPONENT_CORE_DISP,
-        EVENT_BUT_PRESSED, 
-        &button_gpio, sizeof(button_gpio_t),
+        EVENT_BUT_GESTURE, 
+        gesture, sizeof(gesture_t),
         &event);
-
     if( res == RES_OK ) {
         broker_publish(&event);
     }
 }
 
+static void button_edge_handler( button_gpio_t gpio, bool pressed, 
+        uint64_t time_us ) {
+    config_t config;
+    config_get(&config);
+    gesture_recognizer_set_timing(&recognizer, config.controls.long_press_ms,
+        config.controls.double_press_ms);
+
+    gesture_recognizer_edge(&recognizer, gpio, pressed, time_us);
+}
+
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
 
 result_t controls_init( void ) {
-    RETURN_ON_ERROR( controls_hw_init_button(BUTTON_UP_GPIO, button_event_publish) );
-    RETURN_ON_ERROR( controls_hw_init_button(BUTTON_OK_GPIO, button_event_publish) );
-    RETURN_ON_ERROR( controls_hw_init_button(BUTTON_DOWN_GPIO, button_event_publish) );
+    static const button_gpio_t buttons[] = {
+        BUTTON_UP_GPIO, BUTTON_OK_GPIO, BUTTON_DOWN_GPIO
+    };
+    RETURN_ON_ERROR( gesture_recognizer_init(&recognizer, buttons, 
+        NELEMS(buttons), gesture_event_publish, NULL) );
+
+    config_t config;
+    config_get(&config);
+    if( strcmp(config.controls.input, "script") == 0 ) {
+        return controls_script_init_buttons(config.controls.script, 
+            button_edge_handler);
+    }
+    RETURN_ON_ERROR( controls_hw_init_buttons(buttons, NELEMS(buttons), 
+        button_edge_handler) );
     
     return RES_OK;
 }
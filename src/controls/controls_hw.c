@@ -15,61 +15,95 @@
 #include <stdint.h>
 #include <string.h>
 #include <pthread.h>
-#include <unistd.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <gpiod.h>
 
+#include "config.h"
+
 #include "controls_hw.h"
 
 /******************************
  * PRIVATE MACROS AND DEFINES *
  ******************************/
 
-#define DEBOUNCE_TIME_US    20000
 #define GPIO_CHIP_PATH      "/dev/gpiochip0"
+#define GPIO_CONSUMER       "buttons"
+#define MAX_BUTTONS         8
+#define EVENTS_BATCH        16
 
 /********************
  * PRIVATE TYPEDEFS *
  ********************/
 
-struct button_info_t {
+typedef struct {
     button_gpio_t gpio;
-    button_handler_t handler;
     struct gpiod_line * line;
-    pthread_t thread_id;
-
-    uint64_t last_event_time;
-    struct button_info_t * next;
-};
+    bool pressed;
+    uint64_t last_event_time;       // Kernel timestamp of last accepted edge
+} button_info_t;
 
 /********************
  * STATIC VARIABLES *
  ********************/
 
 static struct gpiod_chip * chip;
-static struct button_info_t * buttons_list = NULL;
+static struct gpiod_line_bulk lines;
+static button_info_t buttons[MAX_BUTTONS];
+static size_t buttons_count;
+static button_handler_t buttons_handler;
+static pthread_t buttons_thread_id;
 
 /********************
  * STATIC FUNCTIONS *
  ********************/
 
-static void * button_event_thread( void * arg ) {
-    struct button_info_t * info = (struct button_info_t *)arg;
-    struct gpiod_line_event event;
-    uint64_t current_time;
+static uint64_t event_time_us( const struct gpiod_line_event * event ) {
+    return (uint64_t)event->ts.tv_sec * 1000000ULL +
+        (uint64_t)event->ts.tv_nsec / 1000ULL;
+}
+
+static void handle_button_events( button_info_t * info ) {
+    struct gpiod_line_event events[EVENTS_BATCH];
+    int count = gpiod_line_event_read_multiple(info->line, events, EVENTS_BATCH);
+    if( count <= 0 ) {
+        return;
+    }
+
+    config_t config;
+    config_get(&config);
+
+    // Edges are stamped by kernel when they happen, so scheduling delay of
+    // this thread doesn't affect debounce. Button pulls the line low.
+    for( int i = 0; i < count; i++ ) {
+        uint64_t event_time = event_time_us(&events[i]);
+        bool pressed = events[i].event_type == GPIOD_LINE_EVENT_FALLING_EDGE;
+        if( pressed == info->pressed ||
+                event_time - info->last_event_time < config.controls.debounce_us ) {
+            continue;
+        }
+        info->pressed = pressed;
+        info->last_event_time = event_time;
+        buttons_handler(info->gpio, pressed, event_time);
+    }
+}
+
+static void * buttons_event_thread( void * arg ) {
+    (void) arg;
+    struct pollfd fds[MAX_BUTTONS];
+
+    for( size_t i = 0; i < buttons_count; i++ ) {
+        fds[i].fd = gpiod_line_event_get_fd(buttons[i].line);
+        fds[i].events = POLLIN | POLLPRI;
+    }
 
     while(1) {
-        int ret = gpiod_line_event_wait(info->line, NULL);
-        if( ret == 1 ) {
-            ret = gpiod_line_event_read(info->line, &event);
-            if( ret == 0 ) {
-                current_time = get_current_time_us();
-                if( current_time - info->last_event_time >= DEBOUNCE_TIME_US ) {
-                    info->last_event_time = current_time;
-                    if( event.event_type == GPIOD_LINE_EVENT_RISING_EDGE ) {
-                        info->handler(info->gpio);
-                    }
-                }
+        if( poll(fds, buttons_count, -1) <= 0 ) {
+            continue;
+        }
+
+        for( size_t i = 0; i < buttons_count; i++ ) {
+            if( fds[i].revents & (POLLIN | POLLPRI) ) {
+                handle_button_events(&buttons[i]);
             }
         }
     }
@@ -81,51 +115,51 @@ static void * button_event_thread( void * arg ) {
  * GLOBAL FUNCTIONS *
  ********************/
 
-result_t controls_hw_init_button( button_gpio_t gpio, button_handler_t handler ) {
-    if( !chip ) {
-        chip = gpiod_chip_open(GPIO_CHIP_PATH);
-        if( !chip ) {
-            return RES_ERR_NOT_READY;
-        }
-    }
+result_t controls_hw_init_buttons( const button_gpio_t * gpios, size_t count,
+        button_handler_t handler ) {
+    RETURN_IF_NULL(gpios);
+    RETURN_IF_NULL(handler);
+    RETURN_ERROR_IF( count == 0 || count > MAX_BUTTONS, RES_ERR_INVALID_SIZE );
+    RETURN_ERROR_IF( chip != NULL, RES_ERR_GENERIC );
 
-    struct button_info_t * info = malloc(sizeof(struct button_info_t));
-    if( !info ) {
+    chip = gpiod_chip_open(GPIO_CHIP_PATH);
+    if( !chip ) {
         return RES_ERR_NOT_READY;
     }
 
-    info->gpio = gpio;
-    info->handler = handler;
-    info->last_event_time = 0;
-
-    info->line = gpiod_chip_get_line(chip, (unsigned int)gpio);
-    if( !info->line ) {
-        free(info);
-        return RES_ERR_GENERIC;
+    unsigned int offsets[MAX_BUTTONS];
+    for( size_t i = 0; i < count; i++ ) {
+        offsets[i] = (unsigned int)gpios[i];
     }
 
-    char label[32];
-    snprintf(label, sizeof(label), "button_%d", gpio);
-
     struct gpiod_line_request_config config = {
-        .consumer = label,
-        .request_type = GPIOD_LINE_REQUEST_EVENT_RISING_EDGE,
+        .consumer = GPIO_CONSUMER,
+        .request_type = GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES,
         .flags = GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP
     };
 
-    if( gpiod_line_request(info->line, &config, 0) < 0 ) {
-        free(info);
+    if( gpiod_chip_get_lines(chip, offsets, (unsigned int)count, &lines) != 0 ||
+            gpiod_line_request_bulk(&lines, &config, NULL) != 0 ) {
+        gpiod_chip_close(chip);
+        chip = NULL;
         return RES_ERR_GENERIC;
     }
 
-    if( pthread_create(&info->thread_id, NULL, button_event_thread, info) != 0 ) {
-        gpiod_line_release(info->line);
-        free(info);
-        return RES_ERR_GENERIC;
+    for( size_t i = 0; i < count; i++ ) {
+        buttons[i].gpio = gpios[i];
+        buttons[i].line = gpiod_line_bulk_get_line(&lines, (unsigned int)i);
+        buttons[i].pressed = false;
+        buttons[i].last_event_time = 0;
     }
+    buttons_count = count;
+    buttons_handler = handler;
 
-    info->next = buttons_list;
-    buttons_list = info;
+    if( pthread_create(&buttons_thread_id, NULL, buttons_event_thread, NULL) != 0 ) {
+        gpiod_line_release_bulk(&lines);
+        gpiod_chip_close(chip);
+        chip = NULL;
+        return RES_ERR_GENERIC;
+    }
 
     return RES_OK;
 }
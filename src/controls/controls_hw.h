@@ -24,7 +24,8 @@ extern "C" {
  * TYPEDEFS AND STATIC INLINES *
  *******************************/
 
-typedef void (*button_handler_t)(button_gpio_t gpio);
+// Called from buttons thread, time is kernel timestamp of the edge
+typedef void (*button_handler_t)(button_gpio_t gpio, bool pressed, uint64_t time_us);
 
 static inline const char* button_gpio_enum_to_string( button_gpio_t button_gpio ) {
     switch( button_gpio ) {
@@ -40,8 +41,8 @@ static inline const char* button_gpio_enum_to_string( button_gpio_t button_gpio
  * GLOBAL FUNCTION PROTOTYPES *
  ******************************/
 
-extern result_t controls_hw_init_button( button_gpio_t gpio, 
-    button_handler_t handler );
+extern result_t controls_hw_init_buttons( const button_gpio_t * gpios,
+    size_t count, button_handler_t handler );
 
 #ifdef __cplusplus
 }
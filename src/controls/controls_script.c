@@ -0,0 +1,268 @@
+/**
+ *******************************************************************************
+ * @file    controls_script.c
+ * @brief   Scripted controls source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "utils.h"
+
+#include "controls_script.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define MAX_LINE_SIZE       256
+#define MAX_PATH_SIZE       256
+#define TOKEN_DELIMITERS    " \t\r\n"
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct {
+    char path[MAX_PATH_SIZE];
+    button_handler_t handler;
+    pthread_t thread_id;
+} script_source_t;
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static script_source_t source;
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static result_t parse_number( const char * token, uint64_t * value OUTPUT ) {
+    RETURN_ERROR_IF( *token < '0' || *token > '9', RES_ERR_WRONG_ARGS );
+
+    char * end = NULL;
+    errno = 0;
+    unsigned long long parsed = strtoull(token, &end, 10);
+    RETURN_ERROR_IF( errno != 0 || *end != '\0', RES_ERR_WRONG_ARGS );
+
+    *value = (uint64_t)parsed;
+    return RES_OK;
+}
+
+static result_t parse_button( const char * token, button_gpio_t * gpio OUTPUT ) {
+    if( strcmp(token, "<") == 0 || strcasecmp(token, "DOWN") == 0 ) {
+        *gpio = BUTTON_DOWN_GPIO;
+    } else if( strcasecmp(token, "O") == 0 || strcasecmp(token, "OK") == 0 ) {
+        *gpio = BUTTON_OK_GPIO;
+    } else if( strcmp(token, ">") == 0 || strcasecmp(token, "UP") == 0 ) {
+        *gpio = BUTTON_UP_GPIO;
+    } else {
+        return RES_ERR_WRONG_ARGS;
+    }
+
+    return RES_OK;
+}
+
+static void sleep_until_us( uint64_t time_us ) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(time_us / US_PER_SEC),
+        .tv_nsec = (long)((time_us % US_PER_SEC) * NS_PER_US)
+    };
+
+    // Absolute deadline, so time spent in handler doesn't accumulate
+    while( clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR ) {
+    }
+}
+
+static FILE * open_script( const char * path, bool * reopen OUTPUT ) {
+    struct stat st;
+    if( stat(path, &st) != 0 ) {
+        return NULL;
+    }
+
+    *reopen = S_ISFIFO(st.st_mode);
+    if( !S_ISSOCK(st.st_mode) ) {
+        // FIFO blocks here until writer connects
+        return fopen(path, "r");
+    }
+
+    union {
+        struct sockaddr base;
+        struct sockaddr_un un;
+    } addr = { .un = { .sun_family = AF_UNIX } };
+    size_t path_len = strlen(path);
+    if( path_len >= sizeof(addr.un.sun_path) ) {
+        return NULL;
+    }
+    memcpy(addr.un.sun_path, path, path_len + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if( fd < 0 ) {
+        return NULL;
+    }
+
+    if( connect(fd, &addr.base, sizeof(addr.un)) != 0 ) {
+        close(fd);
+        return NULL;
+    }
+
+    FILE * file = fdopen(fd, "r");
+    if( !file ) {
+        close(fd);
+    }
+    return file;
+}
+
+static void run_script( FILE * file, const char * path UNUSED_PARAM,
+        button_handler_t handler ) {
+    char line[MAX_LINE_SIZE];
+    unsigned int line_no = 0;
+    uint64_t prev_ms = 0;
+    uint64_t start_us = get_current_time_us();
+
+    while( fgets(line, sizeof(line), file) ) {
+        line_no++;
+
+        script_step_t step;
+        if( controls_script_parse_line(line, prev_ms, &step) != RES_OK ) {
+            WARN("%s:%u: wrong script line skipped.", path, line_no);
+            continue;
+        }
+        if( step.action == SCRIPT_ACTION_NONE ) {
+            continue;
+        }
+        prev_ms = step.time_ms;
+
+        // Edges are stamped with planned time, like kernel stamps GPIO edges
+        uint64_t time_us = start_us + step.time_ms * 1000ULL;
+        sleep_until_us(time_us);
+        if( step.action != SCRIPT_ACTION_UP ) {
+            handler(step.gpio, true, time_us);
+        }
+
+        if( step.action == SCRIPT_ACTION_PRESS ) {
+            time_us += step.hold_ms * 1000ULL;
+            sleep_until_us(time_us);
+        }
+        if( step.action != SCRIPT_ACTION_DOWN ) {
+            handler(step.gpio, false, time_us);
+        }
+    }
+}
+
+static void * script_thread( void * arg ) {
+    script_source_t * src = (script_source_t *)arg;
+
+    while(1) {
+        bool reopen = false;
+        FILE * file = open_script(src->path, &reopen);
+        if( !file ) {
+            ERROR("Can't open controls script %s.", src->path);
+            return NULL;
+        }
+
+        INFO("Controls script %s started.", src->path);
+        run_script(file, src->path, src->handler);
+        fclose(file);
+        INFO("Controls script %s finished.", src->path);
+
+        // FIFO waits for the next writer, file and socket are played once
+        if( !reopen ) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t controls_script_parse_line( const char * line, uint64_t prev_ms,
+        script_step_t * step OUTPUT ) {
+    RETURN_IF_NULL(line);
+    RETURN_IF_NULL(step);
+
+    char buf[MAX_LINE_SIZE];
+    RETURN_ERROR_IF( strlen(line) >= sizeof(buf), RES_ERR_INVALID_SIZE );
+    strcpy(buf, line);
+
+    char * comment = strchr(buf, '#');
+    if( comment ) {
+        *comment = '\0';
+    }
+
+    memset(step, 0, sizeof(script_step_t));
+    step->action = SCRIPT_ACTION_NONE;
+
+    char * save = NULL;
+    char * time_token = strtok_r(buf, TOKEN_DELIMITERS, &save);
+    if( !time_token ) {
+        return RES_OK;
+    }
+    char * button_token = strtok_r(NULL, TOKEN_DELIMITERS, &save);
+    char * action_token = strtok_r(NULL, TOKEN_DELIMITERS, &save);
+    char * hold_token = strtok_r(NULL, TOKEN_DELIMITERS, &save);
+    RETURN_ERROR_IF( !button_token || !action_token, RES_ERR_WRONG_ARGS );
+    RETURN_ERROR_IF( strtok_r(NULL, TOKEN_DELIMITERS, &save), RES_ERR_WRONG_ARGS );
+
+    bool relative = time_token[0] == '+';
+    uint64_t time_ms = 0;
+    RETURN_ON_ERROR( parse_number(relative ? time_token + 1 : time_token, &time_ms) );
+    step->time_ms = relative ? prev_ms + time_ms : time_ms;
+
+    RETURN_ON_ERROR( parse_button(button_token, &step->gpio) );
+
+    if( strcasecmp(action_token, "down") == 0 ) {
+        step->action = SCRIPT_ACTION_DOWN;
+    } else if( strcasecmp(action_token, "up") == 0 ) {
+        step->action = SCRIPT_ACTION_UP;
+    } else if( strcasecmp(action_token, "press") == 0 ) {
+        step->action = SCRIPT_ACTION_PRESS;
+        step->hold_ms = CONTROLS_SCRIPT_DEFAULT_HOLD_MS;
+    } else {
+        return RES_ERR_WRONG_ARGS;
+    }
+
+    if( hold_token ) {
+        RETURN_ERROR_IF( step->action != SCRIPT_ACTION_PRESS, RES_ERR_WRONG_ARGS );
+        uint64_t hold_ms = 0;
+        RETURN_ON_ERROR( parse_number(hold_token, &hold_ms) );
+        RETURN_ERROR_IF( hold_ms > UINT32_MAX, RES_ERR_WRONG_ARGS );
+        step->hold_ms = (uint32_t)hold_ms;
+    }
+
+    return RES_OK;
+}
+
+result_t controls_script_init_buttons( const char * path,
+        button_handler_t handler ) {
+    RETURN_IF_NULL(path);
+    RETURN_IF_NULL(handler);
+    RETURN_ERROR_IF( strlen(path) >= sizeof(source.path), RES_ERR_INVALID_SIZE );
+
+    snprintf(source.path, sizeof(source.path), "%s", path);
+    source.handler = handler;
+
+    RETURN_ERROR_IF( pthread_create(&source.thread_id, NULL, script_thread,
+        &source) != 0, RES_ERR_GENERIC );
+
+    return RES_OK;
+}
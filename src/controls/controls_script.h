@@ -0,0 +1,71 @@
+/**
+ *******************************************************************************
+ * @file    controls_script.h
+ * @brief   Scripted controls header file.
+ *          Virtual buttons driven by timed script read from regular file,
+ *          FIFO or UNIX stream socket, so UI can be tested without GPIO.
+ *
+ *          Each line is: <time_ms> <button> <action>, where
+ *          - time is from script start, or from previous line with "+",
+ *          - button is "<", "O", ">" (or DOWN, OK, UP),
+ *          - action is "down", "up" or "press [hold_ms]" (default 80 ms).
+ *          Everything after "#" is a comment.
+ *******************************************************************************
+ */
+
+#ifndef CONTROLS_SCRIPT_H
+#define CONTROLS_SCRIPT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdint.h>
+
+#include "utils.h"
+#include "controls_gpio.h"
+#include "controls_hw.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define CONTROLS_SCRIPT_DEFAULT_HOLD_MS     80
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef enum {
+    SCRIPT_ACTION_NONE,         // Empty or comment line
+    SCRIPT_ACTION_DOWN,
+    SCRIPT_ACTION_UP,
+    SCRIPT_ACTION_PRESS
+} script_action_t;
+
+typedef struct {
+    uint64_t time_ms;           // From script start, already resolved
+    button_gpio_t gpio;
+    script_action_t action;
+    uint32_t hold_ms;           // Only for press
+} script_step_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t controls_script_parse_line( const char * line, uint64_t prev_ms,
+    script_step_t * step OUTPUT );
+
+extern result_t controls_script_init_buttons( const char * path,
+    button_handler_t handler );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROLS_SCRIPT_H */
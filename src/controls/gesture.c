@@ -0,0 +1,192 @@
+/**
+ *******************************************************************************
+ * @file    gesture.c
+ * @brief   Button gesture recognizer source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <string.h>
+
+#include "utils.h"
+#include "timer_service.h"
+
+#include "gesture.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define DEFAULT_LONG_PRESS_MS       600
+#define DEFAULT_DOUBLE_PRESS_MS     300
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static gesture_button_t * find_button( gesture_recognizer_t * recognizer,
+        button_gpio_t gpio ) {
+    for( size_t i = 0; i < recognizer->count; i++ ) {
+        if( recognizer->buttons[i].gpio == gpio ) {
+            return &recognizer->buttons[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void emit( gesture_recognizer_t * recognizer, gesture_type_t type,
+        button_gpio_t button, button_gpio_t chord_button ) {
+    const gesture_t gesture = {
+        .type = type,
+        .button = button,
+        .chord_button = chord_button
+    };
+    recognizer->callback(&gesture, recognizer->user_data);
+}
+
+// Callback takes recognizer lock held here, so it can't be waited for. It 
+// checks the button state again, so a late one does nothing.
+static void stop_long_timer( gesture_button_t * button ) {
+    if( button->long_timer != TIMER_ID_INVALID ) {
+        timer_service_cancel(button->long_timer);
+        button->long_timer = TIMER_ID_INVALID;
+    }
+}
+
+static void long_timer_callback( void * user_data ) {
+    gesture_button_t * button = (gesture_button_t *)user_data;
+    gesture_recognizer_timeout(button->owner, button->gpio, get_current_time_us());
+}
+
+static void handle_press( gesture_recognizer_t * recognizer,
+        gesture_button_t * button, uint64_t time_us ) {
+    button->pressed = true;
+    button->consumed = false;
+    button->press_us = time_us;
+
+    // Second button while the first is still held, both releases are ignored
+    for( size_t i = 0; i < recognizer->count; i++ ) {
+        gesture_button_t * other = &recognizer->buttons[i];
+        if( other != button && other->pressed && !other->consumed ) {
+            stop_long_timer(other);
+            other->consumed = true;
+            button->consumed = true;
+            emit(recognizer, GESTURE_CHORD, button->gpio, other->gpio);
+            return;
+        }
+    }
+
+    if( button->release_us != 0 &&
+            time_us - button->release_us <= recognizer->double_press_ms * 1000ULL ) {
+        button->consumed = true;
+        button->release_us = 0;
+        emit(recognizer, GESTURE_DOUBLE, button->gpio, button->gpio);
+        return;
+    }
+
+    // Without timer long press is lost, but short one still works
+    if( timer_service_start_oneshot(recognizer->long_press_ms, long_timer_callback,
+            button, &button->long_timer) != RES_OK ) {
+        button->long_timer = TIMER_ID_INVALID;
+    }
+}
+
+static void handle_release( gesture_recognizer_t * recognizer,
+        gesture_button_t * button, uint64_t time_us ) {
+    button->pressed = false;
+    stop_long_timer(button);
+
+    if( button->consumed ) {
+        button->release_us = 0;
+        return;
+    }
+
+    button->release_us = time_us;
+    emit(recognizer, GESTURE_SHORT, button->gpio, button->gpio);
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t gesture_recognizer_init( gesture_recognizer_t * recognizer,
+        const button_gpio_t * gpios, size_t count,
+        gesture_callback_t callback, void * user_data ) {
+    RETURN_IF_NULL(recognizer);
+    RETURN_IF_NULL(gpios);
+    RETURN_IF_NULL(callback);
+    RETURN_ERROR_IF( count == 0 || count > GESTURE_MAX_BUTTONS, RES_ERR_INVALID_SIZE );
+
+    pthread_mutex_lock(&recognizer->lock);
+    memset(recognizer->buttons, 0, sizeof(recognizer->buttons));
+    for( size_t i = 0; i < count; i++ ) {
+        recognizer->buttons[i].gpio = gpios[i];
+        recognizer->buttons[i].long_timer = TIMER_ID_INVALID;
+        recognizer->buttons[i].owner = recognizer;
+    }
+    recognizer->count = count;
+    recognizer->long_press_ms = DEFAULT_LONG_PRESS_MS;
+    recognizer->double_press_ms = DEFAULT_DOUBLE_PRESS_MS;
+    recognizer->callback = callback;
+    recognizer->user_data = user_data;
+    pthread_mutex_unlock(&recognizer->lock);
+
+    return RES_OK;
+}
+
+void gesture_recognizer_set_timing( gesture_recognizer_t * recognizer,
+        uint32_t long_press_ms, uint32_t double_press_ms ) {
+    pthread_mutex_lock(&recognizer->lock);
+    recognizer->long_press_ms = long_press_ms;
+    recognizer->double_press_ms = double_press_ms;
+    pthread_mutex_unlock(&recognizer->lock);
+}
+
+result_t gesture_recognizer_edge( gesture_recognizer_t * recognizer,
+        button_gpio_t gpio, bool pressed, uint64_t time_us ) {
+    RETURN_IF_NULL(recognizer);
+
+    pthread_mutex_lock(&recognizer->lock);
+    gesture_button_t * button = find_button(recognizer, gpio);
+    if( !button ) {
+        pthread_mutex_unlock(&recognizer->lock);
+        return RES_ERR_WRONG_ARGS;
+    }
+
+    // Repeated edge (e.g. one lost in debounce) doesn't change state
+    if( pressed && !button->pressed ) {
+        handle_press(recognizer, button, time_us);
+    } else if( !pressed && button->pressed ) {
+        handle_release(recognizer, button, time_us);
+    }
+    pthread_mutex_unlock(&recognizer->lock);
+
+    return RES_OK;
+}
+
+result_t gesture_recognizer_timeout( gesture_recognizer_t * recognizer,
+        button_gpio_t gpio, uint64_t now_us ) {
+    RETURN_IF_NULL(recognizer);
+
+    pthread_mutex_lock(&recognizer->lock);
+    gesture_button_t * button = find_button(recognizer, gpio);
+    if( !button ) {
+        pthread_mutex_unlock(&recognizer->lock);
+        return RES_ERR_WRONG_ARGS;
+    }
+
+    // Timer of earlier press may fire late, so the held time is checked too
+    if( button->pressed && !button->consumed &&
+            now_us - button->press_us >= recognizer->long_press_ms * 1000ULL ) {
+        button->long_timer = TIMER_ID_INVALID;
+        button->consumed = true;
+        emit(recognizer, GESTURE_LONG, button->gpio, button->gpio);
+    }
+    pthread_mutex_unlock(&recognizer->lock);
+
+    return RES_OK;
+}
@@ -0,0 +1,115 @@
+/**
+ *******************************************************************************
+ * @file    gesture.h
+ * @brief   Button gesture recognizer header file.
+ *          Turns press and release edges into short, long, double and chord
+ *          gestures. Short press is reported on release and double press on
+ *          the second press, so neither waits for a timeout. Long press is
+ *          reported by a timer while the button is still held.
+ *******************************************************************************
+ */
+
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "utils.h"
+#include "timer_service.h"
+#include "controls_gpio.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define GESTURE_MAX_BUTTONS         4
+
+#define GESTURE_RECOGNIZER_INIT { \
+    .lock = PTHREAD_MUTEX_INITIALIZER, \
+    .count = 0 \
+}
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef enum {
+    GESTURE_SHORT,
+    GESTURE_LONG,
+    GESTURE_DOUBLE,
+    GESTURE_CHORD
+} gesture_type_t;
+
+static inline const char* gesture_type_enum_to_string( gesture_type_t type ) {
+    switch( type ) {
+        case GESTURE_SHORT:     return "SHORT";
+        case GESTURE_LONG:      return "LONG";
+        case GESTURE_DOUBLE:    return "DOUBLE";
+        case GESTURE_CHORD:     return "CHORD";
+        default:                return "UNDEFINED";
+    }
+}
+
+typedef struct {
+    gesture_type_t type;
+    button_gpio_t button;
+    button_gpio_t chord_button;     // Button held before, only for chord
+} gesture_t;
+
+// Called with recognizer locked, keep it short and non-blocking
+typedef void (*gesture_callback_t)(const gesture_t * gesture, void * user_data);
+
+struct gesture_recognizer_t;
+
+typedef struct {
+    button_gpio_t gpio;
+    bool pressed;
+    bool consumed;              // Press already ended as long, double or chord
+    uint64_t press_us;
+    uint64_t release_us;        // Of last short press, 0 if there is none
+    timer_id_t long_timer;
+    struct gesture_recognizer_t * owner;
+} gesture_button_t;
+
+typedef struct gesture_recognizer_t {
+    pthread_mutex_t lock;
+    gesture_button_t buttons[GESTURE_MAX_BUTTONS];
+    size_t count;
+
+    uint32_t long_press_ms;
+    uint32_t double_press_ms;
+
+    gesture_callback_t callback;
+    void * user_data;
+} gesture_recognizer_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t gesture_recognizer_init( gesture_recognizer_t * recognizer,
+    const button_gpio_t * gpios, size_t count,
+    gesture_callback_t callback, void * user_data );
+extern void gesture_recognizer_set_timing( gesture_recognizer_t * recognizer,
+    uint32_t long_press_ms, uint32_t double_press_ms );
+
+// Times are CLOCK_MONOTONIC, e.g. kernel timestamps of GPIO edges
+extern result_t gesture_recognizer_edge( gesture_recognizer_t * recognizer,
+    button_gpio_t gpio, bool pressed, uint64_t time_us );
+extern result_t gesture_recognizer_timeout( gesture_recognizer_t * recognizer,
+    button_gpio_t gpio, uint64_t now_us );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GESTURE_H */
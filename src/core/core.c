@@ -17,18 +17,23 @@
 #include <unistd.h>
 
 #include "utils.h"
+#include "config.h"
 
 #include "core.h"
 #include "event_broker.h"
 #include "controls.h"
 #include "controls_gpio.h"
+#include "gesture.h"
 #include "display.h"
 
 /******************************
  * PRIVATE MACROS AND DEFINES *
  ******************************/
 
-#define EOF_POS -1
+#define ANSWER_READ_CHUNK   1024
+#define NO_PAGE             -1
+
+#define IDLE_HINT           "Idle. Any button wakes up."
 
 /********************
  * PRIVATE TYPEDEFS *
@@ -42,10 +47,9 @@ typedef enum {
 } core_state_t;
 
 typedef struct {
-    FILE * last_answer_file; 
-    long page_pos;   
-    long page_pos_history[64];
-    int  page_pos_history_idx;
+    text_layout_t layout;       // Wrapped once, pages are just row ranges
+    bool loaded;
+    int page;                   // NO_PAGE outside of answer view
 } answer_context_t;
 
 typedef struct {
@@ -54,6 +58,10 @@ typedef struct {
     answer_context_t ans;    
 
     uint64_t last_time_pressed_ok_us;
+
+    uint64_t idle_timeout_us;   // 0 never idles
+    uint64_t last_activity_us;
+    bool idle;
 } core_context_t;
 
 /********************
@@ -65,12 +73,25 @@ static void show_welcome_text( display_menu_t * menu ) {
     display_menu_append_text(menu, "Welcome!\n", COLOR_TIP);
     display_menu_append_text(menu, "> To start recording, press \"O\".\n", COLOR_TIP);
     display_menu_append_text(menu, "> To stop any processing, press \"O\" again.\n", COLOR_TIP);
+    display_menu_append_text(menu, "> To start a new conversation, press \"<\".\n", COLOR_TIP);
+    display_menu_append_text(menu, "> To skip thinking, hold \"O\".\n", COLOR_TIP);
 }
 
 static void show_final_text( display_menu_t * menu ) {
     display_menu_clear(menu);
     display_menu_append_text(menu, "Do you want to show full prompt with answer?\n", COLOR_TIP);
-    display_menu_append_text(menu, "> To go to the view and then scroll, press \"<\" or \">\".\n", COLOR_TIP);
+    display_menu_append_text(menu, "> To go to the view, press \">\", then scroll with \"<\" or \">\".\n", COLOR_TIP);
+    display_menu_append_text(menu, "> Hold or double press to jump to the last or first page.\n", COLOR_TIP);
+    display_menu_append_text(menu, "> To start a new conversation, press \"<\".\n", COLOR_TIP);
+}
+
+static void change_state( core_context_t * context, core_state_t state ) {
+    if( context->state == CORE_STATE_STT_PROCESSING && 
+            state != CORE_STATE_STT_PROCESSING ) {
+        // Partial transcript is only a preview, final one goes to the LLM
+        display_menu_clear_below(&context->menu);
+    }
+    context->state = state;
 }
 
 static void update_last_time_pressed( uint64_t * last_time_pressed ) {
@@ -80,103 +101,114 @@ static void update_last_time_pressed( uint64_t * last_time_pressed ) {
 // === DISPLAY ANSWER ===
 
 static void answer_context_reinit( answer_context_t * context ) {
-    if( context->last_answer_file ) {
-        fclose(context->last_answer_file);
-    }
-    context->page_pos = 0;
-    memset(context->page_pos_history, 0, sizeof(context->page_pos_history));
-    context->page_pos_history_idx = -1;
+    text_layout_free(&context->layout);
+    context->loaded = false;
+    context->page = NO_PAGE;
 }
 
-static result_t answer_read_char( answer_context_t * context, char * ch ) {
-    fseek(context->last_answer_file, context->page_pos, SEEK_SET);  
-    int result = fgetc(context->last_answer_file); 
-    if( result != EOF ) {
-        *ch = (char)result;
-        context->page_pos = ftell(context->last_answer_file); 
-        return RES_OK; 
-    }
-    return RES_ERR_GENERIC;
-}
-
-static result_t answer_read_word( answer_context_t * context, char * word, 
-        int max_len ) {
-    int i = 0;
-    char ch;
-
-    while( i < max_len - 1 ) {
-        if( answer_read_char(context, &ch) != RES_OK ) {
-            context->page_pos = EOF_POS;
-            break;  
-        }
+static result_t answer_load_file( answer_context_t * context, const char * path ) {
+    answer_context_reinit(context);
 
-        if( ch == ' ' || ch == '\n' ) {
-            if( i > 0 ) {  
-                word[i++] = ch;
-                word[i] = '\0';
-                return RES_OK;
-            }
-            word[i++] = ch;
-            word[i] = '\0';
-            return RES_OK;
-        }
+    FILE * file = fopen(path, "r");
+    RETURN_IF_NULL(file);
 
-        word[i++] = ch; 
+    result_t res = display_menu_layout_init(&context->layout);
+    char chunk[ANSWER_READ_CHUNK];
+    size_t read = 0;
+    while( res == RES_OK && (read = fread(chunk, 1, sizeof(chunk), file)) > 0 ) {
+        res = text_layout_append(&context->layout, chunk, read, COLOR_FULL_OUTPUT, NULL);
     }
+    fclose(file);
 
-    if( i > 0 ) {
-        word[i] = '\0';
-        return RES_OK;
+    if( res != RES_OK ) {
+        text_layout_free(&context->layout);
+        return res;
     }
 
-    return RES_ERR_GENERIC;
+    context->loaded = true;
+    context->page = NO_PAGE;
+    return RES_OK;
 }
 
-static result_t answer_open_file( answer_context_t * context, char * path ) {
-    context->last_answer_file = fopen(path, "r");
-    RETURN_IF_NULL(context->last_answer_file);
-    return RES_OK;
+static int answer_page_count( answer_context_t * context ) {
+    uint32_t page_rows = display_menu_page_rows();
+    uint32_t rows = text_layout_rows(&context->layout);
+    return rows > 0 ? (int)((rows + page_rows - 1) / page_rows) : 1;
+}
+
+static void show_answer_page( core_context_t * context, int page ) {
+    uint32_t page_rows = display_menu_page_rows();
+    context->ans.page = page;
+    display_menu_show_rows(&context->menu, &context->ans.layout, 
+        (uint32_t)page * page_rows, page_rows);
 }
 
+// After the last page, the first one is shown again
 static void scroll_forward_last_answer( core_context_t * context ) {
-    if( context->ans.page_pos == EOF_POS ) {
-        context->ans.page_pos = 0;
-        context->ans.page_pos_history_idx = 0;
+    int next = context->ans.page + 1;
+    show_answer_page(context, next < answer_page_count(&context->ans) ? next : 0);
+}
+
+static void scroll_backward_last_answer( core_context_t * context ) {
+    if( context->ans.page > 0 ) {
+        show_answer_page(context, context->ans.page - 1);
     }
-    
-    if( context->ans.page_pos_history_idx < (int)(NELEMS(context->ans.page_pos_history) - 1) ) {
-        context->ans.page_pos_history_idx++;
-        context->ans.page_pos_history[context->ans.page_pos_history_idx] = context->ans.page_pos;
+}
+
+static void jump_first_answer_page( core_context_t * context ) {
+    show_answer_page(context, 0);
+}
+
+static void jump_last_answer_page( core_context_t * context ) {
+    show_answer_page(context, answer_page_count(&context->ans) - 1);
+}
+
+// === IDLE ===
+
+// Idle only waits for the next question, never in the middle of pipeline
+static uint32_t idle_wait_ms( core_context_t * context ) {
+    if( context->idle || context->idle_timeout_us == 0 || 
+            context->state != CORE_STATE_WAIT_FOR_START ) {
+        return BROKER_WAIT_FOREVER;
     }
 
-    display_menu_clear(&context->menu);
+    uint64_t idle_at_us = context->last_activity_us + context->idle_timeout_us;
+    uint64_t now_us = get_current_time_us();
+    if( now_us >= idle_at_us ) {
+        return 0;
+    }
+    return (uint32_t)((idle_at_us - now_us + MS_PER_SEC - 1) / MS_PER_SEC);
+}
 
-    char word[32];
-    while( !is_display_menu_almost_full(&context->menu) ) {
-        if( answer_read_word(&context->ans, word, NELEMS(word)) != RES_OK ) {
-            break;
-        }
+static void enter_idle_if_due( core_context_t * context ) {
+    if( idle_wait_ms(context) != 0 ) {
+        return;
+    }
 
-        display_menu_append_text(&context->menu, word, COLOR_FULL_OUTPUT);
+    display_menu_flush(&context->menu);
+    if( display_idle_on(IDLE_HINT, COLOR_TIP) != RES_OK ) {
+        // Tried again after another timeout, not in a busy loop
+        context->last_activity_us = get_current_time_us();
+        return;
     }
+
+    context->idle = true;
+    INFO("Display idle.");
 }
 
-static void scroll_backward_last_answer( core_context_t * context ) {
-    if( context->ans.page_pos_history_idx > 0 ) {
-        context->ans.page_pos_history_idx--;
-        context->ans.page_pos = context->ans.page_pos_history[context->ans.page_pos_history_idx];
-
-        display_menu_clear(&context->menu);
-
-        char word[32];
-        while( !is_display_menu_almost_full(&context->menu) ) {
-            if( answer_read_word(&context->ans, word, NELEMS(word)) != RES_OK ) {
-                break;
-            } 
-            
-            display_menu_append_text(&context->menu, word, COLOR_FULL_OUTPUT);
-        }
+// Any event counts as activity. Button press that wakes the panel only wakes
+// it, as the hint says, so it is consumed. Returns true if it was.
+static bool wake_up( core_context_t * context, const event_t * e ) {
+    context->last_activity_us = get_current_time_us();
+    if( !context->idle ) {
+        return false;
     }
+
+    display_idle_off();
+    context->idle = false;
+    INFO("Display woken up.");
+
+    return e->type == EVENT_BUT_GESTURE;
 }
 
 // === EVENTS ===
@@ -233,12 +265,44 @@ static void llm_stop_event_publish( void ) {
     }
 }
 
+static void llm_skip_think_event_publish( void ) {
+    event_t event = STRUCT_INIT_ALL_ZEROS;
+    result_t res = event_create(
+        COMPONENT_CORE_DISP, COMPONENT_LLM,
+        EVENT_LLM_SKIP_THINK, 
+        NULL, 0,
+        &event);
+
+    if( res == RES_OK ) {
+        broker_publish(&event);
+    }
+}
+
+static void llm_session_reset_event_publish( void ) {
+    event_t event = STRUCT_INIT_ALL_ZEROS;
+    result_t res = event_create(
+        COMPONENT_CORE_DISP, COMPONENT_LLM,
+        EVENT_LLM_SESSION_RESET, 
+        NULL, 0,
+        &event);
+
+    if( res == RES_OK ) {
+        broker_publish(&event);
+    }
+}
+
+static void reset_conversation( core_context_t * context ) {
+    llm_session_reset_event_publish();
+    display_menu_append_text(&context->menu, 
+        "Conversation reset.\n", COLOR_STATUS);
+}
+
 static void action_based_on_button( core_context_t * context, 
         button_gpio_t button ) {
     switch( button ) {
         case BUTTON_UP_GPIO: {
             if( context->state == CORE_STATE_WAIT_FOR_START ) {
-                if( context->ans.last_answer_file ) {
+                if( context->ans.loaded ) {
                     scroll_forward_last_answer(context);
                 }
             }
@@ -289,8 +353,11 @@ static void action_based_on_button( core_context_t * context,
 
         case BUTTON_DOWN_GPIO: {
             if( context->state == CORE_STATE_WAIT_FOR_START ) {
-                if( context->ans.last_answer_file ) {
+                if( context->ans.loaded && context->ans.page != NO_PAGE ) {
                     scroll_backward_last_answer(context);
+                } else {
+                    // Outside of answer view, so there is nothing to scroll
+                    reset_conversation(context);
                 }
             }
 
@@ -302,48 +369,110 @@ static void action_based_on_button( core_context_t * context,
     }
 }
 
+static bool is_answer_view( core_context_t * context ) {
+    return context->state == CORE_STATE_WAIT_FOR_START && 
+        context->ans.loaded && context->ans.page != NO_PAGE;
+}
+
+// Long and double press of scroll buttons jump to the end of the answer,
+// any other press that isn't bound does the same as the short one
+static void action_based_on_gesture( core_context_t * context, 
+        const gesture_t * gesture ) {
+    switch( gesture->type ) {
+        case GESTURE_SHORT: {
+            action_based_on_button(context, gesture->button);
+            break;
+        }
+
+        case GESTURE_LONG:
+        case GESTURE_DOUBLE: {
+            if( gesture->button == BUTTON_UP_GPIO && 
+                    context->state == CORE_STATE_WAIT_FOR_START &&
+                    context->ans.loaded ) {
+                jump_last_answer_page(context);
+            } else if( gesture->button == BUTTON_DOWN_GPIO && is_answer_view(context) ) {
+                jump_first_answer_page(context);
+            } else if( gesture->type == GESTURE_LONG && 
+                    gesture->button == BUTTON_OK_GPIO && 
+                    context->state == CORE_STATE_LLM_PROCESSING ) {
+                llm_skip_think_event_publish();
+            } else {
+                action_based_on_button(context, gesture->button);
+            }
+            break;
+        }
+
+        case GESTURE_CHORD: {
+            // Reset stays reachable in answer view, where "<" scrolls
+            bool scroll_chord = 
+                (gesture->button == BUTTON_UP_GPIO && gesture->chord_button == BUTTON_DOWN_GPIO) ||
+                (gesture->button == BUTTON_DOWN_GPIO && gesture->chord_button == BUTTON_UP_GPIO);
+            if( scroll_chord && context->state == CORE_STATE_WAIT_FOR_START ) {
+                reset_conversation(context);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
 
 void * core_thread( void * arg UNUSED_PARAM ) {
+    config_t config;
+    config_get(&config);
+
     core_context_t context = {
         .state = CORE_STATE_WAIT_FOR_START,
         .menu = DEFAULT_DISPLAY_MENU,
 
-        .last_time_pressed_ok_us = 0
+        .last_time_pressed_ok_us = 0,
+
+        .idle_timeout_us = (uint64_t)config.display.idle_timeout_s * US_PER_SEC,
+        .last_activity_us = get_current_time_us(),
+        .idle = false
     };
     answer_context_reinit(&context.ans);
 
     show_welcome_text(&context.menu);
 
     while(1) {
+        // Sleeps until event, pending flush or idle timeout, whichever is first
+        uint32_t flush_ms = display_menu_flush_delay_ms(&context.menu);
+        uint32_t idle_ms = idle_wait_ms(&context);
+        uint32_t wait_ms = flush_ms < idle_ms ? flush_ms : idle_ms;
+
         event_t e = STRUCT_INIT_ALL_ZEROS;
-        if( broker_pop(COMPONENT_CORE_DISP, &e) == RES_OK ) {
+        if( broker_pop_timeout(COMPONENT_CORE_DISP, &e, wait_ms) == RES_OK &&
+                !wake_up(&context, &e) ) {
             switch( e.type ) {
-                case EVENT_BUT_PRESSED: {
-                    button_gpio_t gpio;
-                    if( e.data_size != sizeof(gpio) ) {
+                case EVENT_BUT_GESTURE: {
+                    gesture_t gesture;
+                    if( e.data_size != sizeof(gesture) ) {
                         display_menu_append_text(&context.menu, 
-                            "Failed GPIO data in event.\n", COLOR_STATUS);
+                            "Failed gesture data in event.\n", COLOR_STATUS);
                         continue;
                     }
-                    memcpy(&gpio, e.data, e.data_size);
+                    memcpy(&gesture, e.data, e.data_size);
 
-                    action_based_on_button(&context, gpio);
+                    action_based_on_gesture(&context, &gesture);
 
                     break;
                 }
 
                 case EVENT_PIPELINE_DONE: {
-                    context.state = CORE_STATE_WAIT_FOR_START;
+                    change_state(&context, CORE_STATE_WAIT_FOR_START);
 
                     display_menu_append_text(&context.menu, "Pipeline done.\n", COLOR_STATUS);
 
                     char prompt_with_answer_path[EVENT_MAX_DATA_SIZE];
                     memcpy(prompt_with_answer_path, e.data, e.data_size);
                     
-                    if( answer_open_file(&context.ans, prompt_with_answer_path) != RES_OK ) {
+                    if( answer_load_file(&context.ans, prompt_with_answer_path) != RES_OK ) {
                         display_menu_append_text(&context.menu, 
                             "Can't open file with prompt and answer.\n", COLOR_STATUS);
                     } else {
@@ -354,7 +483,7 @@ void * core_thread( void * arg UNUSED_PARAM ) {
                 }
 
                 case EVENT_REC_STATUS: {
-                    context.state = CORE_STATE_REC_PROCESSING;
+                    change_state(&context, CORE_STATE_REC_PROCESSING);
 
                     char msg[EVENT_MAX_DATA_SIZE];
                     snprintf(msg, sizeof(msg), "%.*s", (int)e.data_size, e.data);
@@ -364,8 +493,31 @@ void * core_thread( void * arg UNUSED_PARAM ) {
                 }
 
                 case EVENT_STT_STATUS: {
-                    context.state = CORE_STATE_STT_PROCESSING;
+                    change_state(&context, CORE_STATE_STT_PROCESSING);
+
+                    char msg[EVENT_MAX_DATA_SIZE];
+                    snprintf(msg, sizeof(msg), "%.*s", (int)e.data_size, e.data);
+                    display_menu_update_line(&context.menu, msg, COLOR_STATUS);
+
+                    break;
+                }
+
+                case EVENT_STT_PARTIAL: {
+                    if( context.state != CORE_STATE_STT_PROCESSING ) {
+                        break;
+                    }
+
+                    char msg[EVENT_MAX_DATA_SIZE];
+                    snprintf(msg, sizeof(msg), "%.*s", (int)e.data_size, e.data);
+                    display_menu_update_below(&context.menu, msg, COLOR_PARTIAL_ANSWER);
+
+                    break;
+                }
+
+                case EVENT_LLM_THINKING: {
+                    change_state(&context, CORE_STATE_LLM_PROCESSING);
 
+                    // Spinner is redrawn in place, no matter how long it thinks
                     char msg[EVENT_MAX_DATA_SIZE];
                     snprintf(msg, sizeof(msg), "%.*s", (int)e.data_size, e.data);
                     display_menu_update_line(&context.menu, msg, COLOR_STATUS);
@@ -374,7 +526,7 @@ void * core_thread( void * arg UNUSED_PARAM ) {
                 }
 
                 case EVENT_LLM_STATUS: {
-                    context.state = CORE_STATE_LLM_PROCESSING;
+                    change_state(&context, CORE_STATE_LLM_PROCESSING);
 
                     char msg[EVENT_MAX_DATA_SIZE];
                     snprintf(msg, sizeof(msg), "%.*s", (int)e.data_size, e.data);
@@ -388,7 +540,8 @@ void * core_thread( void * arg UNUSED_PARAM ) {
             }
         }
 
-        usleep(30000);
+        display_menu_flush_due(&context.menu);
+        enter_idle_if_due(&context);
     }
 
     return NULL;
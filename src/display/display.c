@@ -12,6 +12,7 @@
 #include <string.h>
 
 #include "utils.h"
+#include "config.h"
 
 #include "display.h"
 #include "display_hw.h"
@@ -20,122 +21,378 @@
  * PRIVATE MACROS AND DEFINES *
  ******************************/
 
-#define FONT_TEXT       12
-#define LINE_HEIGHT     FONT_TEXT
+#define FONT_TEXT       (&font_pack_6x12)
+#define LINE_HEIGHT     ((uint16_t)FONT_TEXT->height)
+#define LAST_ROW_Y      ((uint32_t)(DISP_HEIGHT - LINE_HEIGHT))     // Not used, scrolls
 
-#define CHAR_WIDTH      (FONT_TEXT / 2)
-#define MAX_CHARS       (DISP_WIDTH / CHAR_WIDTH - 1)
-#define MAX_LINE_LENGTH (DISP_WIDTH / CHAR_WIDTH)
+// Menu text never goes to the last row, so the hint is removed without redraw
+#define IDLE_HINT_Y     ((uint16_t)LAST_ROW_Y)
+
+// Rows below the page are left for status appended in pager
+#define PAGE_ROWS       ((uint32_t)(DISP_HEIGHT / LINE_HEIGHT - 4))
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct {
+    uint64_t period_us;         // Whole panel frames, 0 draws at once
+    uint64_t epoch_us;          // Frame boundaries are counted from here
+} frame_pacing_t;
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static text_layout_t below_layout;      // Reused, display has only one thread
+static frame_pacing_t pacing;
 
 /********************
  * STATIC FUNCTIONS *
  ********************/
 
-static result_t wrap_write( display_menu_t * m, const char * text, uint32_t color ) {
-    RETURN_IF_NULL(m);
-    RETURN_IF_NULL(text);
+static result_t clear_line( uint16_t y ) {
+    return display_hw_clear_area(0, y, DISP_WIDTH, LINE_HEIGHT);
+}
 
-    const char * p = text;
-    char line_buf[MAX_LINE_LENGTH + 1];
+static result_t ensure_layout( display_menu_t * m ) {
+    if( !m->layout.pack ) {
+        return display_menu_layout_init(&m->layout);
+    }
+    return RES_OK;
+}
 
-    while( *p ) {
-        if( m->curr_y >= DISP_HEIGHT - LINE_HEIGHT ) {
-            RETURN_ON_ERROR( display_menu_clear(m));
-        }
+static uint32_t row_y( const display_menu_t * m, uint32_t row ) {
+    return m->top_y + (row - m->first_row) * LINE_HEIGHT;
+}
 
-        if( *p == '\n' || m->curr_x >= DISP_WIDTH ) {
-            RETURN_ON_ERROR( display_menu_new_line(m) );
-            if( *p == '\n' ) {
-                p++;
-                continue;
-            }
-        }
+// Draws line and clears the rest of its row, as re-wrapped word may have
+// moved down from there
+static result_t draw_line( const text_layout_t * layout, size_t idx, uint16_t y ) {
+    const text_line_t * line = &layout->lines[idx];
+    if( line->length > 0 ) {
+        RETURN_ON_ERROR( display_hw_write_text(line->x, y,
+            &layout->text[line->offset], line->length, line->color, layout->pack) );
+    }
 
-        while( *p == ' ' ) {
-            RETURN_ON_ERROR( display_hw_write_string(m->curr_x, m->curr_y, " ", 2, 
-                color, FONT_TEXT) );
-            m->curr_x += CHAR_WIDTH;
-            p++;
-            if( m->curr_x >= DISP_WIDTH ) {
-                display_menu_new_line(m);
-            }
+    bool row_end = idx + 1 == layout->line_count || layout->lines[idx + 1].row != line->row;
+    uint16_t end_x = (uint16_t)(line->x + line->width);
+    if( row_end && end_x < DISP_WIDTH ) {
+        RETURN_ON_ERROR( display_hw_clear_area(end_x, y,
+            (uint16_t)(DISP_WIDTH - end_x), LINE_HEIGHT) );
+    }
+
+    return RES_OK;
+}
+
+// Row at which the screen is cleared last, when text doesn't fit below.
+// Screens in between are never shown, so they aren't drawn at all.
+static bool find_scroll( const display_menu_t * m, size_t from,
+        uint32_t * first_row OUTPUT ) {
+    const text_layout_t * layout = &m->layout;
+    uint32_t top_y = m->top_y;
+    uint32_t row0 = m->first_row;
+    bool scrolled = false;
+
+    for( size_t i = from; i < layout->line_count; i++ ) {
+        const text_line_t * line = &layout->lines[i];
+        if( top_y + (line->row - row0) * LINE_HEIGHT < LAST_ROW_Y ) {
+            continue;
+        }
+        // Empty open line waits for text before it scrolls
+        if( i + 1 == layout->line_count && line->length == 0 ) {
+            break;
         }
+        top_y = 0;
+        row0 = line->row;
+        scrolled = true;
+    }
 
-        uint16_t word_len = 0;
-        while( p[word_len] && p[word_len] != ' ' && p[word_len] != '\n' ) {
-            word_len++;
+    *first_row = row0;
+    return scrolled;
+}
+
+static result_t draw_lines( display_menu_t * m, size_t from ) {
+    const text_layout_t * layout = &m->layout;
+    if( from >= layout->line_count ) {
+        return RES_OK;
+    }
+
+    uint32_t first_row = 0;
+    if( find_scroll(m, from, &first_row) ) {
+        RETURN_ON_ERROR( display_hw_clear() );
+        m->top_y = 0;
+        m->first_row = first_row;
+        from = text_layout_row_line(layout, first_row);
+    }
+
+    uint32_t cleared_row = layout->lines[from].row;
+    for( size_t i = from; i < layout->line_count; i++ ) {
+        const text_line_t * line = &layout->lines[i];
+        if( row_y(m, line->row) >= LAST_ROW_Y ) {
+            break;
         }
 
-        if( m->curr_x + word_len * CHAR_WIDTH >= DISP_WIDTH && m->curr_x > 0 ) {
-            RETURN_ON_ERROR( display_menu_new_line(m) );
+        // Rows without text (e.g. "\n\n") have no line to draw
+        for( uint32_t row = cleared_row + 1; row < line->row; row++ ) {
+            RETURN_ON_ERROR( clear_line((uint16_t)row_y(m, row)) );
         }
+        cleared_row = line->row;
 
-        memcpy(line_buf, p, word_len);
-        line_buf[word_len] = '\0';
+        RETURN_ON_ERROR( draw_line(layout, i, (uint16_t)row_y(m, line->row)) );
+    }
 
-        RETURN_ON_ERROR( display_hw_write_string(m->curr_x, m->curr_y, line_buf, 
-            word_len, color, FONT_TEXT) );
-        m->curr_x += (uint16_t)(word_len * CHAR_WIDTH);
+    return RES_OK;
+}
 
-        p += word_len;
+static void update_cursor( display_menu_t * m ) {
+    const text_layout_t * layout = &m->layout;
+    if( layout->line_count == 0 ) {
+        m->curr_x = 0;
+        m->curr_y = (uint16_t)m->top_y;
+        return;
     }
 
-    return RES_OK;
+    const text_line_t * open = &layout->lines[layout->line_count - 1];
+    m->curr_x = (uint16_t)(open->x + open->width);
+    m->curr_y = (uint16_t)row_y(m, open->row);
 }
 
-static result_t clear_line( uint16_t y ) {
-    return display_hw_clear_area(0, y, DISP_WIDTH - 1, LINE_HEIGHT - 1);
+// Next flush goes at frame boundary, at least one period after the last one
+static uint64_t next_frame_us( uint64_t after_us ) {
+    if( pacing.period_us == 0 || after_us < pacing.epoch_us ) {
+        return after_us;
+    }
+
+    uint64_t frames = (after_us - pacing.epoch_us + pacing.period_us - 1) / pacing.period_us;
+    return pacing.epoch_us + frames * pacing.period_us;
+}
+
+static result_t mark_dirty( display_menu_t * m, size_t first_changed ) {
+    if( !m->dirty ) {
+        uint64_t now_us = get_current_time_us();
+        uint64_t earliest_us = m->last_flush_us + pacing.period_us;
+        m->dirty = true;
+        m->dirty_from = first_changed;
+        m->flush_due_us = next_frame_us(now_us > earliest_us ? now_us : earliest_us);
+    } else if( first_changed < m->dirty_from ) {
+        m->dirty_from = first_changed;
+    }
+
+    return display_menu_flush_due(m);
+}
+
+static result_t append_and_mark( display_menu_t * m, const char * text,
+        uint32_t color ) {
+    RETURN_ON_ERROR( ensure_layout(m) );
+
+    size_t first_changed = 0;
+    RETURN_ON_ERROR( text_layout_append(&m->layout, text, strlen(text), color,
+        &first_changed) );
+    return mark_dirty(m, first_changed);
 }
 
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
 
+result_t display_menu_layout_init( text_layout_t * layout ) {
+    return text_layout_init(layout, FONT_TEXT, DISP_WIDTH);
+}
+
+uint32_t display_menu_page_rows( void ) {
+    return PAGE_ROWS;
+}
+
 result_t display_menu_new_line( display_menu_t * m ) {
     RETURN_IF_NULL(m);
 
-    m->curr_x = 0;
-    m->curr_y += LINE_HEIGHT;
-    if( m->curr_y >= DISP_HEIGHT ) {
-        m->curr_y = 0;
+    uint32_t color = m->layout.line_count > 0 ?
+        m->layout.lines[m->layout.line_count - 1].color : 0;
+    return append_and_mark(m, "\n", color);
+}
+
+result_t display_menu_update_line( display_menu_t * m, const char * text,
+        uint32_t color ) {
+    RETURN_IF_NULL(m);
+    RETURN_IF_NULL(text);
+    RETURN_ON_ERROR( ensure_layout(m) );
+
+    if( m->layout.line_count > 0 ) {
+        uint32_t row = m->layout.lines[m->layout.line_count - 1].row;
+        RETURN_ON_ERROR( text_layout_truncate_row(&m->layout, row) );
     }
 
-    return clear_line(m->curr_y);
+    return append_and_mark(m, text, color);
 }
 
-result_t display_menu_update_line( display_menu_t * m, const char * text, 
+result_t display_menu_append_text( display_menu_t * m, const char * text,
         uint32_t color ) {
     RETURN_IF_NULL(m);
     RETURN_IF_NULL(text);
+    return append_and_mark(m, text, color);
+}
 
-    m->curr_x = 0;
-    RETURN_ON_ERROR( clear_line(m->curr_y) );
+result_t display_menu_show_rows( display_menu_t * m, const text_layout_t * layout,
+        uint32_t first_row, uint32_t rows ) {
+    RETURN_IF_NULL(m);
+    RETURN_IF_NULL(layout);
+
+    RETURN_ON_ERROR( display_menu_clear(m) );
+
+    // Lines are taken as they are, the layout is already wrapped
+    size_t i = text_layout_row_line(layout, first_row);
+    for( ; i < layout->line_count && layout->lines[i].row < first_row + rows; i++ ) {
+        const text_line_t * line = &layout->lines[i];
+        if( line->length > 0 ) {
+            RETURN_ON_ERROR( display_hw_write_text(line->x,
+                (uint16_t)((line->row - first_row) * LINE_HEIGHT),
+                &layout->text[line->offset], line->length, line->color, layout->pack) );
+        }
+    }
+
+    // Next text goes below the page
+    uint32_t total = text_layout_rows(layout);
+    uint32_t shown = total > first_row ? total - first_row : 0;
+    m->top_y = (shown < rows ? shown : rows) * LINE_HEIGHT;
+    update_cursor(m);
 
-    return wrap_write(m, text, color);
+    return RES_OK;
 }
 
-result_t display_menu_append_text( display_menu_t * m, const char * text, 
+result_t display_menu_clear_below( display_menu_t * m ) {
+    RETURN_IF_NULL(m);
+
+    // Cursor is known only after pending text is drawn
+    RETURN_ON_ERROR( display_menu_flush(m) );
+
+    uint16_t below_y = (uint16_t)(m->curr_y + LINE_HEIGHT);
+    if( below_y >= DISP_HEIGHT ) {
+        return RES_OK;
+    }
+
+    return display_hw_clear_area(0, below_y, DISP_WIDTH,
+        (uint16_t)(DISP_HEIGHT - below_y));
+}
+
+result_t display_menu_update_below( display_menu_t * m, const char * text,
         uint32_t color ) {
     RETURN_IF_NULL(m);
-    RETURN_IF_NULL(text);        
-    return wrap_write(m, text, color);
+    RETURN_IF_NULL(text);
+
+    RETURN_ON_ERROR( display_menu_clear_below(m) );
+
+    // Text is drawn without moving the menu cursor, so the line above
+    // (e.g. progress) can still be updated in place
+    uint32_t below_y = (uint32_t)m->curr_y + LINE_HEIGHT;
+    uint32_t rows = (below_y < LAST_ROW_Y) ? (LAST_ROW_Y - below_y) / LINE_HEIGHT : 0;
+    if( rows == 0 ) {
+        return RES_OK;
+    }
+
+    if( !below_layout.pack ) {
+        RETURN_ON_ERROR( display_menu_layout_init(&below_layout) );
+    }
+    text_layout_clear(&below_layout);
+    RETURN_ON_ERROR( text_layout_append(&below_layout, text, strlen(text), color, NULL) );
+
+    // Keep the tail, as the newest words are the most relevant ones
+    uint32_t total = text_layout_rows(&below_layout);
+    uint32_t first_row = total > rows ? total - rows : 0;
+    for( size_t i = text_layout_row_line(&below_layout, first_row);
+            i < below_layout.line_count; i++ ) {
+        const text_line_t * line = &below_layout.lines[i];
+        if( line->length > 0 ) {
+            RETURN_ON_ERROR( display_hw_write_text(line->x,
+                (uint16_t)(below_y + (line->row - first_row) * LINE_HEIGHT),
+                &below_layout.text[line->offset], line->length, color,
+                below_layout.pack) );
+        }
+    }
+
+    return RES_OK;
 }
 
 result_t display_menu_clear( display_menu_t * m ) {
-    RETURN_IF_NULL(m);  
+    RETURN_IF_NULL(m);
 
     RETURN_ON_ERROR( display_hw_clear() );
+    text_layout_clear(&m->layout);
+    m->dirty = false;
+    m->first_row = 0;
+    m->top_y = 0;
     m->curr_x = 0;
     m->curr_y = 0;
 
     return RES_OK;
 }
 
-bool is_display_menu_almost_full( display_menu_t * m ) {
-    // TODO: make this more universal (why 4 lines)
-    return m->curr_y >= DISP_HEIGHT - 4 * LINE_HEIGHT;
+result_t display_menu_flush( display_menu_t * m ) {
+    RETURN_IF_NULL(m);
+    if( !m->dirty ) {
+        return RES_OK;
+    }
+
+    m->dirty = false;
+    m->last_flush_us = get_current_time_us();
+    RETURN_ON_ERROR( draw_lines(m, m->dirty_from) );
+    update_cursor(m);
+
+    return RES_OK;
+}
+
+result_t display_menu_flush_due( display_menu_t * m ) {
+    RETURN_IF_NULL(m);
+    if( !m->dirty || get_current_time_us() < m->flush_due_us ) {
+        return RES_OK;
+    }
+    return display_menu_flush(m);
 }
 
+uint32_t display_menu_flush_delay_ms( const display_menu_t * m ) {
+    if( !m || !m->dirty ) {
+        return UINT32_MAX;
+    }
+
+    uint64_t now_us = get_current_time_us();
+    if( now_us >= m->flush_due_us ) {
+        return 0;
+    }
+    return (uint32_t)((m->flush_due_us - now_us + MS_PER_SEC - 1) / MS_PER_SEC);
+}
+
+// Panel keeps its memory in idle mode and shows it with 8 colors, so waking
+// up only switches the mode back and removes the hint
+result_t display_idle_on( const char * hint, uint32_t color ) {
+    RETURN_IF_NULL(hint);
+
+    RETURN_ON_ERROR( clear_line(IDLE_HINT_Y) );
+    RETURN_ON_ERROR( display_hw_write_text(0, IDLE_HINT_Y, hint, strlen(hint),
+        color, FONT_TEXT) );
+    return display_hw_idle_on();
+}
+
+result_t display_idle_off( void ) {
+    RETURN_ON_ERROR( display_hw_idle_off() );
+    return clear_line(IDLE_HINT_Y);
+}
+
+// Flush period is rounded up to whole panel frames, so flushes keep the same
+// phase against panel refresh instead of drifting through it
 result_t display_init( void ) {
-    return display_hw_init();
+    RETURN_ON_ERROR( display_hw_init() );
+
+    config_t config;
+    config_get(&config);
+
+    uint64_t panel_hz = display_hw_frame_rate_hz();
+    pacing.period_us = 0;
+    if( config.display.max_fps > 0 ) {
+        uint64_t frames = (panel_hz + config.display.max_fps - 1) / config.display.max_fps;
+        pacing.period_us = frames * US_PER_SEC / panel_hz;
+    }
+    pacing.epoch_us = get_current_time_us();
+
+    INFO("Display flushes every %llu us.", (unsigned long long)pacing.period_us);
+    return RES_OK;
 }
@@ -17,6 +17,7 @@ extern "C" {
  ************/
 
 #include "utils.h"
+#include "text_layout.h"
 
 /**********************
  * MACROS AND DEFINES *
@@ -27,28 +28,51 @@ extern "C" {
 #define COLOR_PARTIAL_ANSWER    0x004E5F
 #define COLOR_FULL_OUTPUT       0x00C81F
 
-#define DEFAULT_DISPLAY_MENU    STRUCT_INIT_ALL_ZEROS
+#define DEFAULT_DISPLAY_MENU    { .layout = STRUCT_INIT_ALL_ZEROS }
 
 /************
  * TYPEDEFS *
  ************/
 
  typedef struct {
+    text_layout_t layout;       // Text shown since the last clear
+    uint32_t first_row;         // Of layout, at top_y
+    uint32_t top_y;
     uint16_t curr_x;
     uint16_t curr_y;
+
+    // Updates within one frame are drawn together by the next flush
+    bool dirty;
+    size_t dirty_from;          // First layout line to draw
+    uint64_t flush_due_us;
+    uint64_t last_flush_us;
 } display_menu_t;
 
 /******************************
  * GLOBAL FUNCTION PROTOTYPES *
  ******************************/
 
+extern result_t display_menu_layout_init( text_layout_t * layout );
+extern uint32_t display_menu_page_rows( void );
+
 extern result_t display_menu_new_line( display_menu_t * m );
 extern result_t display_menu_update_line( display_menu_t * m, const char * text, 
     uint32_t color );
 extern result_t display_menu_append_text( display_menu_t * m, const char * text, 
     uint32_t color );
+extern result_t display_menu_show_rows( display_menu_t * m, 
+    const text_layout_t * layout, uint32_t first_row, uint32_t rows );
+extern result_t display_menu_clear_below( display_menu_t * m );
+extern result_t display_menu_update_below( display_menu_t * m, const char * text, 
+    uint32_t color );
 extern result_t display_menu_clear( display_menu_t * m );
-extern bool is_display_menu_almost_full( display_menu_t * m );
+
+extern result_t display_menu_flush( display_menu_t * m );
+extern result_t display_menu_flush_due( display_menu_t * m );
+extern uint32_t display_menu_flush_delay_ms( const display_menu_t * m );
+
+extern result_t display_idle_on( const char * hint, uint32_t color );
+extern result_t display_idle_off( void );
 
 extern result_t display_init( void );
 
@@ -10,9 +10,14 @@
  * INCLUDES *
  ************/
 
+#include <string.h>
+
 #include "utils.h"
+#include "config.h"
+#include "display_hw.h"
 
 #include "driver_st7789_basic.h"
+#include "driver_st7789_interface.h"
 
 /******************************
  * PRIVATE MACROS AND DEFINES *
@@ -20,6 +25,153 @@
 
 #define COLOR_BACKGROUND    0x000000
 
+#define CMD_RDDID           0x04
+#define CMD_CASET           0x2A
+#define CMD_RASET           0x2B
+#define CMD_RAMWR           0x2C
+#define CMD_RAMRD           0x2E
+#define DC_COMMAND          0
+#define DC_DATA             1
+
+#define PROBE_PIXELS        16          // One row in top left corner
+#define PROBE_WRITE_SIZE    (PROBE_PIXELS * 2)      // RGB565
+#define PROBE_READ_SIZE     (1 + PROBE_PIXELS * 3)  // Dummy byte, RGB666
+#define PROBE_PATTERNS      3
+#define PROBE_TRIALS        3
+#define PROBE_STEP_HZ       8000000
+#define PROBE_MARGIN_PCT    75
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+// Panel refresh rates in normal mode, indexed by st7789_frame_rate_t
+static const uint8_t frame_rates_hz[] = {
+    119, 111, 105, 99, 94, 90, 86, 82, 78, 75, 72, 69, 67, 64, 62, 60,
+    58, 57, 55, 53, 52, 50, 49, 48, 46, 45, 44, 43, 42, 41, 40, 39
+};
+
+// Both used only from display thread
+static font_cache_t glyph_cache;
+static uint16_t text_pixels[DISP_WIDTH * FONT_MAX_HEIGHT];    // Column by column
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static result_t probe_command( uint8_t cmd, uint8_t * params, uint16_t len ) {
+    RETURN_ERROR_IF( st7789_interface_cmd_data_gpio_write(DC_COMMAND) != 0,
+        RES_ERR_GENERIC );
+    RETURN_ERROR_IF( st7789_interface_spi_write_cmd(&cmd, 1) != 0, RES_ERR_GENERIC );
+    if( len > 0 ) {
+        RETURN_ERROR_IF( st7789_interface_cmd_data_gpio_write(DC_DATA) != 0,
+            RES_ERR_GENERIC );
+        RETURN_ERROR_IF( st7789_interface_spi_write_cmd(params, len) != 0,
+            RES_ERR_GENERIC );
+    }
+    return RES_OK;
+}
+
+static result_t probe_read( uint8_t cmd, uint8_t * out OUTPUT, uint32_t len ) {
+    RETURN_ERROR_IF( st7789_interface_cmd_data_gpio_write(DC_COMMAND) != 0,
+        RES_ERR_GENERIC );
+    RETURN_ERROR_IF( st7789_interface_spi_write_read(&cmd, 1, out, len) != 0,
+        RES_ERR_GENERIC );
+    return RES_OK;
+}
+
+static result_t probe_window( void ) {
+    uint8_t columns[4] = { 0, 0, 0, PROBE_PIXELS - 1 };
+    uint8_t rows[4] = { 0, 0, 0, 0 };
+    RETURN_ON_ERROR( probe_command(CMD_CASET, columns, sizeof(columns)) );
+    RETURN_ON_ERROR( probe_command(CMD_RASET, rows, sizeof(rows)) );
+    return RES_OK;
+}
+
+static void probe_pattern( size_t index, uint8_t * pattern OUTPUT ) {
+    for( size_t i = 0; i < PROBE_WRITE_SIZE; i++ ) {
+        switch( index ) {
+            case 0:  pattern[i] = (i % 2) ? 0x55 : 0xAA;                 break;
+            case 1:  pattern[i] = (i % 2) ? 0xF0 : 0x0F;                 break;
+            default: pattern[i] = (uint8_t)(i * 37 + 11);                break;
+        }
+    }
+}
+
+static result_t probe_write_pattern( size_t index ) {
+    uint8_t pattern[PROBE_WRITE_SIZE];
+    probe_pattern(index, pattern);
+    RETURN_ON_ERROR( probe_window() );
+    RETURN_ON_ERROR( probe_command(CMD_RAMWR, pattern, sizeof(pattern)) );
+    return RES_OK;
+}
+
+static result_t probe_read_pattern( uint8_t * out OUTPUT ) {
+    RETURN_ON_ERROR( probe_window() );
+    RETURN_ON_ERROR( probe_read(CMD_RAMRD, out, PROBE_READ_SIZE) );
+    return RES_OK;
+}
+
+// Panel reads are specified much slower than writes, so data is read back
+// at the base clock and only the write path is tested at higher speed.
+static bool probe_clock( uint32_t base_hz, uint32_t clock_hz,
+        uint8_t reference[PROBE_PATTERNS][PROBE_READ_SIZE] ) {
+    uint8_t readback[PROBE_READ_SIZE];
+
+    for( size_t trial = 0; trial < PROBE_TRIALS; trial++ ) {
+        for( size_t t = 0; t < PROBE_PATTERNS; t++ ) {
+            bool ok = st7789_interface_spi_set_clock(clock_hz) == 0 &&
+                probe_write_pattern(t) == RES_OK &&
+                st7789_interface_spi_set_clock(base_hz) == 0 &&
+                probe_read_pattern(readback) == RES_OK &&
+                memcmp(readback, reference[t], PROBE_READ_SIZE) == 0;
+            if( !ok ) {
+                st7789_interface_spi_set_clock(base_hz);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static uint32_t probe_spi_clock( uint32_t base_hz, uint32_t max_hz ) {
+    uint8_t id[4] = { 0 };
+    if( probe_read(CMD_RDDID, id, sizeof(id)) != RES_OK ||
+            (id[1] == 0x00 && id[2] == 0x00 && id[3] == 0x00) ||
+            (id[1] == 0xFF && id[2] == 0xFF && id[3] == 0xFF) ) {
+        WARN("SPI probe skipped, no display ID read back.");
+        return base_hz;
+    }
+
+    // Reference readback at the base clock, in whatever format panel returns
+    uint8_t reference[PROBE_PATTERNS][PROBE_READ_SIZE];
+    for( size_t t = 0; t < PROBE_PATTERNS; t++ ) {
+        if( probe_write_pattern(t) != RES_OK ||
+                probe_read_pattern(reference[t]) != RES_OK ) {
+            WARN("SPI probe skipped, test pattern transfer failed.");
+            return base_hz;
+        }
+    }
+    if( memcmp(reference[0], reference[1], PROBE_READ_SIZE) == 0 ||
+            memcmp(reference[1], reference[2], PROBE_READ_SIZE) == 0 ) {
+        WARN("SPI probe skipped, display memory can't be read back.");
+        return base_hz;
+    }
+
+    uint32_t last_good_hz = base_hz;
+    for( uint32_t clock_hz = base_hz + PROBE_STEP_HZ; clock_hz <= max_hz;
+            clock_hz += PROBE_STEP_HZ ) {
+        if( !probe_clock(base_hz, clock_hz, reference) ) {
+            break;
+        }
+        last_good_hz = clock_hz;
+    }
+
+    uint32_t clock_hz = (uint32_t)((uint64_t)last_good_hz * PROBE_MARGIN_PCT / 100);
+    return (clock_hz > base_hz) ? clock_hz : base_hz;
+}
+
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
@@ -34,6 +186,16 @@ result_t display_hw_turn_off( void ) {
     return RES_OK;
 }
 
+result_t display_hw_idle_on( void ) {
+    RETURN_ERROR_IF( st7789_basic_idle_mode_on() != 0, RES_ERR_GENERIC );
+    return RES_OK;
+}
+
+result_t display_hw_idle_off( void ) {
+    RETURN_ERROR_IF( st7789_basic_idle_mode_off() != 0, RES_ERR_GENERIC );
+    return RES_OK;
+}
+
 result_t display_hw_clear( void ) {
     RETURN_ERROR_IF( st7789_basic_clear() != 0, RES_ERR_GENERIC );
     return RES_OK;
@@ -46,15 +208,74 @@ result_t display_hw_clear_area( uint16_t x, uint16_t y, uint16_t w, uint16_t h )
     return RES_OK;
 }
 
-result_t display_hw_write_string( uint16_t x, uint16_t y, char * str, uint16_t len, 
-        uint32_t color, uint16_t font ) {
-    RETURN_ERROR_IF( st7789_basic_string(x, y, str, len, color, (st7789_font_t)font) != 0, 
+result_t display_hw_write_text( uint16_t x, uint16_t y, const char * text, 
+        size_t len, uint32_t color, const font_pack_t * pack ) {
+    RETURN_IF_NULL(text);
+    RETURN_IF_NULL(pack);
+    RETURN_ERROR_IF( pack->height < 2 || pack->height > FONT_MAX_HEIGHT || 
+        x >= DISP_WIDTH || y + pack->height > DISP_HEIGHT, RES_ERR_WRONG_ARGS );
+
+    // Whole run is composed from cached glyphs and sent as one window, 
+    // what doesn't fit in the line is clipped
+    size_t height = pack->height;
+    size_t max_width = (size_t)(DISP_WIDTH - x);
+    size_t width = 0;
+    const char * end = text + len;
+    while( text < end ) {
+        const font_glyph_t * glyph = font_find_glyph(pack, font_utf8_next(&text, end));
+        if( !glyph ) {
+            continue;
+        }
+        if( width + glyph->advance > max_width ) {
+            break;
+        }
+
+        const uint16_t * pixels = font_cache_get(&glyph_cache, pack, glyph, 
+            (uint16_t)color, COLOR_BACKGROUND);
+        RETURN_IF_NULL(pixels);
+        memcpy(&text_pixels[width * height], pixels, 
+            glyph->width * height * sizeof(uint16_t));
+        for( size_t i = glyph->width * height; i < glyph->advance * height; i++ ) {
+            text_pixels[width * height + i] = COLOR_BACKGROUND;
+        }
+        width += glyph->advance;
+    }
+
+    // Window must be at least 2 pixels wide
+    if( width == 1 && max_width > 1 ) {
+        for( size_t i = 0; i < height; i++ ) {
+            text_pixels[height + i] = COLOR_BACKGROUND;
+        }
+        width++;
+    }
+    if( width < 2 ) {
+        return RES_OK;
+    }
+
+    RETURN_ERROR_IF( st7789_basic_draw_picture_16bits(x, y, 
+        (uint16_t)(x + width - 1), (uint16_t)(y + height - 1), text_pixels) != 0, 
         RES_ERR_GENERIC );
     return RES_OK;
 }
 
+uint32_t display_hw_frame_rate_hz( void ) {
+    return frame_rates_hz[ST7789_BASIC_DEFAULT_FRAME_RATE];
+}
+
 result_t display_hw_init( void ) {
+    config_t config;
+    config_get(&config);
+    st7789_interface_spi_set_clock(config.display.spi_clock_hz);
+
     if( st7789_basic_init() == 0 ) {
+        if( config.display.spi_probe ) {
+            uint32_t clock_hz = probe_spi_clock(config.display.spi_clock_hz,
+                config.display.spi_probe_max_hz);
+            RETURN_ERROR_IF( st7789_interface_spi_set_clock(clock_hz) != 0,
+                RES_ERR_GENERIC );
+            INFO("SPI clock set to %u Hz.", clock_hz);
+        }
+
         RETURN_ON_ERROR( display_hw_turn_on() );
         RETURN_ON_ERROR( display_hw_clear() );
         return RES_OK;
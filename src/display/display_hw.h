@@ -17,6 +17,7 @@ extern "C" {
  ************/
 
 #include "utils.h"
+#include "font.h"
 
 /**********************
  * MACROS AND DEFINES *
@@ -31,13 +32,17 @@ extern "C" {
 
 extern result_t display_hw_turn_on( void );
 extern result_t display_hw_turn_off( void );
+extern result_t display_hw_idle_on( void );
+extern result_t display_hw_idle_off( void );
 
 extern result_t display_hw_clear( void );
 extern result_t display_hw_clear_area( uint16_t x, uint16_t y, 
     uint16_t w, uint16_t h );
 
-extern result_t display_hw_write_string( uint16_t x, uint16_t y, 
-    char * str, uint16_t len, uint32_t color, uint16_t font );
+extern result_t display_hw_write_text( uint16_t x, uint16_t y, 
+    const char * text, size_t len, uint32_t color, const font_pack_t * pack );
+
+extern uint32_t display_hw_frame_rate_hz( void );
 
 extern result_t display_hw_init( void );
 
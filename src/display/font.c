@@ -0,0 +1,322 @@
+/**
+ *******************************************************************************
+ * @file    font.c
+ * @brief   Font source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <string.h>
+
+#include "utils.h"
+
+#include "font.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define HASH_MUL                0x9E3779B1u     // Same as in tools/fonts/bdf2pack.py
+#define LATIN1_LETTERS_FIRST    0xC0
+#define LATIN1_LETTERS_LAST     0xFF
+#define MAX_CODEPOINT           0x10FFFF
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+    uint32_t substitute;
+} fallback_range_t;
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+// Base letters of U+00C0..U+00FF, for packs without accented glyphs
+static const char latin1_letters[] =
+    "AAAAAAACEEEEIIIIDNOOOOOxOUUUUYPs"
+    "aaaaaaaceeeeiiiidnooooo/ouuuuypy";
+
+// Sorted by code point, only used when pack has no glyph
+static const fallback_range_t fallbacks[] = {
+    { 0x0009, 0x0009, ' ' },
+    { 0x00A0, 0x00A0, ' ' },
+    { 0x00A1, 0x00A1, '!' },
+    { 0x00A2, 0x00A2, 'c' },
+    { 0x00A3, 0x00A3, 'L' },
+    { 0x00A9, 0x00A9, 'c' },
+    { 0x00AB, 0x00AB, '<' },
+    { 0x00AD, 0x00AD, '-' },
+    { 0x00AE, 0x00AE, 'R' },
+    { 0x00B0, 0x00B0, 'o' },
+    { 0x00B1, 0x00B1, '+' },
+    { 0x00B2, 0x00B2, '2' },
+    { 0x00B3, 0x00B3, '3' },
+    { 0x00B7, 0x00B7, '.' },
+    { 0x00B9, 0x00B9, '1' },
+    { 0x00BB, 0x00BB, '>' },
+    { 0x00BF, 0x00BF, '?' },
+    { 0x0100, 0x0100, 'A' }, { 0x0101, 0x0101, 'a' },
+    { 0x0102, 0x0102, 'A' }, { 0x0103, 0x0103, 'a' },
+    { 0x0104, 0x0104, 'A' }, { 0x0105, 0x0105, 'a' },
+    { 0x0106, 0x0106, 'C' }, { 0x0107, 0x0107, 'c' },
+    { 0x010C, 0x010C, 'C' }, { 0x010D, 0x010D, 'c' },
+    { 0x010E, 0x010E, 'D' }, { 0x010F, 0x010F, 'd' },
+    { 0x0110, 0x0110, 'D' }, { 0x0111, 0x0111, 'd' },
+    { 0x0112, 0x0112, 'E' }, { 0x0113, 0x0113, 'e' },
+    { 0x0116, 0x0116, 'E' }, { 0x0117, 0x0117, 'e' },
+    { 0x0118, 0x0118, 'E' }, { 0x0119, 0x0119, 'e' },
+    { 0x011A, 0x011A, 'E' }, { 0x011B, 0x011B, 'e' },
+    { 0x011E, 0x011E, 'G' }, { 0x011F, 0x011F, 'g' },
+    { 0x012A, 0x012A, 'I' }, { 0x012B, 0x012B, 'i' },
+    { 0x0130, 0x0130, 'I' }, { 0x0131, 0x0131, 'i' },
+    { 0x0141, 0x0141, 'L' }, { 0x0142, 0x0142, 'l' },
+    { 0x0143, 0x0143, 'N' }, { 0x0144, 0x0144, 'n' },
+    { 0x0147, 0x0147, 'N' }, { 0x0148, 0x0148, 'n' },
+    { 0x0150, 0x0150, 'O' }, { 0x0151, 0x0151, 'o' },
+    { 0x0152, 0x0152, 'O' }, { 0x0153, 0x0153, 'o' },
+    { 0x0158, 0x0158, 'R' }, { 0x0159, 0x0159, 'r' },
+    { 0x015A, 0x015A, 'S' }, { 0x015B, 0x015B, 's' },
+    { 0x015E, 0x015E, 'S' }, { 0x015F, 0x015F, 's' },
+    { 0x0160, 0x0160, 'S' }, { 0x0161, 0x0161, 's' },
+    { 0x0164, 0x0164, 'T' }, { 0x0165, 0x0165, 't' },
+    { 0x016A, 0x016A, 'U' }, { 0x016B, 0x016B, 'u' },
+    { 0x016E, 0x016E, 'U' }, { 0x016F, 0x016F, 'u' },
+    { 0x0170, 0x0170, 'U' }, { 0x0171, 0x0171, 'u' },
+    { 0x0178, 0x0178, 'Y' },
+    { 0x0179, 0x0179, 'Z' }, { 0x017A, 0x017A, 'z' },
+    { 0x017B, 0x017B, 'Z' }, { 0x017C, 0x017C, 'z' },
+    { 0x017D, 0x017D, 'Z' }, { 0x017E, 0x017E, 'z' },
+    { 0x2000, 0x200A, ' ' },
+    { 0x2010, 0x2013, '-' },
+    { 0x2014, 0x2015, '-' },
+    { 0x2018, 0x201B, '\'' },
+    { 0x201C, 0x201F, '"' },
+    { 0x2022, 0x2023, '*' },
+    { 0x2026, 0x2026, '.' },
+    { 0x2027, 0x2027, '.' },
+    { 0x2032, 0x2032, '\'' },
+    { 0x2033, 0x2033, '"' },
+    { 0x2039, 0x2039, '<' },
+    { 0x203A, 0x203A, '>' },
+    { 0x2043, 0x2043, '-' },
+    { 0x2044, 0x2044, '/' },
+    { 0x20AC, 0x20AC, 'E' },
+    { 0x2190, 0x2190, '<' },
+    { 0x2192, 0x2192, '>' },
+    { 0x2212, 0x2212, '-' },
+    { 0x2215, 0x2215, '/' },
+    { 0x2217, 0x2217, '*' },
+    { 0x2264, 0x2264, '<' },
+    { 0x2265, 0x2265, '>' },
+    { 0x25CF, 0x25CF, 0x2022 },
+    { 0x2713, 0x2714, 'v' },
+};
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static inline uint32_t font_hash( uint32_t codepoint, uint32_t seed ) {
+    uint32_t h = (codepoint ^ seed) * HASH_MUL;
+    return h ^ (h >> 15);
+}
+
+static const font_glyph_t * lookup( const font_pack_t * pack, uint32_t codepoint ) {
+    if( pack->glyph_count == 0 || pack->bucket_count == 0 ) {
+        return NULL;
+    }
+
+    uint32_t bucket = font_hash(codepoint, 0) % pack->bucket_count;
+    uint32_t slot = font_hash(codepoint, pack->displacements[bucket]) % pack->glyph_count;
+    const font_glyph_t * glyph = &pack->glyphs[slot];
+
+    return glyph->codepoint == codepoint ? glyph : NULL;
+}
+
+static uint32_t fallback_for( uint32_t codepoint ) {
+    if( codepoint >= LATIN1_LETTERS_FIRST && codepoint <= LATIN1_LETTERS_LAST ) {
+        return (uint8_t)latin1_letters[codepoint - LATIN1_LETTERS_FIRST];
+    }
+
+    size_t lo = 0;
+    size_t hi = NELEMS(fallbacks);
+    while( lo < hi ) {
+        size_t mid = lo + (hi - lo) / 2;
+        if( codepoint < fallbacks[mid].first ) {
+            hi = mid;
+        } else if( codepoint > fallbacks[mid].last ) {
+            lo = mid + 1;
+        } else {
+            return fallbacks[mid].substitute;
+        }
+    }
+
+    return FONT_REPLACEMENT_CHAR;
+}
+
+static bool is_invisible( uint32_t codepoint ) {
+    return (codepoint < 0x20 && codepoint != '\t') || codepoint == 0x7F ||
+        (codepoint >= 0x200B && codepoint <= 0x200F) || codepoint == 0x2060 ||
+        (codepoint >= 0xFE00 && codepoint <= 0xFE0F) || codepoint == 0xFEFF;
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+uint32_t font_utf8_next( const char ** text, const char * end ) {
+    const uint8_t * p = (const uint8_t *)*text;
+    size_t available = (size_t)(end - *text);
+    uint8_t lead = p[0];
+
+    // Invalid byte is replaced alone, so the next one gets its chance
+    *text += 1;
+    if( lead < 0x80 ) {
+        return lead;
+    }
+
+    size_t extra;
+    uint32_t codepoint;
+    uint32_t min;
+    if( (lead & 0xE0) == 0xC0 ) {
+        extra = 1;
+        codepoint = lead & 0x1Fu;
+        min = 0x80;
+    } else if( (lead & 0xF0) == 0xE0 ) {
+        extra = 2;
+        codepoint = lead & 0x0Fu;
+        min = 0x800;
+    } else if( (lead & 0xF8) == 0xF0 ) {
+        extra = 3;
+        codepoint = lead & 0x07u;
+        min = 0x10000;
+    } else {
+        return FONT_REPLACEMENT_CHAR;
+    }
+
+    if( available <= extra ) {
+        return FONT_REPLACEMENT_CHAR;
+    }
+    for( size_t i = 1; i <= extra; i++ ) {
+        if( (p[i] & 0xC0) != 0x80 ) {
+            return FONT_REPLACEMENT_CHAR;
+        }
+        codepoint = (codepoint << 6) | (p[i] & 0x3Fu);
+    }
+
+    if( codepoint < min || codepoint > MAX_CODEPOINT ||
+            (codepoint >= 0xD800 && codepoint <= 0xDFFF) ) {
+        return FONT_REPLACEMENT_CHAR;
+    }
+
+    *text += extra;
+    return codepoint;
+}
+
+size_t font_utf8_incomplete_tail( const char * text, size_t len ) {
+    if( !text ) {
+        return 0;
+    }
+
+    for( size_t back = 1; back < FONT_UTF8_MAX_BYTES && back <= len; back++ ) {
+        uint8_t byte = (uint8_t)text[len - back];
+        if( (byte & 0xC0) == 0x80 ) {
+            continue;
+        }
+
+        size_t needed = (byte & 0xE0) == 0xC0 ? 2 :
+            (byte & 0xF0) == 0xE0 ? 3 :
+            (byte & 0xF8) == 0xF0 ? 4 : 0;
+        return needed > back ? back : 0;
+    }
+
+    return 0;
+}
+
+const font_glyph_t * font_find_glyph( const font_pack_t * pack, uint32_t codepoint ) {
+    if( !pack || is_invisible(codepoint) ) {
+        return NULL;
+    }
+
+    const font_glyph_t * glyph = lookup(pack, codepoint);
+    if( !glyph ) {
+        glyph = lookup(pack, fallback_for(codepoint));
+    }
+    if( !glyph ) {
+        glyph = lookup(pack, FONT_REPLACEMENT_CHAR);
+    }
+    if( !glyph ) {
+        glyph = lookup(pack, '?');
+    }
+
+    return glyph;
+}
+
+uint16_t font_text_width( const font_pack_t * pack, const char * text, size_t len ) {
+    uint16_t width = 0;
+    font_text_fit(pack, text, len, UINT16_MAX, &width);
+    return width;
+}
+
+size_t font_text_fit( const font_pack_t * pack, const char * text, size_t len,
+        uint16_t max_width, uint16_t * width OUTPUT ) {
+    uint32_t total = 0;
+    const char * p = text;
+    const char * end = text ? text + len : NULL;
+
+    while( p && p < end ) {
+        const char * next = p;
+        const font_glyph_t * glyph = font_find_glyph(pack, font_utf8_next(&next, end));
+        uint32_t advance = glyph ? glyph->advance : 0;
+        if( total + advance > max_width ) {
+            break;
+        }
+        total += advance;
+        p = next;
+    }
+
+    if( width ) {
+        *width = (uint16_t)total;
+    }
+    return p ? (size_t)(p - text) : 0;
+}
+
+const uint16_t * font_cache_get( font_cache_t * cache, const font_pack_t * pack,
+        const font_glyph_t * glyph, uint16_t color, uint16_t background ) {
+    if( !cache || !pack || !glyph ||
+            (size_t)glyph->width * pack->height > FONT_CACHE_MAX_PIXELS ) {
+        return NULL;
+    }
+
+    // Direct mapped, text is drawn in few colors so collisions are rare
+    uint32_t index = ((uint32_t)(glyph - pack->glyphs) * 31u + color + background * 7u) %
+        FONT_CACHE_ENTRIES;
+    font_cache_entry_t * entry = &cache->entries[index];
+    if( entry->glyph == glyph && entry->color == color &&
+            entry->background == background ) {
+        cache->hits++;
+        return entry->pixels;
+    }
+
+    cache->misses++;
+    size_t col_bytes = (size_t)(pack->height + 7) / 8;
+    const uint8_t * bitmap = &pack->bitmaps[glyph->offset];
+    for( size_t col = 0; col < glyph->width; col++ ) {
+        for( size_t row = 0; row < pack->height; row++ ) {
+            bool ink = (bitmap[col * col_bytes + row / 8] & (0x80u >> (row % 8))) != 0;
+            entry->pixels[col * pack->height + row] = ink ? color : background;
+        }
+    }
+    entry->glyph = glyph;
+    entry->color = color;
+    entry->background = background;
+
+    return entry->pixels;
+}
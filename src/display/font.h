@@ -0,0 +1,102 @@
+/**
+ *******************************************************************************
+ * @file    font.h
+ * @brief   Font header file.
+ *          UTF-8 text measured and rasterized with pre-built bitmap font packs
+ *          (see tools/fonts). Glyphs have proportional advance, are found with
+ *          perfect hash and missing ones fall back to similar ASCII glyph or
+ *          replacement box. Rasterized glyphs are kept in small cache, so
+ *          wider character set doesn't cost anything per frame.
+ *******************************************************************************
+ */
+
+#ifndef FONT_H
+#define FONT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define FONT_REPLACEMENT_CHAR   0xFFFD
+#define FONT_UTF8_MAX_BYTES     4
+
+#define FONT_MAX_HEIGHT         24
+#define FONT_CACHE_ENTRIES      64
+#define FONT_CACHE_MAX_PIXELS   (12 * FONT_MAX_HEIGHT)
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef struct {
+    uint32_t codepoint;
+    uint16_t offset;            // In pack bitmaps
+    uint8_t width;              // Stored (ink) columns
+    uint8_t advance;            // Pen move, including spacing
+} font_glyph_t;
+
+// Bitmaps are column by column, (height + 7) / 8 bytes each, MSB on top
+typedef struct {
+    uint8_t height;
+    uint16_t glyph_count;
+    uint16_t bucket_count;
+    const uint32_t * displacements;
+    const font_glyph_t * glyphs;
+    const uint8_t * bitmaps;
+} font_pack_t;
+
+typedef struct {
+    const font_glyph_t * glyph; // NULL if entry is empty
+    uint16_t color;
+    uint16_t background;
+    uint16_t pixels[FONT_CACHE_MAX_PIXELS];     // Column by column, RGB565
+} font_cache_entry_t;
+
+typedef struct {
+    font_cache_entry_t entries[FONT_CACHE_ENTRIES];
+    uint32_t hits;
+    uint32_t misses;
+} font_cache_t;
+
+/********************
+ * GLOBAL VARIABLES *
+ ********************/
+
+extern const font_pack_t font_pack_6x12;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern uint32_t font_utf8_next( const char ** text, const char * end );
+extern size_t font_utf8_incomplete_tail( const char * text, size_t len );
+
+extern const font_glyph_t * font_find_glyph( const font_pack_t * pack,
+    uint32_t codepoint );
+extern uint16_t font_text_width( const font_pack_t * pack, const char * text,
+    size_t len );
+extern size_t font_text_fit( const font_pack_t * pack, const char * text,
+    size_t len, uint16_t max_width, uint16_t * width OUTPUT );
+
+extern const uint16_t * font_cache_get( font_cache_t * cache,
+    const font_pack_t * pack, const font_glyph_t * glyph, uint16_t color,
+    uint16_t background );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_H */
@@ -0,0 +1,376 @@
+/**
+ *******************************************************************************
+ * @file    font_pack_6x12.c
+ * @brief   Font pack generated from pitalkster-6x12.bdf by tools/fonts/bdf2pack.py.
+ *          Don't edit by hand, run "make fonts" instead.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include "font.h"
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static const uint32_t displacements[47] = {
+    5, 14, 28, 2, 117, 5, 32, 488,
+    599, 85, 14, 3, 718, 825, 268, 64,
+    191, 62, 262, 388, 1, 259, 4, 125,
+    28, 181, 0, 1149, 284, 386, 493, 653,
+    762, 239, 403, 499, 1535, 801, 933, 1147,
+    899, 212, 300, 1129, 819, 807, 609,
+};
+
+// Ordered by perfect hash slot
+static const font_glyph_t glyphs[185] = {
+    { 0x003E,     0, 5, 6 },   // greater_than_sign
+    { 0x0022,    10, 4, 5 },   // quotation_mark
+    { 0x00DA,    18, 6, 7 },   // latin_capital_letter_u_with_acute
+    { 0x00DB,    30, 6, 7 },   // latin_capital_letter_u_with_circumflex
+    { 0x00E8,    42, 4, 5 },   // latin_small_letter_e_with_grave
+    { 0x00D3,    50, 5, 6 },   // latin_capital_letter_o_with_acute
+    { 0x0063,    60, 4, 5 },   // latin_small_letter_c
+    { 0x0052,    68, 6, 7 },   // latin_capital_letter_r
+    { 0x00E2,    80, 5, 6 },   // latin_small_letter_a_with_circumflex
+    { 0x00BB,    90, 5, 6 },   // right_pointing_double_angle_quotation_mark
+    { 0x00FB,   100, 6, 7 },   // latin_small_letter_u_with_circumflex
+    { 0x00CF,   112, 5, 6 },   // latin_capital_letter_i_with_diaeresis
+    { 0x005A,   122, 5, 6 },   // latin_capital_letter_z
+    { 0x00EB,   132, 4, 5 },   // latin_small_letter_e_with_diaeresis
+    { 0x00C1,   140, 6, 7 },   // latin_capital_letter_a_with_acute
+    { 0x00E5,   152, 5, 6 },   // latin_small_letter_a_with_ring_above
+    { 0x0072,   162, 5, 6 },   // latin_small_letter_r
+    { 0x006F,   172, 4, 5 },   // latin_small_letter_o
+    { 0x00DF,   180, 5, 6 },   // latin_small_letter_sharp_s
+    { 0x00CE,   190, 5, 6 },   // latin_capital_letter_i_with_circumflex
+    { 0x0036,   200, 5, 6 },   // digit_six
+    { 0x0024,   210, 5, 6 },   // dollar_sign
+    { 0x0035,   220, 5, 6 },   // digit_five
+    { 0x0061,   230, 5, 6 },   // latin_small_letter_a
+    { 0x00D9,   240, 6, 7 },   // latin_capital_letter_u_with_grave
+    { 0x0030,   252, 5, 6 },   // digit_zero
+    { 0x0028,   262, 3, 4 },   // left_parenthesis
+    { 0x00D2,   268, 5, 6 },   // latin_capital_letter_o_with_grave
+    { 0x005B,   278, 3, 4 },   // left_square_bracket
+    { 0x0068,   284, 6, 7 },   // latin_small_letter_h
+    { 0x003D,   296, 5, 6 },   // equals_sign
+    { 0xFFFD,   306, 6, 7 },   // replacement_character
+    { 0x0107,   318, 4, 5 },   // latin_small_letter_c_with_acute
+    { 0x2026,   326, 5, 6 },   // horizontal_ellipsis
+    { 0x002B,   336, 5, 6 },   // plus_sign
+    { 0x002E,   346, 1, 2 },   // full_stop
+    { 0x005C,   348, 4, 5 },   // reverse_solidus
+    { 0x002D,   356, 5, 6 },   // hyphen_minus
+    { 0x201A,   366, 2, 3 },   // single_low_9_quotation_mark
+    { 0x002C,   370, 2, 3 },   // comma
+    { 0x0179,   374, 5, 6 },   // latin_capital_letter_z_with_acute
+    { 0x00E0,   384, 5, 6 },   // latin_small_letter_a_with_grave
+    { 0x005E,   394, 3, 4 },   // circumflex_accent
+    { 0x0104,   400, 6, 7 },   // latin_capital_letter_a_with_ogonek
+    { 0x0038,   412, 5, 6 },   // digit_eight
+    { 0x0053,   422, 5, 6 },   // latin_capital_letter_s
+    { 0x0067,   432, 5, 6 },   // latin_small_letter_g
+    { 0x00C8,   442, 5, 6 },   // latin_capital_letter_e_with_grave
+    { 0x0071,   452, 5, 6 },   // latin_small_letter_q
+    { 0x00CA,   462, 5, 6 },   // latin_capital_letter_e_with_circumflex
+    { 0x006C,   472, 5, 6 },   // latin_small_letter_l
+    { 0x00EE,   482, 3, 4 },   // latin_small_letter_i_with_circumflex
+    { 0x0065,   488, 4, 5 },   // latin_small_letter_e
+    { 0x017C,   496, 4, 5 },   // latin_small_letter_z_with_dot_above
+    { 0x00F3,   504, 4, 5 },   // latin_small_letter_o_with_acute
+    { 0x00F9,   512, 6, 7 },   // latin_small_letter_u_with_grave
+    { 0x0075,   524, 6, 7 },   // latin_small_letter_u
+    { 0x004A,   536, 6, 7 },   // latin_capital_letter_j
+    { 0x003B,   548, 1, 2 },   // semicolon
+    { 0x015A,   550, 5, 6 },   // latin_capital_letter_s_with_acute
+    { 0x0031,   560, 3, 4 },   // digit_one
+    { 0x004E,   566, 6, 7 },   // latin_capital_letter_n
+    { 0x0049,   578, 5, 6 },   // latin_capital_letter_i
+    { 0x201C,   588, 4, 5 },   // left_double_quotation_mark
+    { 0x015B,   596, 4, 5 },   // latin_small_letter_s_with_acute
+    { 0x0045,   604, 5, 6 },   // latin_capital_letter_e
+    { 0x201E,   614, 4, 5 },   // double_low_9_quotation_mark
+    { 0x0029,   622, 3, 4 },   // right_parenthesis
+    { 0x00D1,   628, 6, 7 },   // latin_capital_letter_n_with_tilde
+    { 0x0034,   640, 5, 6 },   // digit_four
+    { 0x007C,   650, 1, 2 },   // vertical_line
+    { 0x005D,   652, 3, 4 },   // right_square_bracket
+    { 0x003A,   658, 1, 2 },   // colon
+    { 0x2190,   660, 6, 7 },   // leftwards_arrow
+    { 0x00D4,   672, 5, 6 },   // latin_capital_letter_o_with_circumflex
+    { 0x0026,   682, 6, 7 },   // ampersand
+    { 0x002F,   694, 5, 6 },   // solidus
+    { 0x0041,   704, 6, 7 },   // latin_capital_letter_a
+    { 0x00E9,   716, 4, 5 },   // latin_small_letter_e_with_acute
+    { 0x00D6,   724, 5, 6 },   // latin_capital_letter_o_with_diaeresis
+    { 0x005F,   734, 6, 7 },   // low_line
+    { 0x00FC,   746, 6, 7 },   // latin_small_letter_u_with_diaeresis
+    { 0x2192,   758, 6, 7 },   // rightwards_arrow
+    { 0x2019,   770, 2, 3 },   // right_single_quotation_mark
+    { 0x003F,   774, 5, 6 },   // question_mark
+    { 0x0048,   784, 6, 7 },   // latin_capital_letter_h
+    { 0x00A1,   796, 1, 2 },   // inverted_exclamation_mark
+    { 0x017A,   798, 4, 5 },   // latin_small_letter_z_with_acute
+    { 0x00B7,   806, 2, 3 },   // middle_dot
+    { 0x017B,   810, 5, 6 },   // latin_capital_letter_z_with_dot_above
+    { 0x0042,   820, 5, 6 },   // latin_capital_letter_b
+    { 0x00EF,   830, 3, 4 },   // latin_small_letter_i_with_diaeresis
+    { 0x2022,   836, 4, 5 },   // bullet
+    { 0x00FD,   844, 6, 7 },   // latin_small_letter_y_with_acute
+    { 0x00AB,   856, 5, 6 },   // left_pointing_double_angle_quotation_mark
+    { 0x00C9,   866, 5, 6 },   // latin_capital_letter_e_with_acute
+    { 0x0023,   876, 6, 7 },   // number_sign
+    { 0x006B,   888, 6, 7 },   // latin_small_letter_k
+    { 0x0020,   900, 0, 3 },   // space
+    { 0x002A,   900, 5, 6 },   // asterisk
+    { 0x0054,   910, 5, 6 },   // latin_capital_letter_t
+    { 0x0055,   920, 6, 7 },   // latin_capital_letter_u
+    { 0x00CB,   932, 5, 6 },   // latin_capital_letter_e_with_diaeresis
+    { 0x006D,   942, 5, 6 },   // latin_small_letter_m
+    { 0x006E,   952, 6, 7 },   // latin_small_letter_n
+    { 0x00C0,   964, 6, 7 },   // latin_capital_letter_a_with_grave
+    { 0x0032,   976, 5, 6 },   // digit_two
+    { 0x0058,   986, 5, 6 },   // latin_capital_letter_x
+    { 0x0076,   996, 6, 7 },   // latin_small_letter_v
+    { 0x0033,  1008, 5, 6 },   // digit_three
+    { 0x0143,  1018, 6, 7 },   // latin_capital_letter_n_with_acute
+    { 0x00F5,  1030, 5, 6 },   // latin_small_letter_o_with_tilde
+    { 0x0119,  1040, 4, 5 },   // latin_small_letter_e_with_ogonek
+    { 0x00C3,  1048, 6, 7 },   // latin_capital_letter_a_with_tilde
+    { 0x00D7,  1060, 5, 6 },   // multiplication_sign
+    { 0x00C2,  1070, 6, 7 },   // latin_capital_letter_a_with_circumflex
+    { 0x0066,  1082, 5, 6 },   // latin_small_letter_f
+    { 0x0027,  1092, 2, 3 },   // apostrophe
+    { 0x0056,  1096, 6, 7 },   // latin_capital_letter_v
+    { 0x004D,  1108, 5, 6 },   // latin_capital_letter_m
+    { 0x0050,  1118, 5, 6 },   // latin_capital_letter_p
+    { 0x0077,  1128, 5, 6 },   // latin_small_letter_w
+    { 0x00DC,  1138, 6, 7 },   // latin_capital_letter_u_with_diaeresis
+    { 0x0141,  1150, 6, 7 },   // latin_capital_letter_l_with_stroke
+    { 0x004F,  1162, 5, 6 },   // latin_capital_letter_o
+    { 0x00E7,  1172, 4, 5 },   // latin_small_letter_c_with_cedilla
+    { 0x0043,  1180, 5, 6 },   // latin_capital_letter_c
+    { 0x0039,  1190, 5, 6 },   // digit_nine
+    { 0x0105,  1200, 5, 6 },   // latin_small_letter_a_with_ogonek
+    { 0x0059,  1210, 5, 6 },   // latin_capital_letter_y
+    { 0x007A,  1220, 4, 5 },   // latin_small_letter_z
+    { 0x004C,  1228, 6, 7 },   // latin_capital_letter_l
+    { 0x0078,  1240, 5, 6 },   // latin_small_letter_x
+    { 0x0073,  1250, 4, 5 },   // latin_small_letter_s
+    { 0x0106,  1258, 5, 6 },   // latin_capital_letter_c_with_acute
+    { 0x007E,  1268, 6, 7 },   // tilde
+    { 0x2014,  1280, 6, 7 },   // em_dash
+    { 0x00BF,  1292, 5, 6 },   // inverted_question_mark
+    { 0x00F1,  1302, 6, 7 },   // latin_small_letter_n_with_tilde
+    { 0x00CC,  1314, 5, 6 },   // latin_capital_letter_i_with_grave
+    { 0x00ED,  1324, 3, 4 },   // latin_small_letter_i_with_acute
+    { 0x00F6,  1330, 4, 5 },   // latin_small_letter_o_with_diaeresis
+    { 0x00F4,  1338, 4, 5 },   // latin_small_letter_o_with_circumflex
+    { 0x0051,  1346, 5, 6 },   // latin_capital_letter_q
+    { 0x00E3,  1356, 5, 6 },   // latin_small_letter_a_with_tilde
+    { 0x0025,  1366, 6, 7 },   // percent_sign
+    { 0x00F2,  1378, 4, 5 },   // latin_small_letter_o_with_grave
+    { 0x006A,  1386, 4, 5 },   // latin_small_letter_j
+    { 0x0047,  1394, 6, 7 },   // latin_capital_letter_g
+    { 0x0060,  1406, 1, 2 },   // grave_accent
+    { 0x00EA,  1408, 4, 5 },   // latin_small_letter_e_with_circumflex
+    { 0x0062,  1416, 5, 6 },   // latin_small_letter_b
+    { 0x00D5,  1426, 5, 6 },   // latin_capital_letter_o_with_tilde
+    { 0x00E1,  1436, 5, 6 },   // latin_small_letter_a_with_acute
+    { 0x2018,  1446, 2, 3 },   // left_single_quotation_mark
+    { 0x20AC,  1450, 5, 6 },   // euro_sign
+    { 0x0040,  1460, 5, 6 },   // commercial_at
+    { 0x0144,  1470, 6, 7 },   // latin_small_letter_n_with_acute
+    { 0x0064,  1482, 5, 6 },   // latin_small_letter_d
+    { 0x0070,  1492, 5, 6 },   // latin_small_letter_p
+    { 0x00E4,  1502, 5, 6 },   // latin_small_letter_a_with_diaeresis
+    { 0x00CD,  1512, 5, 6 },   // latin_capital_letter_i_with_acute
+    { 0x0044,  1522, 5, 6 },   // latin_capital_letter_d
+    { 0x0046,  1532, 5, 6 },   // latin_capital_letter_f
+    { 0x0074,  1542, 4, 5 },   // latin_small_letter_t
+    { 0x003C,  1550, 5, 6 },   // less_than_sign
+    { 0x0079,  1560, 6, 7 },   // latin_small_letter_y
+    { 0x007D,  1572, 3, 4 },   // right_curly_bracket
+    { 0x004B,  1578, 6, 7 },   // latin_capital_letter_k
+    { 0x0057,  1590, 5, 6 },   // latin_capital_letter_w
+    { 0x007B,  1600, 3, 4 },   // left_curly_bracket
+    { 0x201D,  1606, 4, 5 },   // right_double_quotation_mark
+    { 0x0021,  1614, 1, 2 },   // exclamation_mark
+    { 0x0069,  1616, 3, 4 },   // latin_small_letter_i
+    { 0x00FA,  1622, 6, 7 },   // latin_small_letter_u_with_acute
+    { 0x2013,  1634, 4, 5 },   // en_dash
+    { 0x00C7,  1642, 5, 6 },   // latin_capital_letter_c_with_cedilla
+    { 0x0037,  1652, 5, 6 },   // digit_seven
+    { 0x00C4,  1662, 6, 7 },   // latin_capital_letter_a_with_diaeresis
+    { 0x0118,  1674, 5, 6 },   // latin_capital_letter_e_with_ogonek
+    { 0x0142,  1684, 5, 6 },   // latin_small_letter_l_with_stroke
+    { 0x00EC,  1694, 3, 4 },   // latin_small_letter_i_with_grave
+    { 0x00B0,  1700, 4, 5 },   // degree_sign
+    { 0x00DD,  1708, 5, 6 },   // latin_capital_letter_y_with_acute
+    { 0x00FF,  1718, 6, 7 },   // latin_small_letter_y_with_diaeresis
+};
+
+static const uint8_t bitmaps[1730] = {
+    0x40, 0x40, 0x20, 0x80, 0x11, 0x00, 0x0A, 0x00, 0x04, 0x00, 0x30, 0x00,
+    0x40, 0x00, 0x30, 0x00, 0x40, 0x00, 0x20, 0x00, 0x3F, 0x80, 0x00, 0x40,
+    0x40, 0x40, 0xBF, 0x80, 0x20, 0x00, 0x20, 0x00, 0x3F, 0x80, 0x40, 0x40,
+    0x80, 0x40, 0x7F, 0x80, 0x20, 0x00, 0x03, 0x80, 0x25, 0x40, 0x15, 0x40,
+    0x03, 0x40, 0x1F, 0x80, 0x20, 0x40, 0x60, 0x40, 0xA0, 0x40, 0x1F, 0x80,
+    0x03, 0x80, 0x04, 0x40, 0x04, 0x40, 0x06, 0x40, 0x20, 0x40, 0x3F, 0xC0,
+    0x24, 0x40, 0x26, 0x00, 0x19, 0xC0, 0x00, 0x40, 0x02, 0x80, 0x15, 0x40,
+    0x25, 0x40, 0x13, 0xC0, 0x00, 0x40, 0x08, 0x80, 0x05, 0x00, 0x0A, 0x80,
+    0x05, 0x00, 0x02, 0x00, 0x04, 0x00, 0x07, 0x80, 0x10, 0x40, 0x24, 0x40,
+    0x17, 0xC0, 0x00, 0x40, 0x20, 0x40, 0x60, 0x40, 0x3F, 0xC0, 0x60, 0x40,
+    0x20, 0x40, 0x30, 0x40, 0x21, 0xC0, 0x26, 0x40, 0x38, 0x40, 0x20, 0xC0,
+    0x03, 0x80, 0x15, 0x40, 0x05, 0x40, 0x13, 0x40, 0x00, 0x40, 0x07, 0xC0,
+    0x39, 0x00, 0x4F, 0x00, 0x81, 0xC0, 0x00, 0x40, 0x02, 0x80, 0x25, 0x40,
+    0x55, 0x40, 0x23, 0xC0, 0x00, 0x40, 0x04, 0x40, 0x07, 0xC0, 0x02, 0x40,
+    0x04, 0x00, 0x04, 0x00, 0x03, 0x80, 0x04, 0x40, 0x04, 0x40, 0x03, 0x80,
+    0x1F, 0xC0, 0x20, 0x00, 0x24, 0x40, 0x1A, 0x40, 0x01, 0x80, 0x20, 0x40,
+    0x60, 0x40, 0xBF, 0xC0, 0x60, 0x40, 0x20, 0x40, 0x1F, 0x80, 0x24, 0x40,
+    0x24, 0x40, 0x34, 0x40, 0x03, 0x80, 0x18, 0xC0, 0x24, 0x40, 0x7F, 0xE0,
+    0x22, 0x40, 0x31, 0x80, 0x3C, 0x80, 0x24, 0x40, 0x24, 0x40, 0x24, 0x40,
+    0x23, 0x80, 0x02, 0x80, 0x05, 0x40, 0x05, 0x40, 0x03, 0xC0, 0x00, 0x40,
+    0x20, 0x00, 0x3F, 0x80, 0x80, 0x40, 0x40, 0x40, 0x3F, 0x80, 0x20, 0x00,
+    0x1F, 0x80, 0x20, 0x40, 0x20, 0x40, 0x20, 0x40, 0x1F, 0x80, 0x1F, 0x80,
+    0x20, 0x40, 0x40, 0x20, 0x1F, 0x80, 0xA0, 0x40, 0x60, 0x40, 0x20, 0x40,
+    0x1F, 0x80, 0x7F, 0xE0, 0x40, 0x20, 0x40, 0x20, 0x20, 0x40, 0x3F, 0xC0,
+    0x04, 0x40, 0x04, 0x00, 0x03, 0xC0, 0x00, 0x40, 0x09, 0x00, 0x09, 0x00,
+    0x09, 0x00, 0x09, 0x00, 0x09, 0x00, 0x3F, 0xC0, 0x20, 0x40, 0x28, 0x40,
+    0x2A, 0xC0, 0x24, 0x40, 0x3F, 0xC0, 0x03, 0x80, 0x04, 0x40, 0x14, 0x40,
+    0x26, 0x40, 0x00, 0x40, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x40,
+    0x04, 0x00, 0x04, 0x00, 0x3F, 0x80, 0x04, 0x00, 0x04, 0x00, 0x00, 0x40,
+    0x70, 0x00, 0x0C, 0x00, 0x03, 0x80, 0x00, 0x40, 0x04, 0x00, 0x04, 0x00,
+    0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x10, 0x00, 0x60, 0x00, 0x10,
+    0x00, 0x60, 0x30, 0x40, 0x21, 0xC0, 0x66, 0x40, 0xB8, 0x40, 0x20, 0xC0,
+    0x02, 0x80, 0x25, 0x40, 0x15, 0x40, 0x03, 0xC0, 0x00, 0x40, 0x20, 0x00,
+    0x40, 0x00, 0x20, 0x00, 0x00, 0x40, 0x07, 0xC0, 0x39, 0x00, 0x0F, 0x00,
+    0x01, 0xE0, 0x00, 0x50, 0x1B, 0x80, 0x24, 0x40, 0x24, 0x40, 0x24, 0x40,
+    0x1B, 0x80, 0x18, 0xC0, 0x24, 0x40, 0x24, 0x40, 0x22, 0x40, 0x31, 0x80,
+    0x02, 0xE0, 0x05, 0x50, 0x05, 0x50, 0x06, 0x50, 0x04, 0x20, 0x20, 0x40,
+    0xBF, 0xC0, 0x64, 0x40, 0x2E, 0x40, 0x30, 0xC0, 0x03, 0x80, 0x04, 0x40,
+    0x04, 0x50, 0x07, 0xF0, 0x00, 0x10, 0x20, 0x40, 0x7F, 0xC0, 0xA4, 0x40,
+    0x6E, 0x40, 0x30, 0xC0, 0x20, 0x40, 0x20, 0x40, 0x3F, 0xC0, 0x00, 0x40,
+    0x00, 0x40, 0x14, 0x40, 0x27, 0xC0, 0x10, 0x40, 0x03, 0x80, 0x05, 0x40,
+    0x05, 0x40, 0x03, 0x40, 0x04, 0x40, 0x05, 0xC0, 0x16, 0x40, 0x04, 0x40,
+    0x03, 0x80, 0x04, 0x40, 0x14, 0x40, 0x23, 0x80, 0x04, 0x00, 0x07, 0x80,
+    0x20, 0x40, 0x14, 0x40, 0x07, 0xC0, 0x00, 0x40, 0x04, 0x00, 0x07, 0x80,
+    0x00, 0x40, 0x04, 0x40, 0x07, 0xC0, 0x00, 0x40, 0x00, 0x60, 0x20, 0x20,
+    0x20, 0x20, 0x3F, 0xC0, 0x20, 0x00, 0x20, 0x00, 0x04, 0x60, 0x18, 0xC0,
+    0x24, 0x40, 0x64, 0x40, 0xA2, 0x40, 0x31, 0x80, 0x10, 0x40, 0x3F, 0xC0,
+    0x00, 0x40, 0x20, 0x40, 0x3F, 0xC0, 0x0C, 0x40, 0x23, 0x00, 0x3F, 0xC0,
+    0x20, 0x00, 0x20, 0x40, 0x20, 0x40, 0x3F, 0xC0, 0x20, 0x40, 0x20, 0x40,
+    0x30, 0x00, 0x40, 0x00, 0x30, 0x00, 0x40, 0x00, 0x06, 0x40, 0x05, 0x40,
+    0x15, 0x40, 0x24, 0xC0, 0x20, 0x40, 0x3F, 0xC0, 0x24, 0x40, 0x2E, 0x40,
+    0x30, 0xC0, 0x00, 0x10, 0x00, 0x60, 0x00, 0x10, 0x00, 0x60, 0x40, 0x20,
+    0x20, 0x40, 0x1F, 0x80, 0x20, 0x40, 0x7F, 0xC0, 0x8C, 0x40, 0xA3, 0x00,
+    0x7F, 0xC0, 0xA0, 0x00, 0x02, 0x00, 0x0D, 0x00, 0x11, 0x00, 0x3F, 0xC0,
+    0x01, 0x40, 0xFF, 0xF0, 0x40, 0x20, 0x40, 0x20, 0x7F, 0xE0, 0x08, 0x40,
+    0x02, 0x00, 0x07, 0x00, 0x0A, 0x80, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00,
+    0x1F, 0x80, 0x60, 0x40, 0xA0, 0x40, 0x60, 0x40, 0x1F, 0x80, 0x03, 0x80,
+    0x1C, 0x40, 0x27, 0x40, 0x1C, 0x80, 0x07, 0x40, 0x00, 0x40, 0x00, 0x20,
+    0x01, 0xC0, 0x06, 0x00, 0x38, 0x00, 0x40, 0x00, 0x00, 0x40, 0x07, 0xC0,
+    0x39, 0x00, 0x0F, 0x00, 0x01, 0xC0, 0x00, 0x40, 0x03, 0x80, 0x05, 0x40,
+    0x15, 0x40, 0x23, 0x40, 0x1F, 0x80, 0x60, 0x40, 0x20, 0x40, 0x60, 0x40,
+    0x1F, 0x80, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10,
+    0x00, 0x10, 0x04, 0x00, 0x07, 0x80, 0x10, 0x40, 0x04, 0x40, 0x17, 0xC0,
+    0x00, 0x40, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x0A, 0x80, 0x07, 0x00,
+    0x02, 0x00, 0x10, 0x00, 0x60, 0x00, 0x18, 0x00, 0x20, 0x00, 0x23, 0x40,
+    0x24, 0x00, 0x18, 0x00, 0x20, 0x40, 0x3F, 0xC0, 0x04, 0x00, 0x04, 0x00,
+    0x3F, 0xC0, 0x20, 0x40, 0x2F, 0xC0, 0x04, 0x40, 0x05, 0xC0, 0x16, 0x40,
+    0x24, 0x40, 0x06, 0x00, 0x06, 0x00, 0x30, 0x40, 0x21, 0xC0, 0xA6, 0x40,
+    0x38, 0x40, 0x20, 0xC0, 0x20, 0x40, 0x3F, 0xC0, 0x24, 0x40, 0x24, 0x40,
+    0x1B, 0x80, 0x14, 0x40, 0x07, 0xC0, 0x10, 0x40, 0x06, 0x00, 0x0F, 0x00,
+    0x0F, 0x00, 0x06, 0x00, 0x04, 0x10, 0x07, 0x10, 0x04, 0xE0, 0x11, 0x80,
+    0x26, 0x00, 0x04, 0x00, 0x02, 0x00, 0x05, 0x00, 0x0A, 0x80, 0x05, 0x00,
+    0x08, 0x80, 0x20, 0x40, 0x3F, 0xC0, 0x64, 0x40, 0xAE, 0x40, 0x30, 0xC0,
+    0x09, 0x00, 0x0B, 0xC0, 0x3D, 0x00, 0x0B, 0xC0, 0x3D, 0x00, 0x09, 0x00,
+    0x20, 0x40, 0x3F, 0xC0, 0x01, 0x40, 0x07, 0x00, 0x04, 0xC0, 0x04, 0x40,
+    0x09, 0x00, 0x06, 0x00, 0x1F, 0x80, 0x06, 0x00, 0x09, 0x00, 0x30, 0x00,
+    0x20, 0x40, 0x3F, 0xC0, 0x20, 0x40, 0x30, 0x00, 0x20, 0x00, 0x3F, 0x80,
+    0x00, 0x40, 0x00, 0x40, 0x3F, 0x80, 0x20, 0x00, 0x20, 0x40, 0x7F, 0xC0,
+    0x24, 0x40, 0x6E, 0x40, 0x30, 0xC0, 0x07, 0xC0, 0x04, 0x00, 0x07, 0xC0,
+    0x04, 0x00, 0x03, 0xC0, 0x04, 0x40, 0x07, 0xC0, 0x04, 0x40, 0x04, 0x00,
+    0x03, 0xC0, 0x00, 0x40, 0x00, 0x40, 0x07, 0xC0, 0xB9, 0x00, 0x4F, 0x00,
+    0x01, 0xC0, 0x00, 0x40, 0x18, 0xC0, 0x21, 0x40, 0x22, 0x40, 0x24, 0x40,
+    0x18, 0x40, 0x20, 0x40, 0x39, 0xC0, 0x06, 0x00, 0x39, 0xC0, 0x20, 0x40,
+    0x04, 0x00, 0x07, 0x00, 0x04, 0xC0, 0x01, 0x80, 0x06, 0x00, 0x04, 0x00,
+    0x10, 0x80, 0x20, 0x40, 0x24, 0x40, 0x24, 0x40, 0x1B, 0x80, 0x20, 0x40,
+    0x3F, 0xC0, 0x0C, 0x40, 0x63, 0x00, 0xBF, 0xC0, 0x20, 0x00, 0x13, 0x80,
+    0x24, 0x40, 0x24, 0x40, 0x13, 0x80, 0x20, 0x00, 0x03, 0x80, 0x05, 0x40,
+    0x05, 0x60, 0x03, 0x50, 0x00, 0x40, 0x47, 0xC0, 0xB9, 0x00, 0x8F, 0x00,
+    0x41, 0xC0, 0x80, 0x40, 0x08, 0x80, 0x05, 0x00, 0x02, 0x00, 0x05, 0x00,
+    0x08, 0x80, 0x00, 0x40, 0x07, 0xC0, 0x79, 0x00, 0x8F, 0x00, 0x41, 0xC0,
+    0x00, 0x40, 0x04, 0x40, 0x1F, 0xC0, 0x24, 0x40, 0x24, 0x40, 0x20, 0x00,
+    0x10, 0x00, 0x60, 0x00, 0x20, 0x00, 0x3E, 0x00, 0x01, 0xC0, 0x07, 0x00,
+    0x38, 0x00, 0x20, 0x00, 0x3F, 0xC0, 0x3C, 0x00, 0x03, 0xC0, 0x3C, 0x00,
+    0x3F, 0xC0, 0x20, 0x40, 0x3F, 0xC0, 0x24, 0x40, 0x24, 0x00, 0x18, 0x00,
+    0x06, 0x00, 0x01, 0xC0, 0x07, 0x00, 0x01, 0xC0, 0x06, 0x00, 0x20, 0x00,
+    0x3F, 0x80, 0x40, 0x40, 0x00, 0x40, 0x7F, 0x80, 0x20, 0x00, 0x22, 0x40,
+    0x3F, 0xC0, 0x28, 0x40, 0x00, 0x40, 0x00, 0x40, 0x00, 0xC0, 0x1F, 0x80,
+    0x20, 0x40, 0x20, 0x40, 0x20, 0x40, 0x1F, 0x80, 0x03, 0x80, 0x04, 0x50,
+    0x04, 0x60, 0x06, 0x40, 0x1F, 0x80, 0x20, 0x40, 0x20, 0x40, 0x20, 0x40,
+    0x30, 0x80, 0x1C, 0x00, 0x22, 0xC0, 0x22, 0x40, 0x22, 0x40, 0x1F, 0x80,
+    0x02, 0x80, 0x05, 0x40, 0x05, 0x40, 0x03, 0xE0, 0x00, 0x50, 0x20, 0x00,
+    0x38, 0x40, 0x07, 0xC0, 0x38, 0x40, 0x20, 0x00, 0x04, 0x40, 0x05, 0xC0,
+    0x06, 0x40, 0x04, 0x40, 0x20, 0x40, 0x3F, 0xC0, 0x20, 0x40, 0x00, 0x40,
+    0x00, 0x40, 0x00, 0xC0, 0x04, 0x40, 0x06, 0xC0, 0x01, 0x00, 0x06, 0xC0,
+    0x04, 0x40, 0x06, 0x40, 0x05, 0x40, 0x05, 0x40, 0x04, 0xC0, 0x1F, 0x80,
+    0x20, 0x40, 0x60, 0x40, 0xA0, 0x40, 0x30, 0x80, 0x40, 0x00, 0x80, 0x00,
+    0x40, 0x00, 0x20, 0x00, 0x20, 0x00, 0x40, 0x00, 0x02, 0x00, 0x02, 0x00,
+    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x01, 0x80, 0x02, 0x40,
+    0x2C, 0x40, 0x00, 0x40, 0x01, 0x80, 0x04, 0x40, 0x17, 0xC0, 0x24, 0x40,
+    0x24, 0x00, 0x13, 0xC0, 0x20, 0x40, 0x20, 0x40, 0xA0, 0x40, 0x7F, 0xC0,
+    0x20, 0x40, 0x20, 0x40, 0x04, 0x40, 0x17, 0xC0, 0x20, 0x40, 0x03, 0x80,
+    0x14, 0x40, 0x04, 0x40, 0x13, 0x80, 0x03, 0x80, 0x14, 0x40, 0x24, 0x40,
+    0x13, 0x80, 0x1F, 0x80, 0x21, 0x40, 0x21, 0x40, 0x20, 0xE0, 0x1F, 0xA0,
+    0x12, 0x80, 0x25, 0x40, 0x25, 0x40, 0x13, 0xC0, 0x20, 0x40, 0x18, 0x00,
+    0x24, 0xC0, 0x1B, 0x00, 0x0D, 0x80, 0x32, 0x40, 0x01, 0x80, 0x03, 0x80,
+    0x24, 0x40, 0x14, 0x40, 0x03, 0x80, 0x00, 0x10, 0x00, 0x10, 0x04, 0x10,
+    0x27, 0xE0, 0x0F, 0x00, 0x10, 0x80, 0x20, 0x40, 0x22, 0x40, 0x33, 0x80,
+    0x02, 0x00, 0x40, 0x00, 0x03, 0x80, 0x15, 0x40, 0x25, 0x40, 0x13, 0x40,
+    0x20, 0x00, 0x3F, 0xC0, 0x04, 0x40, 0x04, 0x40, 0x03, 0x80, 0x5F, 0x80,
+    0xA0, 0x40, 0xA0, 0x40, 0x60, 0x40, 0x9F, 0x80, 0x02, 0x80, 0x05, 0x40,
+    0x15, 0x40, 0x23, 0xC0, 0x00, 0x40, 0x30, 0x00, 0x40, 0x00, 0x0A, 0x00,
+    0x1F, 0x80, 0x2A, 0x40, 0x2A, 0x40, 0x20, 0x40, 0x1F, 0x80, 0x20, 0x40,
+    0x27, 0x40, 0x29, 0x40, 0x1F, 0x40, 0x04, 0x40, 0x07, 0xC0, 0x04, 0x40,
+    0x14, 0x00, 0x23, 0xC0, 0x00, 0x40, 0x03, 0x80, 0x04, 0x40, 0x24, 0x40,
+    0x3F, 0xC0, 0x00, 0x40, 0x04, 0x10, 0x07, 0xF0, 0x04, 0x50, 0x04, 0x40,
+    0x03, 0x80, 0x02, 0x80, 0x15, 0x40, 0x05, 0x40, 0x13, 0xC0, 0x00, 0x40,
+    0x20, 0x40, 0x20, 0x40, 0x7F, 0xC0, 0xA0, 0x40, 0x20, 0x40, 0x20, 0x40,
+    0x3F, 0xC0, 0x20, 0x40, 0x20, 0x40, 0x1F, 0x80, 0x20, 0x40, 0x3F, 0xC0,
+    0x24, 0x40, 0x2E, 0x00, 0x30, 0x00, 0x04, 0x00, 0x1F, 0x80, 0x04, 0x40,
+    0x00, 0x40, 0x04, 0x00, 0x0A, 0x00, 0x11, 0x00, 0x20, 0x80, 0x40, 0x40,
+    0x04, 0x10, 0x07, 0x10, 0x04, 0xE0, 0x01, 0x80, 0x06, 0x00, 0x04, 0x00,
+    0x40, 0x20, 0x7B, 0xE0, 0x04, 0x00, 0x20, 0x40, 0x3F, 0xC0, 0x24, 0x40,
+    0x0B, 0x00, 0x30, 0xC0, 0x20, 0x40, 0x38, 0x00, 0x07, 0xC0, 0x3C, 0x00,
+    0x07, 0xC0, 0x38, 0x00, 0x04, 0x00, 0x7B, 0xE0, 0x40, 0x20, 0x10, 0x00,
+    0x60, 0x00, 0x10, 0x00, 0x60, 0x00, 0x3F, 0x40, 0x04, 0x40, 0x27, 0xC0,
+    0x00, 0x40, 0x04, 0x00, 0x07, 0x80, 0x00, 0x40, 0x14, 0x40, 0x27, 0xC0,
+    0x00, 0x40, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x1F, 0x80,
+    0x20, 0x50, 0x20, 0x60, 0x20, 0x40, 0x30, 0x80, 0x30, 0x00, 0x20, 0x00,
+    0x27, 0xC0, 0x38, 0x00, 0x20, 0x00, 0x00, 0x40, 0x07, 0xC0, 0x79, 0x00,
+    0x0F, 0x00, 0x41, 0xC0, 0x00, 0x40, 0x20, 0x40, 0x3F, 0xC0, 0x24, 0x40,
+    0x2E, 0x60, 0x30, 0xD0, 0x20, 0x40, 0x22, 0x40, 0x3F, 0xC0, 0x08, 0x40,
+    0x00, 0x40, 0x24, 0x40, 0x17, 0xC0, 0x00, 0x40, 0x30, 0x00, 0x48, 0x00,
+    0x48, 0x00, 0x30, 0x00, 0x20, 0x00, 0x38, 0x40, 0x47, 0xC0, 0xB8, 0x40,
+    0x20, 0x00, 0x04, 0x10, 0x07, 0x10, 0x14, 0xE0, 0x01, 0x80, 0x16, 0x00,
+    0x04, 0x00,
+};
+
+/********************
+ * GLOBAL VARIABLES *
+ ********************/
+
+const font_pack_t font_pack_6x12 = {
+    .height = 12,
+    .glyph_count = 185,
+    .bucket_count = 47,
+    .displacements = displacements,
+    .glyphs = glyphs,
+    .bitmaps = bitmaps
+};
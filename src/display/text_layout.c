@@ -0,0 +1,300 @@
+/**
+ *******************************************************************************
+ * @file    text_layout.c
+ * @brief   Text layout source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <string.h>
+
+#include "utils.h"
+
+#include "text_layout.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define MIN_TEXT_CAPACITY   256
+#define MIN_LINES_CAPACITY  32
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct {
+    size_t start;
+    size_t pos;
+    uint32_t row;
+    uint16_t x;                 // Of line start
+    uint16_t pen;               // Current position
+    uint32_t color;
+} wrap_state_t;
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+// Returns buffer with room for needed elements, NULL if it can't grow
+static void * reserve( void * buf, size_t * capacity, size_t needed,
+        size_t elem_size, size_t min_capacity ) {
+    if( needed <= *capacity ) {
+        return buf;
+    }
+
+    size_t new_capacity = *capacity > 0 ? *capacity : min_capacity;
+    while( new_capacity < needed ) {
+        new_capacity *= 2;
+    }
+
+    void * new_buf = realloc(buf, new_capacity * elem_size);
+    if( new_buf ) {
+        *capacity = new_capacity;
+    }
+    return new_buf;
+}
+
+static result_t push_line( text_layout_t * layout, const wrap_state_t * s,
+        bool keep_empty ) {
+    if( s->pos == s->start && !keep_empty ) {
+        return RES_OK;
+    }
+
+    text_line_t * lines = reserve(layout->lines, &layout->line_capacity,
+        layout->line_count + 1, sizeof(text_line_t), MIN_LINES_CAPACITY);
+    RETURN_IF_NULL(lines);
+    layout->lines = lines;
+
+    layout->lines[layout->line_count++] = (text_line_t){
+        .offset = (uint32_t)s->start,
+        .length = (uint32_t)(s->pos - s->start),
+        .row = s->row,
+        .x = s->x,
+        .width = (uint16_t)(s->pen - s->x),
+        .color = s->color
+    };
+
+    return RES_OK;
+}
+
+// Line ends before s->pos, next one starts at row beginning after skipped bytes
+static result_t break_row( text_layout_t * layout, wrap_state_t * s, size_t skip ) {
+    RETURN_ON_ERROR( push_line(layout, s, false) );
+    s->pos += skip;
+    s->start = s->pos;
+    s->row++;
+    s->x = 0;
+    s->pen = 0;
+    return RES_OK;
+}
+
+static result_t wrap( text_layout_t * layout, wrap_state_t * s, size_t end ) {
+    const char * text = layout->text;
+    uint16_t space_width = font_text_width(layout->pack, " ", 1);
+
+    while( s->pos < end ) {
+        if( text[s->pos] == '\n' ) {
+            RETURN_ON_ERROR( break_row(layout, s, 1) );
+            continue;
+        }
+
+        // Space that doesn't fit is dropped, as the row breaks there anyway
+        if( text[s->pos] == ' ' ) {
+            if( s->pen + space_width > layout->width ) {
+                RETURN_ON_ERROR( break_row(layout, s, 1) );
+            } else {
+                s->pen = (uint16_t)(s->pen + space_width);
+                s->pos++;
+            }
+            continue;
+        }
+
+        size_t word_end = s->pos;
+        while( word_end < end && text[word_end] != ' ' && text[word_end] != '\n' ) {
+            word_end++;
+        }
+
+        uint16_t word_width = font_text_width(layout->pack, &text[s->pos], word_end - s->pos);
+        if( s->pen + word_width <= layout->width ) {
+            s->pen = (uint16_t)(s->pen + word_width);
+            s->pos = word_end;
+            continue;
+        }
+
+        if( s->pen > 0 ) {
+            RETURN_ON_ERROR( break_row(layout, s, 0) );
+            continue;
+        }
+
+        // Word longer than the row is split where it stops fitting, at least
+        // one character goes to each row
+        uint16_t fit_width = 0;
+        size_t fit = font_text_fit(layout->pack, &text[s->pos], word_end - s->pos,
+            layout->width, &fit_width);
+        if( fit == 0 ) {
+            const char * next = &text[s->pos];
+            font_utf8_next(&next, &text[word_end]);
+            fit = (size_t)(next - &text[s->pos]);
+            fit_width = layout->width;
+        }
+        s->pos += fit;
+        s->pen = fit_width;
+        RETURN_ON_ERROR( break_row(layout, s, 0) );
+    }
+
+    // Open line is kept even if empty, it holds position for the next text
+    return push_line(layout, s, true);
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t text_layout_init( text_layout_t * layout, const font_pack_t * pack,
+        uint16_t width ) {
+    RETURN_IF_NULL(layout);
+    RETURN_IF_NULL(pack);
+    RETURN_ERROR_IF( width == 0, RES_ERR_WRONG_ARGS );
+
+    memset(layout, 0, sizeof(text_layout_t));
+    layout->pack = pack;
+    layout->width = width;
+
+    return RES_OK;
+}
+
+void text_layout_free( text_layout_t * layout ) {
+    if( !layout ) {
+        return;
+    }
+
+    free(layout->text);
+    free(layout->lines);
+    const font_pack_t * pack = layout->pack;
+    uint16_t width = layout->width;
+    memset(layout, 0, sizeof(text_layout_t));
+    layout->pack = pack;
+    layout->width = width;
+}
+
+void text_layout_clear( text_layout_t * layout ) {
+    if( !layout ) {
+        return;
+    }
+
+    layout->text_len = 0;
+    layout->laid_out_len = 0;
+    layout->line_count = 0;
+}
+
+result_t text_layout_append( text_layout_t * layout, const char * text,
+        size_t len, uint32_t color, size_t * first_changed OUTPUT ) {
+    RETURN_IF_NULL(layout);
+    RETURN_IF_NULL(layout->pack);
+    RETURN_IF_NULL(text);
+    RETURN_ERROR_IF( layout->text_len + len > UINT32_MAX, RES_ERR_INVALID_SIZE );
+
+    char * buf = reserve(layout->text, &layout->text_capacity,
+        layout->text_len + len + 1, sizeof(char), MIN_TEXT_CAPACITY);
+    RETURN_IF_NULL(buf);
+    layout->text = buf;
+
+    memcpy(&layout->text[layout->text_len], text, len);
+    layout->text_len += len;
+    layout->text[layout->text_len] = '\0';
+
+    // Only the open line is wrapped again, earlier ones can't change.
+    // Text in other color starts next to it, the open line is then closed.
+    wrap_state_t s = { .color = color };
+    if( layout->line_count > 0 ) {
+        const text_line_t * open = &layout->lines[layout->line_count - 1];
+        if( open->color == color || open->length == 0 ) {
+            s.start = open->offset;
+            s.x = open->x;
+            s.pen = open->x;
+            s.row = open->row;
+            layout->line_count--;
+        } else {
+            s.start = layout->laid_out_len;
+            s.x = (uint16_t)(open->x + open->width);
+            s.pen = s.x;
+            s.row = open->row;
+        }
+    } else {
+        s.start = layout->laid_out_len;
+    }
+    s.pos = s.start;
+
+    if( first_changed ) {
+        *first_changed = layout->line_count;
+    }
+
+    size_t end = layout->text_len - font_utf8_incomplete_tail(layout->text,
+        layout->text_len);
+    if( end < s.start ) {
+        end = s.start;
+    }
+
+    RETURN_ON_ERROR( wrap(layout, &s, end) );
+    layout->laid_out_len = end;
+
+    return RES_OK;
+}
+
+result_t text_layout_truncate_row( text_layout_t * layout, uint32_t row ) {
+    RETURN_IF_NULL(layout);
+
+    size_t idx = text_layout_row_line(layout, row);
+    if( idx >= layout->line_count ) {
+        return RES_OK;
+    }
+
+    wrap_state_t s = {
+        .start = layout->lines[idx].offset,
+        .pos = layout->lines[idx].offset,
+        .row = row,
+        .color = layout->lines[idx].color
+    };
+    layout->line_count = idx;
+    layout->text_len = s.start;
+    layout->laid_out_len = s.start;
+    if( layout->text ) {
+        layout->text[s.start] = '\0';
+    }
+
+    return push_line(layout, &s, true);
+}
+
+uint32_t text_layout_rows( const text_layout_t * layout ) {
+    if( !layout || layout->line_count == 0 ) {
+        return 0;
+    }
+
+    // Empty open line at row start isn't counted, e.g. after final "\n"
+    const text_line_t * open = &layout->lines[layout->line_count - 1];
+    return (open->length == 0 && open->x == 0) ? open->row : open->row + 1;
+}
+
+size_t text_layout_row_line( const text_layout_t * layout, uint32_t row ) {
+    if( !layout ) {
+        return 0;
+    }
+
+    // First line with row not lower than given one
+    size_t lo = 0;
+    size_t hi = layout->line_count;
+    while( lo < hi ) {
+        size_t mid = lo + (hi - lo) / 2;
+        if( layout->lines[mid].row < row ) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
@@ -0,0 +1,78 @@
+/**
+ *******************************************************************************
+ * @file    text_layout.h
+ * @brief   Text layout header file.
+ *          Text buffer wrapped once into array of line descriptors, which
+ *          renderer and pager use without measuring text again. Appended
+ *          text only re-wraps the last (open) line, so tokens can arrive
+ *          one by one, also with UTF-8 character split between them.
+ *******************************************************************************
+ */
+
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils.h"
+#include "font.h"
+
+/************
+ * TYPEDEFS *
+ ************/
+
+// Part of one row in one color, row starts with line where x is 0.
+// Rows without any text (e.g. "\n\n") have no line.
+typedef struct {
+    uint32_t offset;            // In layout text
+    uint32_t length;            // Bytes, without wrapping space or "\n"
+    uint32_t row;
+    uint16_t x;                 // Pixels
+    uint16_t width;             // Pixels
+    uint32_t color;
+} text_line_t;
+
+typedef struct {
+    const font_pack_t * pack;
+    uint16_t width;             // Of row, in pixels
+
+    char * text;
+    size_t text_len;
+    size_t text_capacity;
+    size_t laid_out_len;        // Incomplete UTF-8 tail waits behind
+
+    text_line_t * lines;        // Last one is open, the next text goes there
+    size_t line_count;
+    size_t line_capacity;
+} text_layout_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t text_layout_init( text_layout_t * layout, const font_pack_t * pack,
+    uint16_t width );
+extern void text_layout_free( text_layout_t * layout );
+extern void text_layout_clear( text_layout_t * layout );
+
+extern result_t text_layout_append( text_layout_t * layout, const char * text,
+    size_t len, uint32_t color, size_t * first_changed OUTPUT );
+extern result_t text_layout_truncate_row( text_layout_t * layout, uint32_t row );
+
+extern uint32_t text_layout_rows( const text_layout_t * layout );
+extern size_t text_layout_row_line( const text_layout_t * layout, uint32_t row );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEXT_LAYOUT_H */
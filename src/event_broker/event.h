@@ -26,6 +26,8 @@ extern "C" {
 
 #define EVENT_MAX_DATA_SIZE 512
 
+#define COMPONENT_BIT(c)    (1U << (unsigned)(c))
+
 /*******************************
  * TYPEDEFS AND STATIC INLINES *
  *******************************/
@@ -35,9 +37,13 @@ typedef enum {
     COMPONENT_CONTROLS,
     COMPONENT_AUDIO_INPUT,
     COMPONENT_STT,
-    COMPONENT_LLM
+    COMPONENT_LLM,
+
+    COMPONENT_COUNT
 } sys_component_t;
 
+STATIC_ASSERT(COMPONENT_COUNT <= 32, "Component bitmask must fit in uint32_t");
+
 static inline const char * sys_component_enum_to_string( sys_component_t sys_component ) {
     switch( sys_component ) {
         case COMPONENT_CORE_DISP:   return "CORE_DISPLAY";
@@ -52,6 +58,7 @@ static inline const char * sys_component_enum_to_string( sys_component_t sys_com
 
 typedef enum {
     EVENT_BUT_PRESSED,
+    EVENT_BUT_GESTURE,
 
     EVENT_REC_REQUEST,
     EVENT_REC_STOP,
@@ -60,17 +67,25 @@ typedef enum {
     EVENT_STT_REQUEST,
     EVENT_STT_STOP,
     EVENT_STT_STATUS,
+    EVENT_STT_PARTIAL,
 
     EVENT_LLM_REQUEST,
     EVENT_LLM_STOP,
     EVENT_LLM_STATUS,
+    EVENT_LLM_THINKING,
+    EVENT_LLM_PREFILL,
+    EVENT_LLM_SESSION_RESET,
+    EVENT_LLM_SKIP_THINK,
+
+    EVENT_PIPELINE_DONE,
 
-    EVENT_PIPELINE_DONE
+    EVENT_TYPE_COUNT
 } event_type_t;
 
 static inline const char* event_type_enum_to_string( event_type_t type ) {
     switch( type ) {
         case EVENT_BUT_PRESSED:     return "BUT_PRESSED";
+        case EVENT_BUT_GESTURE:     return "BUT_GESTURE";
 
         case EVENT_REC_REQUEST:     return "REC_REQUEST";
         case EVENT_REC_STOP:      return "REC_STOP";
@@ -79,10 +94,15 @@ static inline const char* event_type_enum_to_string( event_type_t type ) {
         case EVENT_STT_REQUEST:     return "STT_REQUEST";
         case EVENT_STT_STOP:      return "STT_STOP";
         case EVENT_STT_STATUS:       return "STT_STATUS";
+        case EVENT_STT_PARTIAL:     return "STT_PARTIAL";
 
         case EVENT_LLM_REQUEST:     return "LLM_REQUEST";
         case EVENT_LLM_STOP:      return "LLM_STOP";
         case EVENT_LLM_STATUS:       return "LLM_STATUS";
+        case EVENT_LLM_THINKING:    return "LLM_THINKING";
+        case EVENT_LLM_PREFILL:     return "LLM_PREFILL";
+        case EVENT_LLM_SESSION_RESET: return "LLM_SESSION_RESET";
+        case EVENT_LLM_SKIP_THINK:  return "LLM_SKIP_THINK";
 
         case EVENT_PIPELINE_DONE:   return "PIPELINE_DONE";
         
@@ -9,6 +9,8 @@
  * INCLUDES *
  ************/
 
+#include <stdatomic.h>
+
 #include "utils.h"
 
 #include "event.h"
@@ -21,11 +23,57 @@
 
 static event_queue_t g_queue;
 
+// Per event type bitmask of components subscribed to it (besides its dest)
+static _Atomic uint32_t g_subscribers[EVENT_TYPE_COUNT];
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static uint32_t event_consumers( const event_t * e ) {
+    uint32_t consumers = COMPONENT_BIT(e->dest);
+    if( (unsigned)e->type < EVENT_TYPE_COUNT ) {
+        consumers |= atomic_load(&g_subscribers[e->type]);
+    }
+    return consumers;
+}
+
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
 
+result_t broker_subscribe( sys_component_t c, event_type_t type ) {
+    RETURN_ERROR_IF( (unsigned)c >= COMPONENT_COUNT, RES_ERR_WRONG_ARGS );
+    RETURN_ERROR_IF( (unsigned)type >= EVENT_TYPE_COUNT, RES_ERR_WRONG_ARGS );
+
+    atomic_fetch_or(&g_subscribers[type], COMPONENT_BIT(c));
+
+    INFO("[+] [%s] SUBSCRIBED TO \'%s\'", 
+        sys_component_enum_to_string(c),
+        event_type_enum_to_string(type));
+
+    return RES_OK;
+}
+
+result_t broker_unsubscribe( sys_component_t c, event_type_t type ) {
+    RETURN_ERROR_IF( (unsigned)c >= COMPONENT_COUNT, RES_ERR_WRONG_ARGS );
+    RETURN_ERROR_IF( (unsigned)type >= EVENT_TYPE_COUNT, RES_ERR_WRONG_ARGS );
+
+    atomic_fetch_and(&g_subscribers[type], ~COMPONENT_BIT(c));
+
+    INFO("[-] [%s] UNSUBSCRIBED FROM \'%s\'", 
+        sys_component_enum_to_string(c),
+        event_type_enum_to_string(type));
+
+    return RES_OK;
+}
+
 result_t broker_publish( event_t * e ) {
+    return broker_publish_timeout(e, 0);
+}
+
+// Waits for a free slot when queue is full, instead of failing right away
+result_t broker_publish_timeout( event_t * e, uint32_t timeout_ms ) {
     RETURN_IF_NULL(e);
     
     INFO(CYAN"[⇧] PUBLISH EVENT \'%s\' FROM [%s] TO [%s]. DATA SIZE: %zu"RST, 
@@ -34,7 +82,8 @@ result_t broker_publish( event_t * e ) {
         sys_component_enum_to_string(e->dest),
         e->data_size);
 
-    result_t res = event_queue_push(&g_queue, e);
+    result_t res = event_queue_push_fanout_timeout(&g_queue, e, 
+        event_consumers(e), timeout_ms);
     if( res != RES_OK ) {
         ERROR("Failed to push event into queue. Error code: %d", res);
     }
@@ -42,10 +91,36 @@ result_t broker_publish( event_t * e ) {
     return res;
 }
 
+result_t broker_publish_coalesced( event_t * e ) {
+    RETURN_IF_NULL(e);
+    
+    INFO(CYAN"[⇧] PUBLISH COALESCED EVENT \'%s\' FROM [%s] TO [%s]. DATA SIZE: %zu"RST, 
+        event_type_enum_to_string(e->type),
+        sys_component_enum_to_string(e->src),
+        sys_component_enum_to_string(e->dest),
+        e->data_size);
+
+    result_t res = event_queue_push_fanout_coalesced(&g_queue, e, 
+        event_consumers(e));
+    if( res != RES_OK ) {
+        ERROR("Failed to push coalesced event into queue. Error code: %d", res);
+    }
+
+    return res;
+}
+
 result_t broker_pop( sys_component_t c, event_t * e OUTPUT ) {
+    return broker_pop_timeout(c, e, 0);
+}
+
+// Worker loops park here, so an idle system has no threads polling
+result_t broker_pop_timeout( sys_component_t c, event_t * e OUTPUT, 
+        uint32_t timeout_ms ) {
     RETURN_IF_NULL(e);
 
-    result_t res = event_queue_pop(&g_queue, c, e);
+    STATIC_ASSERT(BROKER_WAIT_FOREVER == EVENT_QUEUE_WAIT_FOREVER,
+        "Broker and queue must agree on infinite wait");
+    result_t res = event_queue_pop_timeout(&g_queue, c, e, timeout_ms);
     if( res != RES_OK ) {
         // There is no event for selected component
         return res;
@@ -60,6 +135,14 @@ result_t broker_pop( sys_component_t c, event_t * e OUTPUT ) {
     return res;
 }
 
+uint32_t broker_dropped( sys_component_t c ) {
+    return event_queue_dropped(&g_queue, c);
+}
+
 result_t broker_init( void ) {
+    for( size_t i = 0; i < NELEMS(g_subscribers); i++ ) {
+        atomic_store(&g_subscribers[i], 0);
+    }
+
     return event_queue_init(&g_queue);
 }
@@ -20,13 +20,35 @@ extern "C" {
 
 #include "event.h"
 
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define BROKER_WAIT_FOREVER UINT32_MAX
+#define BROKER_POLL_PERIOD_MS 30
+
+// Only worker with a running operation needs polling, idle one sleeps 
+// until the next event
+static inline uint32_t broker_worker_wait_ms( bool busy ) {
+    return busy ? BROKER_POLL_PERIOD_MS : BROKER_WAIT_FOREVER;
+}
+
 /******************************
  * GLOBAL FUNCTION PROTOTYPES *
  ******************************/
 
 extern result_t broker_init( void);
+extern result_t broker_subscribe( sys_component_t c, event_type_t type );
+extern result_t broker_unsubscribe( sys_component_t c, event_type_t type );
 extern result_t broker_publish( event_t * e );
+extern result_t broker_publish_coalesced( event_t * e );
+extern result_t broker_publish_timeout( event_t * e, uint32_t timeout_ms );
 extern result_t broker_pop( sys_component_t c, event_t * e OUTPUT );
+extern result_t broker_pop_timeout( sys_component_t c, event_t * e OUTPUT, 
+    uint32_t timeout_ms );
+
+// Events a subscriber lost because it didn't keep up, dest never loses any
+extern uint32_t broker_dropped( sys_component_t c );
 
 #ifdef __cplusplus
 }
@@ -9,11 +9,127 @@
  * INCLUDES *
  ************/
 
+#include <errno.h>
+#include <string.h>
+
 #include "utils.h"
 
 #include "event.h"
 #include "event_queue.h"
 
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static bool is_same_coalescing_key( const event_t * a, const event_t * b ) {
+    return a->src == b->src && a->dest == b->dest && a->type == b->type;
+}
+
+// Must be called with the queue mutex held
+static void remove_slot( event_queue_t * q, int idx ) {
+    int move_idx = idx;
+    while( move_idx != q->tail ) {
+        int nxt = (move_idx + 1) % EVENT_QUEUE_SIZE;
+        if( nxt == q->tail ) break;
+        q->slots[move_idx] = q->slots[nxt];
+        move_idx = nxt;
+    }
+    q->tail = (q->tail + EVENT_QUEUE_SIZE - 1) % EVENT_QUEUE_SIZE;
+}
+
+// Delivery is guaranteed only to event dest, subscribers get a copy while
+// there is room. Oldest slot that waits only for subscribers is given up, so 
+// a subscriber that doesn't drain can't block producers.
+// Must be called with the queue mutex held
+static bool drop_lagging_slot( event_queue_t * q ) {
+    int idx = q->head;
+    while( idx != q->tail ) {
+        event_queue_slot_t * slot = &q->slots[idx];
+        if( (slot->pending & COMPONENT_BIT(slot->event.dest)) == 0 ) {
+            for( unsigned c = 0; c < COMPONENT_COUNT; c++ ) {
+                if( slot->pending & COMPONENT_BIT(c) ) {
+                    q->dropped[c]++;
+                }
+            }
+            remove_slot(q, idx);
+            return true;
+        }
+        idx = (idx + 1) % EVENT_QUEUE_SIZE;
+    }
+
+    return false;
+}
+
+// Must be called with the queue mutex held
+static result_t push_slot( event_queue_t * q, event_t * e, uint32_t consumers,
+        bool coalesce ) {
+    int next_tail = (q->tail + 1) % EVENT_QUEUE_SIZE;
+    if( next_tail == q->head ) {
+        if( !drop_lagging_slot(q) ) {
+            return RES_ERR_GENERIC; 
+        }
+        next_tail = (q->tail + 1) % EVENT_QUEUE_SIZE;
+    }
+    q->slots[q->tail].event = *e;
+    q->slots[q->tail].pending = consumers;
+    q->slots[q->tail].coalesce = coalesce;
+    q->tail = next_tail;
+
+    return RES_OK;
+}
+
+// Must be called with the queue mutex held
+static bool take_event( event_queue_t * q, sys_component_t consumer, 
+        event_t * event OUTPUT ) {
+    int idx = q->head;
+    while( idx != q->tail ) {
+        if( q->slots[idx].pending & COMPONENT_BIT(consumer) ) {
+            *event = q->slots[idx].event;
+
+            // Fanned out events share one slot until every consumer popped it
+            q->slots[idx].pending &= ~COMPONENT_BIT(consumer);
+            if( q->slots[idx].pending == 0 ) {
+                remove_slot(q, idx);
+                pthread_cond_broadcast(&q->space_cv);
+            }
+            return true;
+        }
+        idx = (idx + 1) % EVENT_QUEUE_SIZE;
+    }
+
+    return false;
+}
+
+static struct timespec deadline_after_ms( uint32_t timeout_ms ) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += (time_t)(timeout_ms / MS_PER_SEC);
+    ts.tv_nsec += (long)(timeout_ms % MS_PER_SEC) * 1000000L;
+    if( ts.tv_nsec >= 1000000000L ) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// Must be called with the queue mutex held
+static int wait_for( pthread_cond_t * cv, pthread_mutex_t * mu, 
+        uint32_t timeout_ms, const struct timespec * deadline ) {
+    return (timeout_ms == EVENT_QUEUE_WAIT_FOREVER) ?
+        pthread_cond_wait(cv, mu) :
+        pthread_cond_timedwait(cv, mu, deadline);
+}
+
+static result_t cond_init_monotonic( pthread_cond_t * cv ) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int rc = pthread_cond_init(cv, &attr);
+    pthread_condattr_destroy(&attr);
+
+    return rc == 0 ? RES_OK : RES_ERR_NOT_READY;
+}
+
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
@@ -23,59 +139,139 @@ result_t event_queue_init( event_queue_t * q ) {
 
     q->head = 0;
     q->tail = 0;
+    memset(q->dropped, 0, sizeof(q->dropped));
 
     if( pthread_mutex_init(&q->mu, NULL) != 0 ) {
         return RES_ERR_NOT_READY;
     }
 
+    // Timeouts are measured on monotonic clock, like the rest of the app
+    if( cond_init_monotonic(&q->cv) != RES_OK ) {
+        pthread_mutex_destroy(&q->mu);
+        return RES_ERR_NOT_READY;
+    }
+    if( cond_init_monotonic(&q->space_cv) != RES_OK ) {
+        pthread_cond_destroy(&q->cv);
+        pthread_mutex_destroy(&q->mu);
+        return RES_ERR_NOT_READY;
+    }
+
     return RES_OK;
 }
 
 result_t event_queue_push( event_queue_t * q, event_t * e ) {
+    RETURN_IF_NULL(e);
+    return event_queue_push_fanout(q, e, COMPONENT_BIT(e->dest));
+}
+
+result_t event_queue_push_coalesced( event_queue_t * q, event_t * e ) {
+    RETURN_IF_NULL(e);
+    return event_queue_push_fanout_coalesced(q, e, COMPONENT_BIT(e->dest));
+}
+
+result_t event_queue_push_fanout( event_queue_t * q, event_t * e, 
+        uint32_t consumers ) {
+    return event_queue_push_fanout_timeout(q, e, consumers, 0);
+}
+
+// Back-pressure for producers that would rather wait than lose an event
+result_t event_queue_push_fanout_timeout( event_queue_t * q, event_t * e, 
+        uint32_t consumers, uint32_t timeout_ms ) {
     RETURN_IF_NULL(q);
     RETURN_IF_NULL(e);
+    RETURN_ERROR_IF( consumers == 0, RES_ERR_WRONG_ARGS );
+
+    struct timespec deadline = STRUCT_INIT_ALL_ZEROS;
+    if( timeout_ms != 0 && timeout_ms != EVENT_QUEUE_WAIT_FOREVER ) {
+        deadline = deadline_after_ms(timeout_ms);
+    }
 
     pthread_mutex_lock(&q->mu);
+    result_t res = push_slot(q, e, consumers, false);
+    while( res != RES_OK && timeout_ms != 0 ) {
+        int rc = wait_for(&q->space_cv, &q->mu, timeout_ms, &deadline);
+        res = push_slot(q, e, consumers, false);
+        if( rc == ETIMEDOUT ) {
+            break;
+        }
+    }
+    if( res == RES_OK ) {
+        pthread_cond_broadcast(&q->cv);
+    }
+    pthread_mutex_unlock(&q->mu);
 
-    int next_tail = (q->tail + 1) % EVENT_QUEUE_SIZE;
-    if( next_tail == q->head ) {
-        pthread_mutex_unlock(&q->mu);
-        return RES_ERR_GENERIC; 
+    return res;
+}
+
+result_t event_queue_push_fanout_coalesced( event_queue_t * q, event_t * e, 
+        uint32_t consumers ) {
+    RETURN_IF_NULL(q);
+    RETURN_IF_NULL(e);
+    RETURN_ERROR_IF( consumers == 0, RES_ERR_WRONG_ARGS );
+
+    pthread_mutex_lock(&q->mu);
+
+    // Last value wins: drop the undelivered one and append the new one at the 
+    // tail, so it is still ordered after everything published before it
+    int idx = q->head;
+    while( idx != q->tail ) {
+        if( q->slots[idx].coalesce && 
+                is_same_coalescing_key(&q->slots[idx].event, e) ) {
+            remove_slot(q, idx);
+            break;
+        }
+        idx = (idx + 1) % EVENT_QUEUE_SIZE;
+    }
+
+    result_t res = push_slot(q, e, consumers, true);
+    if( res == RES_OK ) {
+        pthread_cond_broadcast(&q->cv);
     }
-    q->events[q->tail] = *e;
-    q->tail = next_tail;
 
     pthread_mutex_unlock(&q->mu);
 
-    return RES_OK;
+    return res;
 }
 
 result_t event_queue_pop( event_queue_t * q, sys_component_t consumer, 
         event_t * event OUTPUT ) {
+    return event_queue_pop_timeout(q, consumer, event, 0);
+}
+
+result_t event_queue_pop_timeout( event_queue_t * q, sys_component_t consumer, 
+        event_t * event OUTPUT, uint32_t timeout_ms ) {
     RETURN_IF_NULL(q);
     RETURN_IF_NULL(event);
 
+    struct timespec deadline = STRUCT_INIT_ALL_ZEROS;
+    if( timeout_ms != 0 && timeout_ms != EVENT_QUEUE_WAIT_FOREVER ) {
+        deadline = deadline_after_ms(timeout_ms);
+    }
+
     pthread_mutex_lock(&q->mu);
 
-    int idx = q->head;
-    while( idx != q->tail ) {
-        if( q->events[idx].dest == consumer ) {
-            *event = q->events[idx];
-            int move_idx = idx;
-            while( move_idx != q->tail ) {
-                int nxt = (move_idx + 1) % EVENT_QUEUE_SIZE;
-                if( nxt == q->tail ) break;
-                q->events[move_idx] = q->events[nxt];
-                move_idx = nxt;
-            }
-            q->tail = (q->tail + EVENT_QUEUE_SIZE - 1) % EVENT_QUEUE_SIZE;
-            pthread_mutex_unlock(&q->mu);
-            return RES_OK;
+    bool found = take_event(q, consumer, event);
+    while( !found && timeout_ms != 0 ) {
+        int rc = wait_for(&q->cv, &q->mu, timeout_ms, &deadline);
+        found = take_event(q, consumer, event);
+        if( rc == ETIMEDOUT ) {
+            break;
         }
-        idx = (idx + 1) % EVENT_QUEUE_SIZE;
     }
 
     pthread_mutex_unlock(&q->mu);
 
-    return RES_ERR_GENERIC; 
+    return found ? RES_OK : RES_ERR_GENERIC; 
+}
+
+uint32_t event_queue_dropped( event_queue_t * q, sys_component_t consumer ) {
+    if( !q || (unsigned)consumer >= COMPONENT_COUNT ) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&q->mu);
+    uint32_t dropped = q->dropped[consumer];
+    pthread_mutex_unlock(&q->mu);
+
+    return dropped;
 }
@@ -28,17 +28,27 @@ extern "C" {
  **********************/
 
 #define EVENT_QUEUE_SIZE 32
+#define EVENT_QUEUE_WAIT_FOREVER UINT32_MAX
 
 /************
  * TYPEDEFS *
  ************/
 
+typedef struct {
+    event_t event;
+    uint32_t pending;   // Bitmask of consumers that have not popped it yet
+    bool coalesce;      // Replaceable by a newer coalesced event (same key)
+} event_queue_slot_t;
+
 typedef struct {
     int head;
     int tail;
     pthread_mutex_t mu;
+    pthread_cond_t cv;  // Broadcast on push, consumers check their own events
+    pthread_cond_t space_cv;    // Broadcast when a slot is freed
 
-    event_t events[EVENT_QUEUE_SIZE];
+    event_queue_slot_t slots[EVENT_QUEUE_SIZE];
+    uint32_t dropped[COMPONENT_COUNT];  // Events lost by lagging subscribers
 } event_queue_t;
 
 /******************************
@@ -47,8 +57,18 @@ typedef struct {
 
 extern result_t event_queue_init( event_queue_t * q );
 extern result_t event_queue_push( event_queue_t * q, event_t * e );
+extern result_t event_queue_push_coalesced( event_queue_t * q, event_t * e );
+extern result_t event_queue_push_fanout( event_queue_t * q, event_t * e, 
+    uint32_t consumers );
+extern result_t event_queue_push_fanout_coalesced( event_queue_t * q, 
+    event_t * e, uint32_t consumers );
+extern result_t event_queue_push_fanout_timeout( event_queue_t * q, event_t * e, 
+    uint32_t consumers, uint32_t timeout_ms );
 extern result_t event_queue_pop( event_queue_t * q, sys_component_t consumer, 
     event_t * event OUTPUT );
+extern result_t event_queue_pop_timeout( event_queue_t * q, 
+    sys_component_t consumer, event_t * event OUTPUT, uint32_t timeout_ms );
+extern uint32_t event_queue_dropped( event_queue_t * q, sys_component_t consumer );
 
 #ifdef __cplusplus
 }
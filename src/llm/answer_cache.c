@@ -0,0 +1,484 @@
+/**
+ *******************************************************************************
+ * @file    answer_cache.c
+ * @brief   Persistent answer cache source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "utils.h"
+
+#include "answer_cache.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define CACHE_MAGIC             0x43415450u     // "PTAC"
+#define CACHE_VERSION           1u
+#define RECORD_MAGIC            0x31524341u     // "ACR1"
+#define RECORD_MAGIC_DEAD       0x44414544u     // "DEAD"
+
+#define CACHE_MIN_FILE_SIZE     (64u * 1024u)
+#define INDEX_MIN_CAPACITY      64u
+#define RECORD_ALIGN            8u
+
+#define FNV1A_64_OFFSET         0xcbf29ce484222325ull
+#define FNV1A_64_PRIME          0x100000001b3ull
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t used;          // End of last complete record
+    uint64_t clock;         // Logical time for LRU
+    uint64_t reserved;
+} cache_header_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t key_len;
+    uint32_t answer_len;
+    uint32_t reserved;
+    uint64_t hash;
+    uint64_t last_used;
+} record_header_t;
+
+typedef struct {
+    size_t offset;
+    uint64_t last_used;
+} record_ref_t;
+
+STATIC_ASSERT(sizeof(cache_header_t) % RECORD_ALIGN == 0, "Header breaks alignment");
+STATIC_ASSERT(sizeof(record_header_t) % RECORD_ALIGN == 0, "Record breaks alignment");
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static uint64_t fnv1a_64( const char * data, size_t len ) {
+    uint64_t hash = FNV1A_64_OFFSET;
+    for( size_t i = 0; i < len; i++ ) {
+        hash ^= (uint8_t)data[i];
+        hash *= FNV1A_64_PRIME;
+    }
+    return hash;
+}
+
+static size_t record_size( size_t key_len, size_t answer_len ) {
+    size_t size = sizeof(record_header_t) + key_len + answer_len;
+    return (size + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1);
+}
+
+static cache_header_t * header_of( answer_cache_t * cache ) {
+    return (cache_header_t *)(void *)cache->map;
+}
+
+static record_header_t * record_at( answer_cache_t * cache, size_t offset ) {
+    return (record_header_t *)(void *)(cache->map + offset);
+}
+
+// Returns size of valid record at offset or 0 if there is none
+static size_t record_check( answer_cache_t * cache, size_t offset ) {
+    size_t used = (size_t)header_of(cache)->used;
+    if( offset + sizeof(record_header_t) > used ) {
+        return 0;
+    }
+
+    record_header_t * rec = record_at(cache, offset);
+    if( rec->magic != RECORD_MAGIC && rec->magic != RECORD_MAGIC_DEAD ) {
+        return 0;
+    }
+
+    size_t size = record_size(rec->key_len, rec->answer_len);
+    return (offset + size <= used) ? size : 0;
+}
+
+// Key bytes are compared as well, hash alone may collide
+static bool record_matches( const record_header_t * rec, uint64_t hash,
+        const char * key, size_t key_len ) {
+    return rec->magic == RECORD_MAGIC && rec->hash == hash &&
+        rec->key_len == key_len && memcmp(rec + 1, key, key_len) == 0;
+}
+
+// === INDEX ===
+
+static void index_free( answer_cache_t * cache ) {
+    free(cache->index);
+    cache->index = NULL;
+    cache->index_capacity = 0;
+    cache->index_count = 0;
+}
+
+// Slot of superseded record with the same hash is reused, so the table only
+// grows with live records
+static void index_put( answer_cache_t * cache, uint64_t hash, size_t offset ) {
+    size_t mask = cache->index_capacity - 1;
+    for( size_t i = (size_t)hash & mask; ; i = (i + 1) & mask ) {
+        answer_cache_slot_t * slot = &cache->index[i];
+        if( slot->offset == 0 ) {
+            cache->index_count++;
+        } else if( slot->hash != hash || 
+                record_at(cache, slot->offset)->magic != RECORD_MAGIC_DEAD ) {
+            continue;
+        }
+
+        slot->hash = hash;
+        slot->offset = offset;
+        return;
+    }
+}
+
+// Table is kept at most half full
+static result_t index_rebuild( answer_cache_t * cache ) {
+    index_free(cache);
+
+    size_t count = 0;
+    for( size_t off = sizeof(cache_header_t), size;
+            (size = record_check(cache, off)) != 0; off += size ) {
+        count += (record_at(cache, off)->magic == RECORD_MAGIC);
+    }
+
+    size_t capacity = INDEX_MIN_CAPACITY;
+    while( capacity < 2 * (count + 1) ) {
+        capacity *= 2;
+    }
+
+    cache->index = calloc(capacity, sizeof(answer_cache_slot_t));
+    RETURN_IF_NULL(cache->index);
+    cache->index_capacity = capacity;
+
+    for( size_t off = sizeof(cache_header_t), size;
+            (size = record_check(cache, off)) != 0; off += size ) {
+        record_header_t * rec = record_at(cache, off);
+        if( rec->magic == RECORD_MAGIC ) {
+            index_put(cache, rec->hash, off);
+        }
+    }
+
+    return RES_OK;
+}
+
+static void index_add( answer_cache_t * cache, uint64_t hash, size_t offset ) {
+    if( !cache->index ) {
+        return;
+    }
+
+    // Rebuild also picks up the new record, as it is already in the file
+    if( 2 * (cache->index_count + 1) > cache->index_capacity ) {
+        index_rebuild(cache);
+        return;
+    }
+    index_put(cache, hash, offset);
+}
+
+static record_header_t * find_record( answer_cache_t * cache, 
+        const char * key, size_t key_len ) {
+    uint64_t hash = fnv1a_64(key, key_len);
+
+    if( cache->index ) {
+        size_t mask = cache->index_capacity - 1;
+        for( size_t i = (size_t)hash & mask; cache->index[i].offset != 0; 
+                i = (i + 1) & mask ) {
+            if( cache->index[i].hash != hash ) {
+                continue;
+            }
+            record_header_t * rec = record_at(cache, cache->index[i].offset);
+            if( record_matches(rec, hash, key, key_len) ) {
+                return rec;
+            }
+        }
+        return NULL;
+    }
+
+    for( size_t off = sizeof(cache_header_t), size;
+            (size = record_check(cache, off)) != 0; off += size ) {
+        record_header_t * rec = record_at(cache, off);
+        if( record_matches(rec, hash, key, key_len) ) {
+            return rec;
+        }
+    }
+
+    return NULL;
+}
+
+static result_t cache_map( answer_cache_t * cache, size_t size ) {
+    if( cache->map ) {
+        munmap(cache->map, cache->map_size);
+        cache->map = NULL;
+        cache->map_size = 0;
+    }
+
+    RETURN_ERROR_IF( ftruncate(cache->fd, (off_t)size) != 0, RES_ERR_GENERIC );
+
+    void * map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+        cache->fd, 0);
+    RETURN_ERROR_IF( map == MAP_FAILED, RES_ERR_GENERIC );
+
+    cache->map = map;
+    cache->map_size = size;
+
+    return RES_OK;
+}
+
+static int compare_by_last_used( const void * a, const void * b ) {
+    const record_ref_t * ra = a;
+    const record_ref_t * rb = b;
+    return (ra->last_used > rb->last_used) - (ra->last_used < rb->last_used);
+}
+
+// Drops dead and least recently used records until there is space left
+static result_t cache_compact( answer_cache_t * cache, size_t target_used ) {
+    cache_header_t * header = header_of(cache);
+
+    size_t count = 0;
+    for( size_t off = sizeof(cache_header_t), size;
+            (size = record_check(cache, off)) != 0; off += size ) {
+        count++;
+    }
+
+    record_ref_t * refs = (count > 0) ? malloc(count * sizeof(record_ref_t)) : NULL;
+    RETURN_ERROR_IF( count > 0 && !refs, RES_ERR_GENERIC );
+
+    size_t live = 0;
+    size_t live_bytes = sizeof(cache_header_t);
+    for( size_t off = sizeof(cache_header_t), size;
+            (size = record_check(cache, off)) != 0; off += size ) {
+        record_header_t * rec = record_at(cache, off);
+        if( rec->magic == RECORD_MAGIC ) {
+            refs[live].offset = off;
+            refs[live].last_used = rec->last_used;
+            live++;
+            live_bytes += size;
+        }
+    }
+
+    qsort(refs, live, sizeof(record_ref_t), compare_by_last_used);
+    for( size_t i = 0; i < live && live_bytes > target_used; i++ ) {
+        record_header_t * rec = record_at(cache, refs[i].offset);
+        rec->magic = RECORD_MAGIC_DEAD;
+        live_bytes -= record_size(rec->key_len, rec->answer_len);
+    }
+    free(refs);
+
+    // Records only move towards the beginning, so it can be done in place
+    size_t write_off = sizeof(cache_header_t);
+    size_t off = sizeof(cache_header_t);
+    size_t size = 0;
+    while( (size = record_check(cache, off)) != 0 ) {
+        if( record_at(cache, off)->magic == RECORD_MAGIC ) {
+            if( write_off != off ) {
+                memmove(cache->map + write_off, cache->map + off, size);
+            }
+            write_off += size;
+        }
+        off += size;
+    }
+    header->used = write_off;
+
+    // Offsets have changed, lookups scan the file if index can't be built
+    if( index_rebuild(cache) != RES_OK ) {
+        WARN("Answer cache index not rebuilt, lookups scan the file.");
+    }
+
+    return RES_OK;
+}
+
+static void cache_header_init( answer_cache_t * cache ) {
+    cache_header_t * header = header_of(cache);
+    memset(header, 0, sizeof(cache_header_t));
+    header->version = CACHE_VERSION;
+    header->used = sizeof(cache_header_t);
+    header->magic = CACHE_MAGIC;
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t answer_cache_open( answer_cache_t * cache, const char * path,
+        size_t max_size ) {
+    RETURN_IF_NULL(cache);
+    RETURN_IF_NULL(path);
+    RETURN_ERROR_IF( max_size < CACHE_MIN_FILE_SIZE, RES_ERR_WRONG_ARGS );
+
+    cache->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    RETURN_ERROR_IF( cache->fd < 0, RES_ERR_GENERIC );
+    cache->max_size = max_size;
+
+    struct stat st;
+    if( fstat(cache->fd, &st) != 0 ) {
+        answer_cache_close(cache);
+        return RES_ERR_GENERIC;
+    }
+
+    size_t file_size = (size_t)st.st_size;
+    if( file_size < CACHE_MIN_FILE_SIZE ) {
+        file_size = CACHE_MIN_FILE_SIZE;
+    }
+    if( cache_map(cache, file_size) != RES_OK ) {
+        answer_cache_close(cache);
+        return RES_ERR_GENERIC;
+    }
+
+    // Cache is only an optimization, so unknown content is dropped
+    cache_header_t * header = header_of(cache);
+    if( header->magic != CACHE_MAGIC || header->version != CACHE_VERSION ||
+            header->used < sizeof(cache_header_t) || header->used > file_size ) {
+        cache_header_init(cache);
+    }
+
+    if( index_rebuild(cache) != RES_OK ) {
+        WARN("Answer cache index not built, lookups scan the file.");
+    }
+
+    return RES_OK;
+}
+
+void answer_cache_close( answer_cache_t * cache ) {
+    if( !cache ) {
+        return;
+    }
+
+    if( cache->map ) {
+        munmap(cache->map, cache->map_size);
+    }
+    if( cache->fd >= 0 ) {
+        close(cache->fd);
+    }
+
+    index_free(cache);
+
+    cache->fd = -1;
+    cache->map = NULL;
+    cache->map_size = 0;
+}
+
+result_t answer_cache_make_key( const char * transcript,
+        const char * model, const char * options,
+        char * key OUTPUT, size_t key_size, size_t * key_len OUTPUT ) {
+    RETURN_IF_NULL(transcript);
+    RETURN_IF_NULL(model);
+    RETURN_IF_NULL(options);
+    RETURN_IF_NULL(key);
+    RETURN_IF_NULL(key_len);
+
+    // Case, punctuation and segmentation of the transcript doesn't matter
+    size_t len = 0;
+    bool pending_space = false;
+    for( const char * p = transcript; *p; p++ ) {
+        unsigned char ch = (unsigned char)*p;
+        if( !isalnum(ch) && ch != '\'' ) {
+            pending_space = (len > 0);
+            continue;
+        }
+
+        RETURN_ERROR_IF( len + 2 >= key_size, RES_ERR_INVALID_SIZE );
+        if( pending_space ) {
+            key[len++] = ' ';
+            pending_space = false;
+        }
+        key[len++] = (char)tolower(ch);
+    }
+
+    int written = snprintf(key + len, key_size - len, "\n%s\n%s", model, options);
+    RETURN_ERROR_IF( written < 0 || (size_t)written >= key_size - len,
+        RES_ERR_INVALID_SIZE );
+
+    *key_len = len + (size_t)written;
+
+    return RES_OK;
+}
+
+result_t answer_cache_lookup( answer_cache_t * cache,
+        const char * key, size_t key_len,
+        const char ** answer OUTPUT, size_t * answer_len OUTPUT ) {
+    RETURN_IF_NULL(cache);
+    RETURN_IF_NULL(cache->map);
+    RETURN_IF_NULL(key);
+    RETURN_IF_NULL(answer);
+    RETURN_IF_NULL(answer_len);
+
+    *answer = NULL;
+    *answer_len = 0;
+
+    record_header_t * rec = find_record(cache, key, key_len);
+    if( rec ) {
+        // LRU order is kept by updating the record in place
+        rec->last_used = ++header_of(cache)->clock;
+        *answer = (const char *)(rec + 1) + key_len;
+        *answer_len = rec->answer_len;
+    }
+
+    return RES_OK;
+}
+
+result_t answer_cache_store( answer_cache_t * cache,
+        const char * key, size_t key_len,
+        const char * answer, size_t answer_len ) {
+    RETURN_IF_NULL(cache);
+    RETURN_IF_NULL(cache->map);
+    RETURN_IF_NULL(key);
+    RETURN_IF_NULL(answer);
+    RETURN_ERROR_IF( key_len == 0 || key_len > UINT32_MAX ||
+        answer_len > UINT32_MAX, RES_ERR_WRONG_ARGS );
+
+    // After eviction cache should have some headroom, not one record
+    size_t target_used = cache->max_size * 3 / 4;
+    size_t size = record_size(key_len, answer_len);
+    RETURN_ERROR_IF( sizeof(cache_header_t) + size > target_used,
+        RES_ERR_INVALID_SIZE );
+
+    // Older answer for the same key is superseded
+    record_header_t * old = find_record(cache, key, key_len);
+    if( old ) {
+        old->magic = RECORD_MAGIC_DEAD;
+    }
+
+    if( header_of(cache)->used + size > cache->max_size ) {
+        RETURN_ON_ERROR( cache_compact(cache, target_used - size) );
+    }
+
+    size_t used = (size_t)header_of(cache)->used;
+    if( used + size > cache->map_size ) {
+        size_t new_size = cache->map_size * 2;
+        while( new_size < used + size ) {
+            new_size *= 2;
+        }
+        if( new_size > cache->max_size ) {
+            new_size = cache->max_size;
+        }
+        RETURN_ON_ERROR( cache_map(cache, new_size) );
+    }
+
+    cache_header_t * header = header_of(cache);
+    record_header_t * rec = record_at(cache, used);
+    memset(rec, 0, size);
+    rec->key_len = (uint32_t)key_len;
+    rec->answer_len = (uint32_t)answer_len;
+    rec->hash = fnv1a_64(key, key_len);
+    rec->last_used = ++header->clock;
+    memcpy(rec + 1, key, key_len);
+    memcpy((char *)(rec + 1) + key_len, answer, answer_len);
+    rec->magic = RECORD_MAGIC;
+
+    // Record becomes visible only when it is complete
+    header->used = used + size;
+    index_add(cache, rec->hash, used);
+
+    return RES_OK;
+}
@@ -0,0 +1,84 @@
+/**
+ *******************************************************************************
+ * @file    answer_cache.h
+ * @brief   Persistent answer cache header file.
+ *          Append-only records in mmap-ed file, keyed by normalized
+ *          transcript plus model and options, evicted in LRU order.
+ *******************************************************************************
+ */
+
+#ifndef ANSWER_CACHE_H
+#define ANSWER_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include "utils.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define ANSWER_CACHE_INIT { \
+    .fd = -1, \
+    .map = NULL, \
+    .map_size = 0, \
+    .max_size = 0, \
+    .index = NULL, \
+    .index_capacity = 0, \
+    .index_count = 0 \
+}
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef struct {
+    uint64_t hash;
+    size_t offset;              // 0 marks empty slot, records start after header
+} answer_cache_slot_t;
+
+typedef struct {
+    int fd;
+    uint8_t * map;
+    size_t map_size;
+    size_t max_size;
+
+    // Open addressing table from key hash to record, built when file is
+    // opened or compacted. Without it records are scanned.
+    answer_cache_slot_t * index;
+    size_t index_capacity;      // Power of two
+    size_t index_count;
+} answer_cache_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t answer_cache_open( answer_cache_t * cache, const char * path,
+    size_t max_size );
+extern void answer_cache_close( answer_cache_t * cache );
+
+extern result_t answer_cache_make_key( const char * transcript,
+    const char * model, const char * options,
+    char * key OUTPUT, size_t key_size, size_t * key_len OUTPUT );
+
+// On miss answer is NULL. Returned answer points into the mapping and is
+// valid only until the next store.
+extern result_t answer_cache_lookup( answer_cache_t * cache,
+    const char * key, size_t key_len,
+    const char ** answer OUTPUT, size_t * answer_len OUTPUT );
+extern result_t answer_cache_store( answer_cache_t * cache,
+    const char * key, size_t key_len,
+    const char * answer, size_t answer_len );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANSWER_CACHE_H */
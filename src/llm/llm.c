@@ -14,12 +14,17 @@
 #include <string.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <sys/stat.h>
 
 #include "utils.h"
+#include "cancel_token.h"
+#include "config.h"
 
 #include "llm.h"
-#include "ollama_api_ops.h"
+#include "llm_backend.h"
+#include "answer_cache.h"
+#include "think_filter.h"
 #include "event_broker.h"
 
 /******************************
@@ -27,6 +32,16 @@
  ******************************/
 
 #define MAX_FILEPATH_SIZE       512
+#define MAX_PREFILL_PROMPT_SIZE 2048
+
+#define ANSWER_CACHE_FILEPATH   "data/answer_cache.bin"
+#define MAX_CACHE_KEY_SIZE      1024
+#define CACHE_HIT_CHUNK_SIZE    (EVENT_MAX_DATA_SIZE - 1)
+#define PUBLISH_TIMEOUT_MS      1000                // Bounds wait for full queue
+
+#define DEFAULT_THINK_MODE      THINK_MODE_COLLAPSE
+#define THINK_SPINNER_PERIOD_US 250000
+#define THINK_FILE_EXTENSION    ".think"
 
 /********************
  * PRIVATE TYPEDEFS *
@@ -43,17 +58,58 @@ typedef struct {
     char prompt_filepath[MAX_FILEPATH_SIZE];
     char answer_filepath[MAX_FILEPATH_SIZE];
 
-    volatile int * llm_stop_flag;
-    response_callback_t llm_callback;
+    cancel_token_t * llm_cancel;
+    llm_response_callback_t llm_callback;
 
     llm_status_t status;
 } llm_context_t;
 
+typedef struct {
+    char prompt[MAX_PREFILL_PROMPT_SIZE];       // Transcript received so far
+    char in_flight[MAX_PREFILL_PROMPT_SIZE];    // Prompt of running prefill
+    bool overflow;
+
+    cancel_token_t * prefill_cancel;
+    pthread_t thread;
+
+    llm_status_t status;
+} llm_prefill_t;
+
+typedef struct {
+    think_filter_t filter;
+    think_mode_t mode;
+
+    FILE * answer_file;
+    FILE * think_file;          // Opened only in archive mode
+
+    uint64_t think_start_us;
+    uint64_t last_spin_us;
+    unsigned int spin_idx;
+
+    atomic_bool skip_think;     // Set by LLM thread on user request
+    bool think_skipped;
+} llm_output_t;
+
 /********************
  * STATIC VARIABLES *
  ********************/
 
-static volatile int llm_stop_flag = 0;
+static cancel_token_t llm_cancel;
+static cancel_token_t prefill_cancel;
+static const llm_backend_t * backend = NULL;
+static answer_cache_t answer_cache = ANSWER_CACHE_INIT;
+
+// Only touched by operation thread (except atomic skip request)
+static llm_output_t output = {
+    .mode = DEFAULT_THINK_MODE
+};
+
+// Too big for thread stack, only touched by LLM thread (and prefill thread 
+// reading in_flight while it runs)
+static llm_prefill_t prefill = {
+    .prefill_cancel = &prefill_cancel,
+    .status = LLM_STATUS_NOT_STARTED
+};
 
 /********************
  * STATIC FUNCTIONS *
@@ -109,18 +165,419 @@ result_t copy_prompt_to_answer_file( const char * prompt_filepath,
     return RES_OK;
 }
 
+static void llm_status_event_publish( const char * status_msg, 
+        size_t status_msg_size ) {    
+    event_t event = STRUCT_INIT_ALL_ZEROS;
+    result_t res = event_create(
+        COMPONENT_LLM, COMPONENT_CORE_DISP,
+        EVENT_LLM_STATUS, 
+        status_msg, status_msg_size,
+        &event);
+
+    // Answer text is not coalesced, so it waits for the core to make room
+    // instead of losing tokens
+    if( res == RES_OK ) {
+        broker_publish_timeout(&event, PUBLISH_TIMEOUT_MS);
+    }
+}
+
+static void llm_thinking_event_publish( const char * thinking_msg, 
+        size_t thinking_msg_size ) {    
+    event_t event = STRUCT_INIT_ALL_ZEROS;
+    result_t res = event_create(
+        COMPONENT_LLM, COMPONENT_CORE_DISP,
+        EVENT_LLM_THINKING, 
+        thinking_msg, thinking_msg_size,
+        &event);
+
+    if( res == RES_OK ) {
+        broker_publish_coalesced(&event);
+    }
+}
+
+// === OUTPUT ===
+
+static void output_write( FILE * file, const char * data, size_t size ) {
+    if( file ) {
+        fwrite(data, 1, size, file);
+        fflush(file);
+    }
+}
+
+static void output_show( const char * data, size_t size ) {
+    // Data is not NUL terminated (e.g. chunk of cached answer)
+    char msg[EVENT_MAX_DATA_SIZE];
+    for( size_t off = 0; off < size; off += sizeof(msg) - 1 ) {
+        size_t msg_len = size - off;
+        if( msg_len > sizeof(msg) - 1 ) {
+            msg_len = sizeof(msg) - 1;
+        }
+        memcpy(msg, data + off, msg_len);
+        msg[msg_len] = '\0';
+        llm_status_event_publish(msg, msg_len);
+    }
+}
+
+static void output_spinner( llm_output_t * out, bool force ) {
+    static const char frames[] = "|/-\\";
+
+    uint64_t now_us = get_current_time_us();
+    if( !force && now_us - out->last_spin_us < THINK_SPINNER_PERIOD_US ) {
+        return;
+    }
+    out->last_spin_us = now_us;
+
+    char msg[32];
+    snprintf(msg, sizeof(msg), "Thinking %c %llus", 
+        frames[out->spin_idx++ % (sizeof(frames) - 1)],
+        (unsigned long long)((now_us - out->think_start_us) / US_PER_SEC));
+    llm_thinking_event_publish(msg, strlen(msg));
+}
+
+// Rest of reasoning is only hidden, model still has to generate it
+static bool output_skip_think( llm_output_t * out ) {
+    if( out->think_skipped ) {
+        return true;
+    }
+    if( !atomic_load(&out->skip_think) ) {
+        return false;
+    }
+    out->think_skipped = true;
+
+    const char * msg = "Thinking skipped.\n";
+    if( out->mode == THINK_MODE_SHOW ) {
+        output_show("\n", 1);
+        output_show(msg, strlen(msg));
+    } else if( out->mode != THINK_MODE_HIDE ) {
+        llm_thinking_event_publish(msg, strlen(msg));
+    }
+
+    return true;
+}
+
+static void think_segment_callback( think_segment_t segment, 
+        const char * data, size_t size, void * user_data ) {
+    llm_output_t * out = (llm_output_t *)user_data;
+    bool collapsed = out->mode == THINK_MODE_COLLAPSE || 
+                     out->mode == THINK_MODE_ARCHIVE;
+
+    switch( segment ) {
+        case THINK_SEGMENT_ANSWER: {
+            output_write(out->answer_file, data, size);
+            output_show(data, size);
+            break;
+        }
+
+        case THINK_SEGMENT_THINK: {
+            if( out->mode == THINK_MODE_ARCHIVE ) {
+                output_write(out->think_file, data, size);
+            } else {
+                output_write(out->answer_file, data, size);
+            }
+
+            if( output_skip_think(out) ) {
+                break;
+            }
+            if( out->mode == THINK_MODE_SHOW ) {
+                output_show(data, size);
+            } else if( collapsed ) {
+                output_spinner(out, false);
+            }
+            break;
+        }
+
+        case THINK_SEGMENT_THINK_BEGIN:
+        case THINK_SEGMENT_THINK_END: {
+            const char * tag = (segment == THINK_SEGMENT_THINK_BEGIN) ? 
+                THINK_TAG_OPEN : THINK_TAG_CLOSE;
+            if( out->mode != THINK_MODE_ARCHIVE ) {
+                output_write(out->answer_file, tag, strlen(tag));
+            }
+
+            if( output_skip_think(out) ) {
+                break;
+            }
+            if( out->mode == THINK_MODE_SHOW ) {
+                output_show(tag, strlen(tag));
+            } else if( collapsed && segment == THINK_SEGMENT_THINK_BEGIN ) {
+                out->think_start_us = get_current_time_us();
+                output_spinner(out, true);
+            } else if( collapsed ) {
+                char msg[32];
+                snprintf(msg, sizeof(msg), "Thought for %llus.\n", 
+                    (unsigned long long)((get_current_time_us() - 
+                        out->think_start_us) / US_PER_SEC));
+                llm_thinking_event_publish(msg, strlen(msg));
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static think_mode_t think_mode_from_name( const char * name ) {
+    static const char * const names[] = {
+        [THINK_MODE_SHOW] = "show",
+        [THINK_MODE_HIDE] = "hide",
+        [THINK_MODE_COLLAPSE] = "collapse",
+        [THINK_MODE_ARCHIVE] = "archive",
+    };
+
+    for( size_t i = 0; i < NELEMS(names); i++ ) {
+        if( strcmp(names[i], name) == 0 ) {
+            return (think_mode_t)i;
+        }
+    }
+
+    return DEFAULT_THINK_MODE;
+}
+
+static void output_begin( llm_output_t * out, const char * answer_filepath ) {
+    // Mode may change with config reload, but not in the middle of answer
+    config_t config;
+    config_get(&config);
+    out->mode = think_mode_from_name(config.llm.think_mode);
+
+    think_filter_init(&out->filter, think_segment_callback, out);
+    out->answer_file = fopen(answer_filepath, "a");
+    out->think_file = NULL;
+    out->spin_idx = 0;
+    out->think_skipped = false;
+
+    if( out->mode == THINK_MODE_ARCHIVE ) {
+        const char * dot = strrchr(answer_filepath, '.');
+        int base_len = dot ? (int)(dot - answer_filepath) : (int)strlen(answer_filepath);
+
+        char think_filepath[MAX_FILEPATH_SIZE + sizeof(THINK_FILE_EXTENSION)];
+        snprintf(think_filepath, sizeof(think_filepath), "%.*s"THINK_FILE_EXTENSION, 
+            base_len, answer_filepath);
+        out->think_file = fopen(think_filepath, "w");
+    }
+}
+
+static void output_end( llm_output_t * out ) {
+    think_filter_flush(&out->filter);
+
+    if( out->think_file ) {
+        fclose(out->think_file);
+        out->think_file = NULL;
+    }
+    if( out->answer_file ) {
+        fclose(out->answer_file);
+        out->answer_file = NULL;
+    }
+}
+
+// === ANSWER CACHE ===
+
+static result_t read_file_from( const char * filepath, long offset, 
+        char ** data OUTPUT, size_t * size OUTPUT ) {
+    FILE * file = fopen(filepath, "rb");
+    RETURN_IF_NULL(file);
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    if( file_size < offset ) {
+        fclose(file);
+        return RES_ERR_GENERIC;
+    }
+    fseek(file, offset, SEEK_SET);
+
+    *data = malloc((size_t)(file_size - offset) + 1);
+    if( !*data ) {
+        fclose(file);
+        return RES_ERR_GENERIC;
+    }
+    *size = fread(*data, 1, (size_t)(file_size - offset), file);
+    (*data)[*size] = '\0';
+    fclose(file);
+
+    return RES_OK;
+}
+
+static result_t cache_key_from_prompt( const char * prompt, 
+        char * key OUTPUT, size_t key_size, size_t * key_len OUTPUT ) {
+    return answer_cache_make_key(prompt, backend->model_name(), 
+        backend->options_json(), key, key_size, key_len);
+}
+
+static bool answer_from_cache( llm_context_t * params, 
+        const char * key, size_t key_len ) {
+    const char * answer = NULL;
+    size_t answer_len = 0;
+    if( answer_cache_lookup(&answer_cache, key, key_len, &answer, &answer_len) != RES_OK || 
+            !answer ) {
+        return false;
+    }
+
+    // Streamed as if it was generated, at the pace the core takes events
+    char chunk[CACHE_HIT_CHUNK_SIZE];
+    for( size_t off = 0; off < answer_len; off += CACHE_HIT_CHUNK_SIZE ) {
+        if( cancel_token_is_cancelled(params->llm_cancel) ) {
+            break;
+        }
+
+        size_t chunk_len = answer_len - off;
+        if( chunk_len > CACHE_HIT_CHUNK_SIZE ) {
+            chunk_len = CACHE_HIT_CHUNK_SIZE;
+        }
+        memcpy(chunk, answer + off, chunk_len);
+        params->llm_callback(chunk, chunk_len, NULL);
+    }
+
+    return true;
+}
+
+static void answer_to_cache( llm_context_t * params, long answer_offset,
+        const char * key, size_t key_len ) {
+    char * answer = NULL;
+    size_t answer_len = 0;
+    if( read_file_from(params->answer_filepath, answer_offset, 
+            &answer, &answer_len) != RES_OK ) {
+        return;
+    }
+
+    if( answer_len > 0 ) {
+        answer_cache_store(&answer_cache, key, key_len, answer, answer_len);
+    }
+    free(answer);
+}
+
+static long file_size_of( const char * filepath ) {
+    struct stat st;
+    return (stat(filepath, &st) == 0) ? (long)st.st_size : -1;
+}
+
+// === OPERATION ===
+
 static void * llm_operation_thread( void * arg ) {
     llm_context_t * params = (llm_context_t *)arg;
 
-    params->status = LLM_STATUS_IN_PROGRESS;
-    result_t res = ollama_ask_deepseek_model(params->answer_filepath, params->prompt_filepath, 
-        params->llm_stop_flag, params->llm_callback);
+    char * prompt = NULL;
+    size_t prompt_size = 0;
+    if( read_file_from(params->prompt_filepath, 0, &prompt, &prompt_size) != RES_OK ) {
+        params->status = LLM_STATUS_FINISHED_ERROR;
+        return NULL;
+    }
+    output_begin(&output, params->answer_filepath);
+
+    // Answer depends on conversation context, which is not a part of the key.
+    // With session reuse on, only questions after a reset can be cached.
+    char key[MAX_CACHE_KEY_SIZE];
+    size_t key_len = 0;
+    bool cacheable = answer_cache.map != NULL && !backend->has_session() &&
+        cache_key_from_prompt(prompt, key, sizeof(key), &key_len) == RES_OK;
+
+    result_t res = RES_OK;
+    long answer_offset = file_size_of(params->answer_filepath);
+    bool from_cache = cacheable && answer_from_cache(params, key, key_len);
+    if( !from_cache ) {
+        llm_backend_stats_t stats = STRUCT_INIT_ALL_ZEROS;
+        res = backend->generate(prompt, params->llm_cancel, 
+            params->llm_callback, NULL, &stats);
+        if( res == RES_OK ) {
+            INFO("LLM (%s): prompt %llu tok in %llu ms, answer %llu tok in %llu ms.",
+                backend->name, 
+                (unsigned long long)stats.prompt_tokens, 
+                (unsigned long long)(stats.prompt_eval_us / 1000),
+                (unsigned long long)stats.generated_tokens, 
+                (unsigned long long)(stats.generation_us / 1000));
+        }
+    }
+    free(prompt);
+
+    // Unfinished tag at the end must be in the file before it is cached
+    output_end(&output);
+    if( !from_cache && cacheable && res == RES_OK && answer_offset >= 0 ) {
+        answer_to_cache(params, answer_offset, key, key_len);
+    }
+
+    params->status = (res == RES_OK) ? LLM_STATUS_FINISHED_OK : 
+                                       LLM_STATUS_FINISHED_ERROR;
+
+    return NULL;
+}
+
+// === PREFILL ===
+
+static void * llm_prefill_thread( void * arg ) {
+    llm_prefill_t * params = (llm_prefill_t *)arg;
+
+    result_t res = backend->prefill(params->in_flight, params->prefill_cancel);
     params->status = (res == RES_OK) ? LLM_STATUS_FINISHED_OK : 
                                        LLM_STATUS_FINISHED_ERROR;
 
     return NULL;
 }
 
+static void prefill_start_if_needed( llm_prefill_t * p ) {
+    if( p->status != LLM_STATUS_NOT_STARTED || p->overflow ) {
+        return;
+    }
+    // Prefill with what was already evaluated would be a waste
+    if( p->prompt[0] == '\0' || strcmp(p->prompt, p->in_flight) == 0 ) {
+        return;
+    }
+
+    memcpy(p->in_flight, p->prompt, sizeof(p->in_flight));
+    cancel_token_reset(p->prefill_cancel);
+    p->status = LLM_STATUS_IN_PROGRESS;
+    if( pthread_create(&p->thread, NULL, llm_prefill_thread, p) != 0 ) {
+        p->status = LLM_STATUS_NOT_STARTED;
+    }
+}
+
+static void prefill_append_segment( llm_prefill_t * p, const char * segment ) {
+    // Prompt file has every final segment in separate line
+    size_t len = strlen(p->prompt);
+    size_t segment_len = strlen(segment);
+    if( len + segment_len + 2 > sizeof(p->prompt) ) {
+        p->overflow = true;
+        return;
+    }
+
+    memcpy(p->prompt + len, segment, segment_len);
+    p->prompt[len + segment_len] = '\n';
+    p->prompt[len + segment_len + 1] = '\0';
+}
+
+static void prefill_check_finished( llm_prefill_t * p, bool restart ) {
+    if( p->status == LLM_STATUS_FINISHED_OK || 
+            p->status == LLM_STATUS_FINISHED_ERROR ) {
+        pthread_join(p->thread, NULL);
+        p->status = LLM_STATUS_NOT_STARTED;
+
+        // Segments that came in the meantime
+        if( restart ) {
+            prefill_start_if_needed(p);
+        }
+    }
+}
+
+static void prefill_clear( llm_prefill_t * p ) {
+    // Running prefill is not cancelled, the real request with the same 
+    // prefix will simply be queued after it by the backend
+    memset(p->prompt, 0, sizeof(p->prompt));
+    p->overflow = false;
+}
+
+// === SESSION ===
+
+// Without session reuse (kiosk) every question is answered on its own, so 
+// it can be served from the answer cache. Reset is done once the answer is 
+// finished, so the next prefill already starts from empty conversation.
+static void session_reset_if_not_reused( void ) {
+    config_t config;
+    config_get(&config);
+    if( config.llm.session_reuse == 0 && backend->has_session() ) {
+        backend->reset_session();
+    }
+}
+
+// === EVENTS ===
+
 static void pipeline_done_event_publish( char * answer_filepath, 
         size_t answer_filepath_size ) {    
     event_t event = STRUCT_INIT_ALL_ZEROS;
@@ -148,37 +605,19 @@ static void pipeline_failed_event_publish( void ) {
     }
 }
 
-static void llm_status_event_publish( const char * status_msg, 
-        size_t status_msg_size ) {    
-    event_t event = STRUCT_INIT_ALL_ZEROS;
-    result_t res = event_create(
-        COMPONENT_LLM, COMPONENT_CORE_DISP,
-        EVENT_LLM_STATUS, 
-        status_msg, status_msg_size,
-        &event);
-
-    if( res == RES_OK ) {
-        broker_publish(&event);
-    }
-}
-
 static void llm_context_clear( llm_context_t * context ) {
     memset(context->prompt_filepath, 0, sizeof(context->prompt_filepath));
     memset(context->answer_filepath, 0, sizeof(context->answer_filepath));
     
-    llm_stop_flag = 0;
+    cancel_token_reset(context->llm_cancel);
 
     context->status = LLM_STATUS_NOT_STARTED;
 }
 
-static void llm_response_callback( char * data, size_t size, void * user_data ) {
-    FILE * output_file = (FILE *)user_data;
-    fprintf(output_file, "%.*s", (int)size, data);
-    fflush(output_file);
-
-    char msg[EVENT_MAX_DATA_SIZE];
-    snprintf(msg, strlen(data) + 1, "%.*s", (int)size, data);
-    llm_status_event_publish(msg, strlen(data));
+static void llm_response_callback( char * data, size_t size, 
+        void * user_data UNUSED_PARAM ) {
+    // Output (also answer file) is handled according to think mode
+    think_filter_feed(&output.filter, data, size);
 }
 
 /********************
@@ -188,13 +627,16 @@ static void llm_response_callback( char * data, size_t size, void * user_data )
 void * llm_thread( void * arg UNUSED_PARAM ) {
     pthread_t llm_op_thread;
     llm_context_t context = {
-        .llm_stop_flag = &llm_stop_flag,
+        .llm_cancel = &llm_cancel,
         .llm_callback = llm_response_callback,
 
         .status = LLM_STATUS_NOT_STARTED
     };
 
     while(1) {
+        prefill_check_finished(&prefill, 
+            context.status == LLM_STATUS_NOT_STARTED);
+
         // Action based on actual operation status
         switch( context.status ) {
             case LLM_STATUS_NOT_STARTED:
@@ -206,6 +648,8 @@ void * llm_thread( void * arg UNUSED_PARAM ) {
             }
 
             case LLM_STATUS_FINISHED_OK: {
+                pthread_join(llm_op_thread, NULL);
+                session_reset_if_not_reused();
                 const char * status_msg = "\nLLM finished.\n";
                 llm_status_event_publish(status_msg, 
                     strlen(status_msg));
@@ -216,6 +660,8 @@ void * llm_thread( void * arg UNUSED_PARAM ) {
             }
 
             case LLM_STATUS_FINISHED_ERROR: {
+                pthread_join(llm_op_thread, NULL);
+                session_reset_if_not_reused();
                 const char * error_msg = "\nError: LLM failed.\n";
                 llm_status_event_publish(error_msg, 
                     strlen(error_msg));
@@ -230,7 +676,9 @@ void * llm_thread( void * arg UNUSED_PARAM ) {
 
         // Action based on incomming event
         event_t e = STRUCT_INIT_ALL_ZEROS;
-        if( broker_pop(COMPONENT_LLM, &e) == RES_OK ) {
+        bool busy = context.status != LLM_STATUS_NOT_STARTED || 
+            prefill.status != LLM_STATUS_NOT_STARTED;
+        if( broker_pop_timeout(COMPONENT_LLM, &e, broker_worker_wait_ms(busy)) == RES_OK ) {
             switch( e.type ) {
                 case EVENT_LLM_REQUEST: {
                     if( context.status != LLM_STATUS_NOT_STARTED ) {
@@ -264,12 +712,28 @@ void * llm_thread( void * arg UNUSED_PARAM ) {
 
                     copy_prompt_to_answer_file(context.prompt_filepath,
                         context.answer_filepath);
+                    prefill_clear(&prefill);
+                    // Covers session_reuse switched off by reload in between
+                    session_reset_if_not_reused();
 
                     const char * msg = "LLM start.\n";
                     llm_status_event_publish(msg, strlen(msg));
 
-                    llm_stop_flag = 0;
-                    pthread_create(&llm_op_thread, NULL, llm_operation_thread, &context);
+                    cancel_token_reset(&llm_cancel);
+                    atomic_store(&output.skip_think, false);
+
+                    // Status is set before the thread exists, so the loop 
+                    // keeps polling until the thread reports it finished
+                    context.status = LLM_STATUS_IN_PROGRESS;
+                    if( pthread_create(&llm_op_thread, NULL, llm_operation_thread, 
+                            &context) != 0 ) {
+                        const char * error_msg = "\nError: LLM failed.\n";
+                        llm_status_event_publish(error_msg, 
+                            strlen(error_msg));
+                        pipeline_failed_event_publish();
+                        llm_context_clear(&context);
+                        continue;
+                    }
 
                     break;
                 }
@@ -283,24 +747,74 @@ void * llm_thread( void * arg UNUSED_PARAM ) {
                         continue;
                     }
 
-                    llm_stop_flag = 1;
-                    pthread_join(llm_op_thread, NULL);
+                    // Transfer is aborted from curl poll loop, operation 
+                    // thread is joined once its status is reported
+                    cancel_token_cancel(&llm_cancel);
+                    cancel_token_cancel(&prefill_cancel);
                     
                     break;
                 }
 
+                case EVENT_LLM_SKIP_THINK: {
+                    if( context.status != LLM_STATUS_IN_PROGRESS ) {
+                        continue;
+                    }
+
+                    atomic_store(&output.skip_think, true);
+
+                    break;
+                }
+
+                case EVENT_LLM_SESSION_RESET: {
+                    if( context.status != LLM_STATUS_NOT_STARTED ) {
+                        continue;
+                    }
+
+                    backend->reset_session();
+
+                    break;
+                }
+
+                case EVENT_LLM_PREFILL: {
+                    if( context.status != LLM_STATUS_NOT_STARTED ) {
+                        continue;
+                    }
+
+                    char segment[EVENT_MAX_DATA_SIZE];
+                    snprintf(segment, sizeof(segment), "%.*s", 
+                        (int)e.data_size, e.data);
+                    prefill_append_segment(&prefill, segment);
+                    prefill_start_if_needed(&prefill);
+
+                    break;
+                }
+
                 default:
                     break;
             }
         }
-
-        usleep(30000);
     }
 
     return NULL;
 }
 
 result_t llm_init( void ) {
-    // TODO: add check if ollama service is alive 
-    return RES_OK;
+    config_t config;
+    config_get(&config);
+    backend = llm_backend_find(config.llm.backend);
+    if( !backend ) {
+        ERROR("LLM backend '%s' is not built in.", config.llm.backend);
+        return RES_ERR_GENERIC;
+    }
+    RETURN_ON_ERROR( backend->open() );
+
+    RETURN_ON_ERROR( cancel_token_init(&prefill_cancel) );
+
+    // Working without cache is fine, every answer is just generated
+    if( answer_cache_open(&answer_cache, ANSWER_CACHE_FILEPATH, 
+            (size_t)config.llm.answer_cache_max_kb * 1024) != RES_OK ) {
+        WARN("Answer cache disabled (can't open %s).", ANSWER_CACHE_FILEPATH);
+    }
+
+    return cancel_token_init(&llm_cancel);
 }
@@ -0,0 +1,46 @@
+/**
+ *******************************************************************************
+ * @file    llm_backend.c
+ * @brief   LLM backend interface source file.
+ *          Registry of backends compiled into the program.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <string.h>
+
+#include "utils.h"
+
+#include "llm_backend.h"
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static const llm_backend_t * const backends[] = {
+    &llm_backend_ollama,
+#ifdef WITH_LLAMA_CPP
+    &llm_backend_llama,
+#endif
+};
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+const llm_backend_t * llm_backend_find( const char * name ) {
+    if( !name ) {
+        return NULL;
+    }
+
+    for( size_t i = 0; i < NELEMS(backends); i++ ) {
+        if( strcmp(backends[i]->name, name) == 0 ) {
+            return backends[i];
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,78 @@
+/**
+ *******************************************************************************
+ * @file    llm_backend.h
+ * @brief   LLM backend interface header file.
+ *          Every inference engine (Ollama daemon, embedded llama.cpp) is 
+ *          accessed through the same table of operations.
+ *******************************************************************************
+ */
+
+#ifndef LLM_BACKEND_H
+#define LLM_BACKEND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/ 
+
+#include "utils.h"
+#include "cancel_token.h"
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef void (*llm_response_callback_t)(char * data, size_t size, 
+    void * user_data);
+
+typedef struct {
+    uint64_t prompt_tokens;         // Evaluated, without reused prefix
+    uint64_t generated_tokens;
+    uint64_t prompt_eval_us;
+    uint64_t generation_us;
+} llm_backend_stats_t;
+
+// Generation and prefill are stopped with the cancel token they were given
+typedef struct {
+    const char * name;
+
+    result_t (*open)( void );
+    void (*close)( void );
+
+    result_t (*generate)( const char * prompt, cancel_token_t * cancel,
+        llm_response_callback_t callback, void * user_data, 
+        llm_backend_stats_t * stats OUTPUT );
+    result_t (*prefill)( const char * prompt, cancel_token_t * cancel );
+
+    // Conversation kept between generate calls
+    void (*reset_session)( void );
+    bool (*has_session)( void );
+
+    // Everything that changes the answer for the same prompt
+    const char * (*model_name)( void );
+    const char * (*options_json)( void );
+} llm_backend_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern const llm_backend_t * llm_backend_find( const char * name );
+
+/********************
+ * GLOBAL VARIABLES *
+ ********************/
+
+extern const llm_backend_t llm_backend_ollama;
+#ifdef WITH_LLAMA_CPP
+extern const llm_backend_t llm_backend_llama;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LLM_BACKEND_H */
@@ -0,0 +1,433 @@
+/**
+ *******************************************************************************
+ * @file    llm_backend_llama.c
+ * @brief   Embedded llama.cpp LLM backend source file.
+ *          Model is mmapped from GGUF file and runs in-process, so there is
+ *          no HTTP/JSON round trip and KV cache is kept between questions.
+ *          Built only with WITH_LLAMA_CPP=1.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <llama.h>
+
+#include "utils.h"
+#include "config.h"
+
+#include "llm_backend.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define DEFAULT_LLAMA_BATCH_SIZE    512
+#define DEFAULT_LLAMA_TOP_P         0.95f
+
+#define MAX_PIECE_SIZE              256
+#define MAX_OPTIONS_JSON_SIZE       128
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct {
+    pthread_mutex_t lock;           // Prefill and generation share context
+    struct llama_model * model;
+    struct llama_context * ctx;
+    struct llama_sampler * sampler;
+    const struct llama_vocab * vocab;
+
+    double temperature;             // Sampler is rebuilt when it changes
+
+    llama_token * tokens;           // Mirror of KV cache contents
+    size_t n_tokens;
+    size_t n_committed;             // Part that belongs to finished answers
+    size_t max_tokens;
+
+    cancel_token_t * cancel;        // Checked by llama.cpp between ubatches
+    char model_path[CONFIG_MAX_PATH_SIZE];
+    char options_json[MAX_OPTIONS_JSON_SIZE];
+} llama_engine_t;
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static llama_engine_t engine = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static bool llama_abort_callback( void * data ) {
+    llama_engine_t * e = (llama_engine_t *)data;
+    return e->cancel && cancel_token_is_cancelled(e->cancel);
+}
+
+static void forget_tokens_from( size_t pos ) {
+    llama_memory_seq_rm(llama_get_memory(engine.ctx), 0, (llama_pos)pos, -1);
+    engine.n_tokens = pos;
+    if( engine.n_committed > pos ) {
+        engine.n_committed = pos;
+    }
+}
+
+static result_t format_turn( const char * prompt, char ** text OUTPUT ) {
+    const char * tmpl = llama_model_chat_template(engine.model, NULL);
+    if( !tmpl ) {
+        *text = strdup(prompt);
+        return *text ? RES_OK : RES_ERR_GENERIC;
+    }
+
+    // Only new question, earlier turns are already in KV cache
+    llama_chat_message message = { .role = "user", .content = prompt };
+    int32_t len = llama_chat_apply_template(tmpl, &message, 1, true, NULL, 0);
+    RETURN_ERROR_IF( len < 0, RES_ERR_GENERIC );
+
+    *text = malloc((size_t)len + 1);
+    RETURN_IF_NULL(*text);
+    llama_chat_apply_template(tmpl, &message, 1, true, *text, len + 1);
+    (*text)[len] = '\0';
+
+    return RES_OK;
+}
+
+static result_t tokenize_turn( const char * prompt,
+        llama_token ** tokens OUTPUT, size_t * n_tokens OUTPUT ) {
+    char * text = NULL;
+    RETURN_ON_ERROR( format_turn(prompt, &text) );
+
+    bool add_special = (engine.n_committed == 0);
+    int32_t text_len = (int32_t)strlen(text);
+    int32_t n = -llama_tokenize(engine.vocab, text, text_len, NULL, 0,
+        add_special, true);
+    if( n <= 0 ) {
+        free(text);
+        return RES_ERR_GENERIC;
+    }
+
+    *tokens = malloc((size_t)n * sizeof(llama_token));
+    if( !*tokens ) {
+        free(text);
+        return RES_ERR_GENERIC;
+    }
+    n = llama_tokenize(engine.vocab, text, text_len, *tokens, n,
+        add_special, true);
+    free(text);
+    if( n < 0 ) {
+        free(*tokens);
+        return RES_ERR_GENERIC;
+    }
+    *n_tokens = (size_t)n;
+
+    return RES_OK;
+}
+
+static result_t decode_tokens( size_t count ) {
+    // Tokens are already in mirror, cache catches up in batches
+    size_t end = engine.n_tokens + count;
+    while( engine.n_tokens < end ) {
+        size_t n = end - engine.n_tokens;
+        if( n > DEFAULT_LLAMA_BATCH_SIZE ) {
+            n = DEFAULT_LLAMA_BATCH_SIZE;
+        }
+
+        llama_batch batch = llama_batch_get_one(engine.tokens + engine.n_tokens,
+            (int32_t)n);
+        if( llama_decode(engine.ctx, batch) != 0 ) {
+            // Aborted or failed batch may be partially in cache
+            forget_tokens_from(engine.n_tokens);
+            return RES_ERR_GENERIC;
+        }
+        engine.n_tokens += n;
+    }
+
+    return RES_OK;
+}
+
+static result_t evaluate_prompt( const char * prompt, bool need_logits,
+        size_t * evaluated OUTPUT ) {
+    llama_token * turn = NULL;
+    size_t n_turn = 0;
+    RETURN_ON_ERROR( tokenize_turn(prompt, &turn, &n_turn) );
+
+    // Conversation doesn't fit anymore, start from scratch
+    if( engine.n_committed + n_turn + DEFAULT_LLAMA_BATCH_SIZE > engine.max_tokens &&
+            engine.n_committed > 0 ) {
+        WARN("LLM context full, conversation reset.");
+        free(turn);
+        forget_tokens_from(0);
+        RETURN_ON_ERROR( tokenize_turn(prompt, &turn, &n_turn) );
+    }
+    if( n_turn + DEFAULT_LLAMA_BATCH_SIZE > engine.max_tokens ) {
+        free(turn);
+        return RES_ERR_INVALID_SIZE;
+    }
+
+    // Prefix evaluated by earlier prefill is reused
+    size_t common = engine.n_committed;
+    size_t end = engine.n_committed + n_turn;
+    while( common < engine.n_tokens && common < end &&
+            engine.tokens[common] == turn[common - engine.n_committed] ) {
+        common++;
+    }
+    // Sampling needs logits of the last prompt token
+    if( need_logits && common == end ) {
+        common--;
+    }
+    forget_tokens_from(common);
+
+    memcpy(engine.tokens + common, turn + (common - engine.n_committed),
+        (end - common) * sizeof(llama_token));
+    free(turn);
+
+    *evaluated = end - common;
+    return decode_tokens(end - common);
+}
+
+static result_t update_sampler( double temperature ) {
+    if( engine.sampler && engine.temperature == temperature ) {
+        llama_sampler_reset(engine.sampler);
+        return RES_OK;
+    }
+
+    if( engine.sampler ) {
+        llama_sampler_free(engine.sampler);
+    }
+    engine.sampler = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    RETURN_IF_NULL(engine.sampler);
+    llama_sampler_chain_add(engine.sampler,
+        llama_sampler_init_top_p(DEFAULT_LLAMA_TOP_P, 1));
+    llama_sampler_chain_add(engine.sampler,
+        llama_sampler_init_temp((float)temperature));
+    llama_sampler_chain_add(engine.sampler,
+        llama_sampler_init_dist(LLAMA_DEFAULT_SEED));
+    engine.temperature = temperature;
+
+    return RES_OK;
+}
+
+static result_t generate_answer( size_t max_generated, cancel_token_t * cancel,
+        llm_response_callback_t callback, void * user_data,
+        size_t * generated OUTPUT ) {
+    char piece[MAX_PIECE_SIZE];
+    *generated = 0;
+
+    while( *generated < max_generated &&
+            engine.n_tokens < engine.max_tokens ) {
+        RETURN_ERROR_IF( cancel_token_is_cancelled(cancel), RES_ERR_GENERIC );
+
+        llama_token token = llama_sampler_sample(engine.sampler, engine.ctx, -1);
+        bool eog = llama_vocab_is_eog(engine.vocab, token);
+        if( !eog ) {
+            int32_t len = llama_token_to_piece(engine.vocab, token, piece,
+                (int32_t)sizeof(piece), 0, false);
+            if( len > 0 ) {
+                callback(piece, (size_t)len, user_data);
+            }
+        }
+
+        // End token is kept too, so next turn follows finished answer
+        engine.tokens[engine.n_tokens] = token;
+        RETURN_ON_ERROR( decode_tokens(1) );
+        (*generated)++;
+
+        if( eog ) {
+            break;
+        }
+    }
+
+    return RES_OK;
+}
+
+static void llama_backend_close( void ) {
+    pthread_mutex_lock(&engine.lock);
+    if( engine.sampler ) {
+        llama_sampler_free(engine.sampler);
+    }
+    if( engine.ctx ) {
+        llama_free(engine.ctx);
+    }
+    if( engine.model ) {
+        llama_model_free(engine.model);
+    }
+    free(engine.tokens);
+
+    engine.sampler = NULL;
+    engine.ctx = NULL;
+    engine.model = NULL;
+    engine.tokens = NULL;
+    engine.n_tokens = 0;
+    engine.n_committed = 0;
+    pthread_mutex_unlock(&engine.lock);
+
+    llama_backend_free();
+}
+
+static result_t llama_backend_open( void ) {
+    config_t config;
+    config_get(&config);
+    snprintf(engine.model_path, sizeof(engine.model_path), "%s", 
+        config.llm.llama_model);
+
+    llama_backend_init();
+
+    struct llama_model_params model_params = llama_model_default_params();
+    model_params.use_mmap = true;           // Pages are shared with page cache
+    model_params.n_gpu_layers = 0;
+    engine.model = llama_model_load_from_file(engine.model_path, model_params);
+    if( !engine.model ) {
+        ERROR("Can't load LLM model %s.", engine.model_path);
+        llama_backend_free();
+        return RES_ERR_GENERIC;
+    }
+    engine.vocab = llama_model_get_vocab(engine.model);
+
+    struct llama_context_params ctx_params = llama_context_default_params();
+    ctx_params.n_ctx = config.llm.llama_ctx_size;
+    ctx_params.n_batch = DEFAULT_LLAMA_BATCH_SIZE;
+    ctx_params.n_threads = (int32_t)config.llm.llama_threads;
+    ctx_params.n_threads_batch = (int32_t)config.llm.llama_threads;
+    ctx_params.abort_callback = llama_abort_callback;
+    ctx_params.abort_callback_data = &engine;
+    engine.ctx = llama_init_from_model(engine.model, ctx_params);
+    engine.max_tokens = engine.ctx ? llama_n_ctx(engine.ctx) : 0;
+    engine.tokens = malloc(engine.max_tokens * sizeof(llama_token));
+
+    if( !engine.ctx || !engine.tokens || update_sampler(config.llm.temperature) != RES_OK ) {
+        ERROR("Can't create LLM context.");
+        llama_backend_close();
+        return RES_ERR_GENERIC;
+    }
+
+    return RES_OK;
+}
+
+static result_t llama_backend_generate( const char * prompt,
+        cancel_token_t * cancel, llm_response_callback_t callback,
+        void * user_data, llm_backend_stats_t * stats OUTPUT ) {
+    RETURN_IF_NULL(prompt);
+    RETURN_IF_NULL(cancel);
+    RETURN_IF_NULL(callback);
+    RETURN_IF_NULL(engine.ctx);
+
+    // Sampling settings may change with config reload
+    config_t config;
+    config_get(&config);
+
+    pthread_mutex_lock(&engine.lock);
+    engine.cancel = cancel;
+
+    size_t evaluated = 0;
+    size_t generated = 0;
+    uint64_t start_us = get_current_time_us();
+    result_t res = evaluate_prompt(prompt, true, &evaluated);
+    uint64_t prompt_done_us = get_current_time_us();
+    size_t prompt_end = engine.n_tokens;
+    if( res == RES_OK ) {
+        res = update_sampler(config.llm.temperature);
+    }
+    if( res == RES_OK ) {
+        res = generate_answer(config.llm.max_answer_tokens, cancel, callback, 
+            user_data, &generated);
+    }
+    uint64_t end_us = get_current_time_us();
+
+    // Interrupted answer doesn't extend the conversation, prompt stays
+    // in cache as prefix for the next try
+    if( res == RES_OK ) {
+        engine.n_committed = engine.n_tokens;
+    } else if( engine.n_tokens > prompt_end ) {
+        forget_tokens_from(prompt_end);
+    }
+
+    engine.cancel = NULL;
+    pthread_mutex_unlock(&engine.lock);
+
+    if( stats ) {
+        stats->prompt_tokens = evaluated;
+        stats->generated_tokens = generated;
+        stats->prompt_eval_us = prompt_done_us - start_us;
+        stats->generation_us = end_us - prompt_done_us;
+    }
+
+    return res;
+}
+
+static result_t llama_backend_prefill( const char * prompt,
+        cancel_token_t * cancel ) {
+    RETURN_IF_NULL(prompt);
+    RETURN_IF_NULL(cancel);
+    RETURN_IF_NULL(engine.ctx);
+
+    pthread_mutex_lock(&engine.lock);
+    engine.cancel = cancel;
+
+    size_t evaluated = 0;
+    result_t res = evaluate_prompt(prompt, false, &evaluated);
+
+    engine.cancel = NULL;
+    pthread_mutex_unlock(&engine.lock);
+
+    return res;
+}
+
+static void llama_backend_reset_session( void ) {
+    pthread_mutex_lock(&engine.lock);
+    if( engine.ctx ) {
+        llama_memory_clear(llama_get_memory(engine.ctx), true);
+    }
+    engine.n_tokens = 0;
+    engine.n_committed = 0;
+    pthread_mutex_unlock(&engine.lock);
+}
+
+static bool llama_backend_has_session( void ) {
+    pthread_mutex_lock(&engine.lock);
+    bool has_session = engine.n_committed > 0;
+    pthread_mutex_unlock(&engine.lock);
+
+    return has_session;
+}
+
+static const char * llama_backend_model_name( void ) {
+    return engine.model_path;
+}
+
+static const char * llama_backend_options_json( void ) {
+    // Only called by LLM operation thread
+    config_t config;
+    config_get(&config);
+    snprintf(engine.options_json, sizeof(engine.options_json),
+        "{\"num_predict\":%u,\"temperature\":%g,\"top_p\":%g,\"num_ctx\":%zu}",
+        config.llm.max_answer_tokens, config.llm.temperature,
+        (double)DEFAULT_LLAMA_TOP_P, engine.max_tokens);
+
+    return engine.options_json;
+}
+
+/********************
+ * GLOBAL VARIABLES *
+ ********************/
+
+const llm_backend_t llm_backend_llama = {
+    .name = "llama",
+    .open = llama_backend_open,
+    .close = llama_backend_close,
+    .generate = llama_backend_generate,
+    .prefill = llama_backend_prefill,
+    .reset_session = llama_backend_reset_session,
+    .has_session = llama_backend_has_session,
+    .model_name = llama_backend_model_name,
+    .options_json = llama_backend_options_json,
+};
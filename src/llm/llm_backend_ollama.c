@@ -0,0 +1,82 @@
+/**
+ *******************************************************************************
+ * @file    llm_backend_ollama.c
+ * @brief   Ollama LLM backend source file.
+ *          Model runs in separate daemon, accessed with HTTP API.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include "utils.h"
+
+#include "llm_backend.h"
+#include "ollama_api_ops.h"
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static ollama_session_t session = OLLAMA_SESSION_INIT;
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static result_t ollama_backend_open( void ) {
+    // TODO: add check if ollama service is alive 
+    return ollama_init();
+}
+
+static void ollama_backend_close( void ) {
+    ollama_session_reset(&session);
+}
+
+static result_t ollama_backend_generate( const char * prompt, 
+        cancel_token_t * cancel, llm_response_callback_t callback, 
+        void * user_data, llm_backend_stats_t * stats OUTPUT ) {
+    ollama_stats_t ollama_stats = STRUCT_INIT_ALL_ZEROS;
+    // Options come from config
+    RETURN_ON_ERROR( ollama_generate(prompt, &session, NULL, cancel, callback, 
+        user_data, &ollama_stats) );
+
+    if( stats ) {
+        stats->prompt_tokens = ollama_stats.prompt_eval_count;
+        stats->generated_tokens = ollama_stats.eval_count;
+        stats->prompt_eval_us = ollama_stats.prompt_eval_duration_ns / 1000;
+        stats->generation_us = ollama_stats.eval_duration_ns / 1000;
+    }
+
+    return RES_OK;
+}
+
+static result_t ollama_backend_prefill( const char * prompt, 
+        cancel_token_t * cancel ) {
+    return ollama_prefill(prompt, &session, cancel);
+}
+
+static void ollama_backend_reset_session( void ) {
+    ollama_session_reset(&session);
+}
+
+static bool ollama_backend_has_session( void ) {
+    return ollama_session_has_context(&session);
+}
+
+/********************
+ * GLOBAL VARIABLES *
+ ********************/
+
+const llm_backend_t llm_backend_ollama = {
+    .name = "ollama",
+    .open = ollama_backend_open,
+    .close = ollama_backend_close,
+    .generate = ollama_backend_generate,
+    .prefill = ollama_backend_prefill,
+    .reset_session = ollama_backend_reset_session,
+    .has_session = ollama_backend_has_session,
+    .model_name = ollama_model_name,
+    .options_json = ollama_generate_options_json,
+};
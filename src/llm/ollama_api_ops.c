@@ -18,16 +18,18 @@
 #include <cjson/cJSON.h>
 
 #include "utils.h"
+#include "cancel_token.h"
+#include "config.h"
 
 #include "ollama_api_ops.h"
+#include "ollama_request.h"
 
 /******************************
  * PRIVATE MACROS AND DEFINES *
  ******************************/
 
 #define READ_BUFFER_SIZE_BYTES      4096
-#define DEFAULT_DEEPSEEK_MODEL      "deepseek-r1:1.5b"
-#define DEFAULT_OLLAMA_URL          "http://localhost:11434/api/generate"
+#define CURL_MULTI_POLL_TIMEOUT_MS  1000
 
 /********************
  * PRIVATE TYPEDEFS *
@@ -36,21 +38,108 @@
 typedef struct {
     char * data;
     size_t size;
-    volatile int * stop_flag;
+    cancel_token_t * cancel;
     void * user_data;
 
+    int * context;          // From final "done" message, moved to session
+    size_t context_len;
+    ollama_stats_t stats;
+
     response_callback_t callback;
 } ollama_response_data_t;
 
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+// Structural settings, copied once from config
+static char ollama_url[CONFIG_MAX_PATH_SIZE];
+static char ollama_model[CONFIG_MAX_NAME_SIZE];
+
+static ollama_request_t request = OLLAMA_REQUEST_INIT;
+
+// Only used by operation thread of LLM (for answer cache key)
+static char options_json[OLLAMA_MAX_OPTIONS_SIZE];
+
 /********************
  * STATIC FUNCTIONS *
  ********************/
 
+static uint64_t json_get_u64( cJSON * json, const char * key ) {
+    cJSON * item = cJSON_GetObjectItemCaseSensitive(json, key);
+    return (cJSON_IsNumber(item) && item->valuedouble > 0) ? 
+        (uint64_t)item->valuedouble : 0;
+}
+
+static void handle_done_message( ollama_response_data_t * resp, cJSON * json ) {
+    cJSON * done = cJSON_GetObjectItemCaseSensitive(json, "done");
+    if( !cJSON_IsTrue(done) ) {
+        return;
+    }
+
+    resp->stats.prompt_eval_count = json_get_u64(json, "prompt_eval_count");
+    resp->stats.prompt_eval_duration_ns = json_get_u64(json, "prompt_eval_duration");
+    resp->stats.eval_count = json_get_u64(json, "eval_count");
+    resp->stats.eval_duration_ns = json_get_u64(json, "eval_duration");
+
+    cJSON * context = cJSON_GetObjectItemCaseSensitive(json, "context");
+    if( !cJSON_IsArray(context) ) {
+        return;
+    }
+
+    int len = cJSON_GetArraySize(context);
+    int * tokens = (len > 0) ? malloc((size_t)len * sizeof(int)) : NULL;
+    if( !tokens ) {
+        return;
+    }
+
+    size_t i = 0;
+    cJSON * token = NULL;
+    cJSON_ArrayForEach(token, context) {
+        if( i < (size_t)len && cJSON_IsNumber(token) ) {
+            tokens[i++] = token->valueint;
+        }
+    }
+
+    free(resp->context);
+    resp->context = tokens;
+    resp->context_len = i;
+}
+
+static char * build_request_body( const char * prompt, 
+        ollama_session_t * session, const ollama_options_t * overrides ) {
+    config_t config;
+    config_get(&config);
+
+    pthread_mutex_lock(&session->lock);
+    char * body = ollama_request_build(&request, &config, overrides, prompt, 
+        session->context, session->context_len);
+    pthread_mutex_unlock(&session->lock);
+
+    return body;
+}
+
+static void update_session_context( ollama_session_t * session, 
+        ollama_response_data_t * resp ) {
+    if( !resp->context ) {
+        return;
+    }
+
+    pthread_mutex_lock(&session->lock);
+    free(session->context);
+    session->context = resp->context;
+    session->context_len = resp->context_len;
+    pthread_mutex_unlock(&session->lock);
+
+    resp->context = NULL;
+    resp->context_len = 0;
+}
+
 static size_t ollama_write_callback( char * ptr, size_t size, size_t nmemb, 
         void * user_data ) {
     size_t total_size = size * nmemb;
     ollama_response_data_t *resp = (ollama_response_data_t *)user_data;
-    if( *(resp->stop_flag) ) {
+    if( cancel_token_is_cancelled(resp->cancel) ) {
         return 0;
     }
 
@@ -75,6 +164,7 @@ static size_t ollama_write_callback( char * ptr, size_t size, size_t nmemb,
                 resp->callback(response->valuestring, strlen(response->valuestring), 
                     resp->user_data);
             }
+            handle_done_message(resp, json);
             cJSON_Delete(json);
         }
         line_start = newline_pos + 1;
@@ -88,41 +178,101 @@ static size_t ollama_write_callback( char * ptr, size_t size, size_t nmemb,
     return total_size;
 }
 
-/********************
- * GLOBAL FUNCTIONS *
- ********************/
+static size_t ollama_discard_callback( char * ptr UNUSED_PARAM, size_t size, 
+        size_t nmemb, void * user_data ) {
+    ollama_response_data_t * resp = (ollama_response_data_t *)user_data;
+    if( cancel_token_is_cancelled(resp->cancel) ) {
+        return 0;
+    }
+    return size * nmemb;
+}
+
+// Aborts transfer also when no data is flowing (e.g. model still loading)
+static int ollama_xferinfo_callback( void * user_data, 
+        curl_off_t dltotal UNUSED_PARAM, curl_off_t dlnow UNUSED_PARAM, 
+        curl_off_t ultotal UNUSED_PARAM, curl_off_t ulnow UNUSED_PARAM ) {
+    ollama_response_data_t * resp = (ollama_response_data_t *)user_data;
+    return cancel_token_is_cancelled(resp->cancel) ? 1 : 0;
+}
+
+// Runs transfer in multi interface, waking up immediately on cancellation
+static result_t perform_cancellable( CURL * curl, cancel_token_t * cancel ) {
+    CURLM * multi = curl_multi_init();
+    RETURN_IF_NULL(multi);
 
-result_t ollama_ask_deepseek_model( 
-        const char * answer_filepath, const char * prompt_filepath, 
-        volatile int * stop_flag, response_callback_t callback ) {
-    RETURN_IF_NULL(answer_filepath);
-    RETURN_IF_NULL(prompt_filepath);
-    RETURN_IF_NULL(stop_flag);
-
-    char * prompt = NULL;
-    long prompt_length = 0;
-    FILE * prompt_file = fopen(prompt_filepath, "rb");
-    if( !prompt_file ) {
+    if( curl_multi_add_handle(multi, curl) != CURLM_OK ) {
+        curl_multi_cleanup(multi);
         return RES_ERR_GENERIC;
     }
-    fseek(prompt_file, 0, SEEK_END);
-    prompt_length = ftell(prompt_file);
-    fseek(prompt_file, 0, SEEK_SET);
-    prompt = malloc((size_t)prompt_length + 1);
-    if( !prompt ) {
-        fclose(prompt_file);
-        return RES_ERR_GENERIC;
+
+    struct curl_waitfd cancel_fd = {
+        .fd = cancel_token_fd(cancel),
+        .events = CURL_WAIT_POLLIN,
+        .revents = 0
+    };
+
+    result_t result = RES_OK;
+    int still_running = 1;
+    while( still_running ) {
+        if( curl_multi_perform(multi, &still_running) != CURLM_OK ) {
+            result = RES_ERR_GENERIC;
+            break;
+        }
+        if( !still_running ) {
+            break;
+        }
+
+        if( curl_multi_poll(multi, &cancel_fd, 1, 
+                CURL_MULTI_POLL_TIMEOUT_MS, NULL) != CURLM_OK ) {
+            result = RES_ERR_GENERIC;
+            break;
+        }
+        if( cancel_token_is_cancelled(cancel) ) {
+            result = RES_ERR_GENERIC;
+            break;
+        }
     }
-    size_t read_size = fread(prompt, 1, (size_t)prompt_length, prompt_file);
-    prompt[read_size] = '\0';
-    fclose(prompt_file);
 
-    cJSON * root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "model", DEFAULT_DEEPSEEK_MODEL);
-    cJSON_AddStringToObject(root, "prompt", prompt);
-    char * post_data = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
-    free(prompt);
+    if( result == RES_OK ) {
+        int msgs_left = 0;
+        CURLMsg * msg = NULL;
+        while( (msg = curl_multi_info_read(multi, &msgs_left)) != NULL ) {
+            if( msg->msg == CURLMSG_DONE && msg->data.result != CURLE_OK ) {
+                result = RES_ERR_GENERIC;
+            }
+        }
+    }
+
+    curl_multi_remove_handle(multi, curl);
+    curl_multi_cleanup(multi);
+
+    return result;
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t ollama_init( void ) {
+    config_t config;
+    config_get(&config);
+    snprintf(ollama_url, sizeof(ollama_url), "%s", config.llm.ollama_url);
+    snprintf(ollama_model, sizeof(ollama_model), "%s", config.llm.ollama_model);
+
+    return ollama_request_init(&request, ollama_model);
+}
+
+result_t ollama_generate( const char * prompt, ollama_session_t * session, 
+        const ollama_options_t * overrides, cancel_token_t * cancel, 
+        response_callback_t callback, void * user_data, 
+        ollama_stats_t * stats OUTPUT ) {
+    RETURN_IF_NULL(prompt);
+    RETURN_IF_NULL(session);
+    RETURN_IF_NULL(cancel);
+    RETURN_IF_NULL(callback);
+
+    char * post_data = build_request_body(prompt, session, overrides);
+    RETURN_IF_NULL(post_data);
 
     CURL * curl = curl_easy_init();
     if( !curl ) {
@@ -130,43 +280,125 @@ result_t ollama_ask_deepseek_model(
         return RES_ERR_GENERIC;
     }
 
-    FILE * output_file = fopen(answer_filepath, "a+");
-    if( !output_file ) {
-        free(post_data);
-        curl_easy_cleanup(curl);
-        return RES_ERR_GENERIC;
-    }
-    
     ollama_response_data_t resp;
     memset(&resp, 0, sizeof(ollama_response_data_t));
     resp.callback = callback;
-    resp.user_data = output_file;
-    resp.stop_flag = stop_flag;
-    curl_easy_setopt(curl, CURLOPT_URL, DEFAULT_OLLAMA_URL);
+    resp.user_data = user_data;
+    resp.cancel = cancel;
+    curl_easy_setopt(curl, CURLOPT_URL, ollama_url);
     curl_easy_setopt(curl, CURLOPT_POST, 1L);
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, ollama_write_callback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&resp);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, ollama_xferinfo_callback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, (void *)&resp);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "libcurl-agent/1.0");
     struct curl_slist *headers = NULL;
     headers = curl_slist_append(headers, "Content-Type: application/json");
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-    CURLcode res = curl_easy_perform(curl);
-    if( res != CURLE_OK ) {
-        fclose(output_file);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+    result_t res = perform_cancellable(curl, cancel);
+    if( res == RES_OK ) {
+        // Interrupted answer doesn't extend the conversation
+        update_session_context(session, &resp);
+        if( stats ) {
+            *stats = resp.stats;
+        }
+    }
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    free(post_data);
+    free(resp.data);
+    free(resp.context);
+
+    return res;
+}
+
+result_t ollama_prefill( const char * prompt, 
+        ollama_session_t * session, cancel_token_t * cancel ) {
+    RETURN_IF_NULL(prompt);
+    RETURN_IF_NULL(session);
+    RETURN_IF_NULL(cancel);
+
+    // Nothing is generated, only the prompt is evaluated, so KV cache of 
+    // the runner holds it when the real request with the same prefix comes.
+    // Other options must be the same, or the runner would be reloaded.
+    const ollama_options_t prefill_options = {
+        .has_num_predict = true,
+        .num_predict = 0
+    };
+    char * post_data = build_request_body(prompt, session, &prefill_options);
+    RETURN_IF_NULL(post_data);
+
+    CURL * curl = curl_easy_init();
+    if( !curl ) {
         free(post_data);
-        free(resp.data);
         return RES_ERR_GENERIC;
     }
 
+    ollama_response_data_t resp;
+    memset(&resp, 0, sizeof(ollama_response_data_t));
+    resp.cancel = cancel;
+    curl_easy_setopt(curl, CURLOPT_URL, ollama_url);
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, ollama_discard_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&resp);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, ollama_xferinfo_callback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, (void *)&resp);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "libcurl-agent/1.0");
+    struct curl_slist *headers = NULL;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    result_t res = perform_cancellable(curl, cancel);
+
     curl_slist_free_all(headers);
     curl_easy_cleanup(curl);
     free(post_data);
-    free(resp.data);
-    fclose(output_file);
 
-    return RES_OK;
+    return res;
+}
+
+void ollama_session_reset( ollama_session_t * session ) {
+    if( !session ) {
+        return;
+    }
+
+    pthread_mutex_lock(&session->lock);
+    free(session->context);
+    session->context = NULL;
+    session->context_len = 0;
+    pthread_mutex_unlock(&session->lock);
+}
+
+bool ollama_session_has_context( ollama_session_t * session ) {
+    if( !session ) {
+        return false;
+    }
+
+    pthread_mutex_lock(&session->lock);
+    bool has_context = session->context_len > 0;
+    pthread_mutex_unlock(&session->lock);
+
+    return has_context;
+}
+
+const char * ollama_model_name( void ) {
+    return ollama_model;
+}
+
+const char * ollama_generate_options_json( void ) {
+    // Options may change with config reload
+    config_t config;
+    config_get(&config);
+    if( ollama_request_options_json(&config, NULL, options_json, 
+            sizeof(options_json)) != RES_OK ) {
+        return "{}";
+    }
+
+    return options_json;
 }
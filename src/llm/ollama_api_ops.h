@@ -16,22 +16,61 @@ extern "C" {
  * INCLUDES *
  ************/ 
 
+#include <pthread.h>
+
 #include "utils.h"
+#include "cancel_token.h"
+#include "ollama_request.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define OLLAMA_SESSION_INIT { \
+    .lock = PTHREAD_MUTEX_INITIALIZER, \
+    .context = NULL, \
+    .context_len = 0 \
+}
 
 /************
  * TYPEDEFS *
  ************/
 
+// Conversation state kept between requests (Ollama "context" tokens)
+typedef struct {
+    pthread_mutex_t lock;
+    int * context;
+    size_t context_len;
+} ollama_session_t;
+
 typedef void (*response_callback_t)(char * data, size_t size, 
     void * user_data);
 
+// Counters from the final "done" message
+typedef struct {
+    uint64_t prompt_eval_count;
+    uint64_t prompt_eval_duration_ns;
+    uint64_t eval_count;
+    uint64_t eval_duration_ns;
+} ollama_stats_t;
+
 /******************************
  * GLOBAL FUNCTION PROTOTYPES *
  ******************************/
 
-extern result_t ollama_ask_deepseek_model( 
-    const char * answer_filepath, const char * prompt_filepath,
-    volatile int * stop_flag, response_callback_t callback );
+extern result_t ollama_init( void );
+extern result_t ollama_generate( const char * prompt, ollama_session_t * session, 
+    const ollama_options_t * overrides, cancel_token_t * cancel, 
+    response_callback_t callback, void * user_data, 
+    ollama_stats_t * stats OUTPUT );
+extern result_t ollama_prefill( const char * prompt, 
+    ollama_session_t * session, cancel_token_t * cancel );
+
+extern void ollama_session_reset( ollama_session_t * session );
+extern bool ollama_session_has_context( ollama_session_t * session );
+
+extern const char * ollama_model_name( void );
+extern const char * ollama_generate_options_json( void );
 
 #ifdef __cplusplus
 }
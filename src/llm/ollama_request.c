@@ -0,0 +1,242 @@
+/**
+ *******************************************************************************
+ * @file    ollama_request.c
+ * @brief   Ollama request body builder source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+#include "config.h"
+
+#include "ollama_request.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define OLLAMA_KEEP_ALIVE           "5m"
+#define MAX_INT_JSON_SIZE           12      // "-2147483648,"
+#define REQUEST_TAIL               "\",\"context\":[]}"
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static size_t json_escaped_size( const char * str ) {
+    size_t size = 0;
+    for( const unsigned char * p = (const unsigned char *)str; *p; p++ ) {
+        switch( *p ) {
+            case '"': case '\\': case '\n': case '\r': case '\t': case '\b': case '\f':
+                size += 2;
+                break;
+            default:
+                size += (*p < 0x20) ? 6 : 1;
+                break;
+        }
+    }
+
+    return size;
+}
+
+static char * json_escape_to( char * dst, const char * str ) {
+    static const char hex[] = "0123456789abcdef";
+
+    // UTF-8 is passed as is, only quotes, backslash and controls are escaped
+    for( const unsigned char * p = (const unsigned char *)str; *p; p++ ) {
+        char escaped = 0;
+        switch( *p ) {
+            case '"':  escaped = '"';  break;
+            case '\\': escaped = '\\'; break;
+            case '\n': escaped = 'n';  break;
+            case '\r': escaped = 'r';  break;
+            case '\t': escaped = 't';  break;
+            case '\b': escaped = 'b';  break;
+            case '\f': escaped = 'f';  break;
+            default: break;
+        }
+
+        if( escaped ) {
+            *dst++ = '\\';
+            *dst++ = escaped;
+        } else if( *p < 0x20 ) {
+            memcpy(dst, "\\u00", 4);
+            dst[4] = hex[*p >> 4];
+            dst[5] = hex[*p & 0x0F];
+            dst += 6;
+        } else {
+            *dst++ = (char)*p;
+        }
+    }
+
+    return dst;
+}
+
+static void resolve_options( const config_t * config,
+        const ollama_options_t * overrides,
+        ollama_resolved_options_t * options OUTPUT ) {
+    // Compared as memory, so padding must be zeroed too
+    memset(options, 0, sizeof(ollama_resolved_options_t));
+    options->num_thread = config->llm.ollama_num_thread;
+    options->num_ctx = config->llm.ollama_num_ctx;
+    options->num_predict = (int)config->llm.max_answer_tokens;
+    options->temperature = config->llm.temperature;
+
+    if( overrides && overrides->has_num_predict ) {
+        options->num_predict = overrides->num_predict;
+    }
+    if( overrides && overrides->has_temperature ) {
+        options->temperature = overrides->temperature;
+    }
+}
+
+static int format_options( const ollama_resolved_options_t * options,
+        char * json OUTPUT, size_t json_size ) {
+    char num_thread[32] = "";
+    char num_ctx[32] = "";
+    if( options->num_thread > 0 ) {
+        snprintf(num_thread, sizeof(num_thread), "\"num_thread\":%u,",
+            options->num_thread);
+    }
+    if( options->num_ctx > 0 ) {
+        snprintf(num_ctx, sizeof(num_ctx), "\"num_ctx\":%u,", options->num_ctx);
+    }
+
+    return snprintf(json, json_size, "{%s%s\"num_predict\":%d,\"temperature\":%g}",
+        num_thread, num_ctx, options->num_predict, options->temperature);
+}
+
+static result_t build_template( const char * model,
+        const ollama_resolved_options_t * options,
+        ollama_request_template_t * template OUTPUT ) {
+    char options_json[OLLAMA_MAX_OPTIONS_SIZE];
+    int len = format_options(options, options_json, sizeof(options_json));
+    RETURN_ERROR_IF( len < 0 || (size_t)len >= sizeof(options_json),
+        RES_ERR_INVALID_SIZE );
+
+    char escaped_model[2 * CONFIG_MAX_NAME_SIZE];
+    RETURN_ERROR_IF( json_escaped_size(model) >= sizeof(escaped_model),
+        RES_ERR_INVALID_SIZE );
+    *json_escape_to(escaped_model, model) = '\0';
+
+    len = snprintf(template->text, sizeof(template->text),
+        "{\"model\":\"%s\",\"keep_alive\":\"" OLLAMA_KEEP_ALIVE "\","
+        "\"options\":%s,\"prompt\":\"", escaped_model, options_json);
+    RETURN_ERROR_IF( len < 0 || (size_t)len >= sizeof(template->text),
+        RES_ERR_INVALID_SIZE );
+
+    template->options = *options;
+    template->len = (size_t)len;
+    template->valid = true;
+
+    return RES_OK;
+}
+
+static result_t copy_template( ollama_request_t * request,
+        const ollama_resolved_options_t * options,
+        char * text OUTPUT, size_t * len OUTPUT ) {
+    result_t res = RES_OK;
+
+    pthread_mutex_lock(&request->lock);
+    ollama_request_template_t * template = NULL;
+    for( size_t i = 0; i < OLLAMA_REQUEST_TEMPLATES; i++ ) {
+        ollama_request_template_t * t = &request->templates[i];
+        if( t->valid && memcmp(&t->options, options, sizeof(*options)) == 0 ) {
+            template = t;
+            break;
+        }
+    }
+
+    // Options changed (other request kind or config reload)
+    if( !template ) {
+        template = &request->templates[request->next_slot];
+        request->next_slot = (request->next_slot + 1) % OLLAMA_REQUEST_TEMPLATES;
+        res = build_template(request->model, options, template);
+    }
+
+    if( res == RES_OK ) {
+        memcpy(text, template->text, template->len);
+        *len = template->len;
+    }
+    pthread_mutex_unlock(&request->lock);
+
+    return res;
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t ollama_request_init( ollama_request_t * request, const char * model ) {
+    RETURN_IF_NULL(request);
+    RETURN_IF_NULL(model);
+    RETURN_ERROR_IF( strlen(model) >= sizeof(request->model), RES_ERR_INVALID_SIZE );
+
+    pthread_mutex_lock(&request->lock);
+    snprintf(request->model, sizeof(request->model), "%s", model);
+    for( size_t i = 0; i < OLLAMA_REQUEST_TEMPLATES; i++ ) {
+        request->templates[i].valid = false;
+    }
+    request->next_slot = 0;
+    pthread_mutex_unlock(&request->lock);
+
+    return RES_OK;
+}
+
+result_t ollama_request_options_json( const config_t * config,
+        const ollama_options_t * overrides, char * json OUTPUT, size_t json_size ) {
+    RETURN_IF_NULL(config);
+    RETURN_IF_NULL(json);
+
+    ollama_resolved_options_t options;
+    resolve_options(config, overrides, &options);
+    int len = format_options(&options, json, json_size);
+    RETURN_ERROR_IF( len < 0 || (size_t)len >= json_size, RES_ERR_INVALID_SIZE );
+
+    return RES_OK;
+}
+
+char * ollama_request_build( ollama_request_t * request,
+        const config_t * config, const ollama_options_t * overrides,
+        const char * prompt, const int * context, size_t context_len ) {
+    if( !request || !config || !prompt || (!context && context_len > 0) ) {
+        return NULL;
+    }
+
+    ollama_resolved_options_t options;
+    resolve_options(config, overrides, &options);
+
+    size_t size = OLLAMA_MAX_TEMPLATE_SIZE + json_escaped_size(prompt) +
+        context_len * MAX_INT_JSON_SIZE + sizeof(REQUEST_TAIL);
+    char * body = malloc(size);
+    if( !body ) {
+        return NULL;
+    }
+
+    size_t len = 0;
+    if( copy_template(request, &options, body, &len) != RES_OK ) {
+        free(body);
+        return NULL;
+    }
+
+    char * p = json_escape_to(body + len, prompt);
+    *p++ = '"';
+    if( context_len > 0 ) {
+        p += sprintf(p, ",\"context\":[");
+        for( size_t i = 0; i < context_len; i++ ) {
+            p += sprintf(p, (i > 0) ? ",%d" : "%d", context[i]);
+        }
+        *p++ = ']';
+    }
+    *p++ = '}';
+    *p = '\0';
+
+    return body;
+}
@@ -0,0 +1,90 @@
+/**
+ *******************************************************************************
+ * @file    ollama_request.h
+ * @brief   Ollama request body builder header file.
+ *          Everything except prompt and context is serialized once into
+ *          a template, which is reused while generation options don't change.
+ *******************************************************************************
+ */
+
+#ifndef OLLAMA_REQUEST_H
+#define OLLAMA_REQUEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <pthread.h>
+
+#include "utils.h"
+#include "config.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define OLLAMA_REQUEST_TEMPLATES    2       // Generation and prefill
+#define OLLAMA_MAX_TEMPLATE_SIZE    512
+#define OLLAMA_MAX_OPTIONS_SIZE     192
+
+#define OLLAMA_REQUEST_INIT { \
+    .lock = PTHREAD_MUTEX_INITIALIZER, \
+    .model = "", \
+    .next_slot = 0 \
+}
+
+/************
+ * TYPEDEFS *
+ ************/
+
+// Per-request changes of options from config. Thread count and context
+// size are not here, as changing them makes Ollama reload the model.
+typedef struct {
+    bool has_num_predict;
+    int num_predict;
+    bool has_temperature;
+    double temperature;
+} ollama_options_t;
+
+typedef struct {
+    unsigned int num_thread;        // 0 leaves server default
+    unsigned int num_ctx;           // 0 leaves server default
+    int num_predict;
+    double temperature;
+} ollama_resolved_options_t;
+
+typedef struct {
+    bool valid;
+    ollama_resolved_options_t options;
+    char text[OLLAMA_MAX_TEMPLATE_SIZE];    // Up to opening quote of prompt
+    size_t len;
+} ollama_request_template_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    char model[CONFIG_MAX_NAME_SIZE];
+    ollama_request_template_t templates[OLLAMA_REQUEST_TEMPLATES];
+    size_t next_slot;
+} ollama_request_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t ollama_request_init( ollama_request_t * request,
+    const char * model );
+extern result_t ollama_request_options_json( const config_t * config,
+    const ollama_options_t * overrides, char * json OUTPUT, size_t json_size );
+extern char * ollama_request_build( ollama_request_t * request,
+    const config_t * config, const ollama_options_t * overrides,
+    const char * prompt, const int * context, size_t context_len );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OLLAMA_REQUEST_H */
@@ -0,0 +1,121 @@
+/**
+ *******************************************************************************
+ * @file    think_filter.c
+ * @brief   Reasoning trace filter source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <string.h>
+#include <ctype.h>
+
+#include "utils.h"
+
+#include "think_filter.h"
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static void emit_text( think_filter_t * filter, const char * data, size_t size ) {
+    if( size == 0 ) {
+        return;
+    }
+
+    think_segment_t segment = filter->in_think ? THINK_SEGMENT_THINK :
+                                                 THINK_SEGMENT_ANSWER;
+    filter->callback(segment, data, size, filter->user_data);
+}
+
+static void emit_tag( think_filter_t * filter ) {
+    filter->in_think = !filter->in_think;
+    filter->skip_whitespace = !filter->in_think;
+    filter->callback(filter->in_think ? THINK_SEGMENT_THINK_BEGIN :
+                                        THINK_SEGMENT_THINK_END,
+        NULL, 0, filter->user_data);
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t think_filter_init( think_filter_t * filter,
+        think_segment_callback_t callback, void * user_data ) {
+    RETURN_IF_NULL(filter);
+    RETURN_IF_NULL(callback);
+
+    memset(filter, 0, sizeof(think_filter_t));
+    filter->callback = callback;
+    filter->user_data = user_data;
+
+    return RES_OK;
+}
+
+result_t think_filter_feed( think_filter_t * filter,
+        const char * data, size_t size ) {
+    RETURN_IF_NULL(filter);
+    RETURN_IF_NULL(data);
+
+    // Plain text is passed in runs, only possible tags are buffered
+    size_t run_start = 0;
+    for( size_t i = 0; i < size; i++ ) {
+        char ch = data[i];
+
+        if( filter->pending_len == 0 ) {
+            if( ch == '<' ) {
+                emit_text(filter, data + run_start, i - run_start);
+                filter->pending[filter->pending_len++] = ch;
+                run_start = i + 1;
+            } else if( filter->skip_whitespace ) {
+                if( isspace((unsigned char)ch) ) {
+                    run_start = i + 1;
+                } else {
+                    filter->skip_whitespace = false;
+                }
+            }
+            continue;
+        }
+
+        const char * tag = filter->in_think ? THINK_TAG_CLOSE : THINK_TAG_OPEN;
+        size_t tag_len = strlen(tag);
+
+        filter->pending[filter->pending_len++] = ch;
+        run_start = i + 1;
+        if( memcmp(filter->pending, tag, filter->pending_len) == 0 ) {
+            if( filter->pending_len == tag_len ) {
+                filter->pending_len = 0;
+                emit_tag(filter);
+            }
+            continue;
+        }
+
+        // Not a tag after all, the last char may start a new one
+        filter->skip_whitespace = false;
+        emit_text(filter, filter->pending, filter->pending_len - 1);
+        filter->pending_len = 0;
+        if( ch == '<' ) {
+            filter->pending[filter->pending_len++] = ch;
+        } else {
+            run_start = i;
+        }
+    }
+
+    if( filter->pending_len == 0 ) {
+        emit_text(filter, data + run_start, size - run_start);
+    }
+
+    return RES_OK;
+}
+
+result_t think_filter_flush( think_filter_t * filter ) {
+    RETURN_IF_NULL(filter);
+
+    // Unfinished tag at the end of stream is just text
+    emit_text(filter, filter->pending, filter->pending_len);
+    filter->pending_len = 0;
+
+    return RES_OK;
+}
@@ -0,0 +1,75 @@
+/**
+ *******************************************************************************
+ * @file    think_filter.h
+ * @brief   Reasoning trace filter header file.
+ *          Splits streamed model output into answer and <think> sections,
+ *          also when tags are split between chunks.
+ *******************************************************************************
+ */
+
+#ifndef THINK_FILTER_H
+#define THINK_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include "utils.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define THINK_TAG_OPEN      "<think>"
+#define THINK_TAG_CLOSE     "</think>"
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef enum {
+    THINK_MODE_SHOW,        // Reasoning is shown as any other text
+    THINK_MODE_HIDE,        // Reasoning is not shown at all
+    THINK_MODE_COLLAPSE,    // Reasoning is replaced with a spinner
+    THINK_MODE_ARCHIVE,     // Like collapse, but reasoning goes to separate file
+} think_mode_t;
+
+typedef enum {
+    THINK_SEGMENT_ANSWER,
+    THINK_SEGMENT_THINK,
+    THINK_SEGMENT_THINK_BEGIN,  // Opening tag, without data
+    THINK_SEGMENT_THINK_END,    // Closing tag, without data
+} think_segment_t;
+
+typedef void (*think_segment_callback_t)(think_segment_t segment,
+    const char * data, size_t size, void * user_data);
+
+typedef struct {
+    bool in_think;
+    bool skip_whitespace;       // Model puts empty lines after closing tag
+    char pending[sizeof(THINK_TAG_CLOSE)];
+    size_t pending_len;
+
+    think_segment_callback_t callback;
+    void * user_data;
+} think_filter_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t think_filter_init( think_filter_t * filter,
+    think_segment_callback_t callback, void * user_data );
+extern result_t think_filter_feed( think_filter_t * filter,
+    const char * data, size_t size );
+extern result_t think_filter_flush( think_filter_t * filter );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THINK_FILTER_H */
@@ -16,29 +16,43 @@
 #include "utils.h"
 
 #include "audio_input.h"
+#include "config.h"
 #include "controls.h"
 #include "core.h"
 #include "display.h"
 #include "event_broker.h"
 #include "llm.h"
 #include "stt.h"
+#include "timer_service.h"
 
 /*****************
  * MAIN FUNCTION *
  *****************/
 
-int main( int argc UNUSED_PARAM, char *argv[] UNUSED_PARAM ) {
+int main( int argc, char *argv[] ) {
+    // Config first, as it blocks reload signal for every thread created later
+    ASSERT( config_init(argc > 1 ? argv[1] : DEFAULT_CONFIG_FILEPATH) == RES_OK );
+
     // HW
     ASSERT( controls_init() == RES_OK );
     ASSERT( display_init() == RES_OK );
     ASSERT( audio_input_init() == RES_OK );
 
     // SW
+    ASSERT( timer_service_init() == RES_OK );
     ASSERT( broker_init() == RES_OK );
     ASSERT( core_init() == RES_OK );
     ASSERT( stt_init() == RES_OK );
     ASSERT( llm_init() == RES_OK );
 
+    // Config reload (SIGHUP) thread
+    pthread_t thr_config;
+    pthread_create(&thr_config, NULL, config_thread, NULL);
+
+    // Timer service thread
+    pthread_t thr_timer;
+    pthread_create(&thr_timer, NULL, timer_service_thread, NULL);
+
     // Audio input thread
     pthread_t thr_audio;
     pthread_create(&thr_audio, NULL, audio_input_thread, NULL);
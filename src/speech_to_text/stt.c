@@ -17,16 +17,20 @@
 #include <sys/stat.h>
 
 #include "utils.h"
+#include "cancel_token.h"
 
 #include "stt.h"
 #include "stt_ops.h"
 #include "event_broker.h"
+#include "timer_service.h"
+#include "config.h"
 
 /******************************
  * PRIVATE MACROS AND DEFINES *
  ******************************/
 
 #define MAX_FILEPATH_SIZE       512
+#define STT_PROGRESS_PERIOD_MS  500
 
 /********************
  * PRIVATE TYPEDEFS *
@@ -39,12 +43,20 @@ typedef enum {
     STT_STATUS_FINISHED_ERROR,
 } stt_status_t;
 
+typedef struct {
+    char finalized[EVENT_MAX_DATA_SIZE];    // Tail of finalized utterances
+    char published[EVENT_MAX_DATA_SIZE];    // Last text sent to the display
+    bool early_llm_dispatch;                // Final segments prefill the LLM
+} stt_transcript_t;
+
 typedef struct {
     char wav_filepath[MAX_FILEPATH_SIZE];
     char txt_filepath[MAX_FILEPATH_SIZE];
+    stt_transcript_t transcript;
 
-    volatile int * stt_stop_flag;
+    cancel_token_t * stt_cancel;
     volatile int * stt_progress;
+    timer_id_t progress_timer;
 
     stt_status_t status;
 } stt_context_t;
@@ -53,7 +65,7 @@ typedef struct {
  * STATIC VARIABLES *
  ********************/
 
-static volatile int stt_stop_flag = 0;
+static cancel_token_t stt_cancel;
 static volatile int stt_progress = 0;
 
 /********************
@@ -87,12 +99,98 @@ static result_t create_txt_filepath_from_wav_filepath(
     return RES_OK;
 }
 
+static void stt_partial_event_publish( const char * transcript, 
+        size_t transcript_size ) {    
+    event_t event = STRUCT_INIT_ALL_ZEROS;
+    result_t res = event_create(
+        COMPONENT_STT, COMPONENT_CORE_DISP,
+        EVENT_STT_PARTIAL, 
+        transcript, transcript_size,
+        &event);
+
+    if( res == RES_OK ) {
+        broker_publish_coalesced(&event);
+    }
+}
+
+static void llm_prefill_event_publish( const char * segment, 
+        size_t segment_size ) {    
+    event_t event = STRUCT_INIT_ALL_ZEROS;
+    result_t res = event_create(
+        COMPONENT_STT, COMPONENT_LLM,
+        EVENT_LLM_PREFILL, 
+        segment, segment_size,
+        &event);
+
+    if( res == RES_OK ) {
+        broker_publish(&event);
+    }
+}
+
+// Appends text to buffer, dropping the oldest bytes when it doesn't fit
+static void append_keeping_tail( char * buf, size_t buf_size, const char * text ) {
+    size_t buf_len = strlen(buf);
+    size_t text_len = strlen(text);
+
+    if( text_len >= buf_size - 1 ) {
+        memcpy(buf, text + text_len - (buf_size - 1), buf_size - 1);
+        buf[buf_size - 1] = '\0';
+        return;
+    }
+
+    if( buf_len + text_len > buf_size - 1 ) {
+        size_t drop = buf_len + text_len - (buf_size - 1);
+        memmove(buf, buf + drop, buf_len - drop);
+        buf_len -= drop;
+    }
+
+    memcpy(buf + buf_len, text, text_len + 1);
+}
+
+// Called from operation thread for every partial and final result
+static void stt_result_callback( stt_result_kind_t kind, const char * text, 
+        void * user_data ) {
+    stt_transcript_t * transcript = (stt_transcript_t *)user_data;
+
+    char current[EVENT_MAX_DATA_SIZE];
+    if( kind == STT_RESULT_FINAL ) {
+        if( transcript->early_llm_dispatch ) {
+            // Every final segment (also empty one) is a line of the prompt 
+            // file, so LLM can rebuild exactly the same prompt prefix
+            size_t len = strnlen(text, EVENT_MAX_DATA_SIZE - 1);
+            char segment[EVENT_MAX_DATA_SIZE];
+            memcpy(segment, text, len);
+            segment[len] = '\0';
+            llm_prefill_event_publish(segment, len + 1);
+        }
+
+        if( text[0] != '\0' ) {
+            append_keeping_tail(transcript->finalized, 
+                sizeof(transcript->finalized), text);
+            append_keeping_tail(transcript->finalized, 
+                sizeof(transcript->finalized), " ");
+        }
+        snprintf(current, sizeof(current), "%s", transcript->finalized);
+    } else {
+        snprintf(current, sizeof(current), "%s", transcript->finalized);
+        append_keeping_tail(current, sizeof(current), text);
+    }
+
+    // Vosk often repeats the same hypothesis, so only changes are shown
+    if( strcmp(current, transcript->published) == 0 ) {
+        return;
+    }
+    memcpy(transcript->published, current, sizeof(transcript->published));
+
+    stt_partial_event_publish(current, strlen(current) + 1);
+}
+
 static void * stt_operation_thread( void * arg ) {
     stt_context_t * params = (stt_context_t *)arg;
 
-    params->status = STT_STATUS_IN_PROGRESS;
     result_t res = perform_speech_to_text(params->txt_filepath, params->wav_filepath, 
-        params->stt_stop_flag, params->stt_progress);
+        params->stt_cancel, params->stt_progress,
+        stt_result_callback, &params->transcript);
     params->status = (res == RES_OK) ? STT_STATUS_FINISHED_OK : 
                                        STT_STATUS_FINISHED_ERROR;
 
@@ -113,6 +211,20 @@ static void llm_request_event_publish( char * txt_filepath,
     }
 }
 
+static void stt_progress_event_publish( const char * progress_msg, 
+        size_t progress_msg_size ) {    
+    event_t event = STRUCT_INIT_ALL_ZEROS;
+    result_t res = event_create(
+        COMPONENT_STT, COMPONENT_CORE_DISP,
+        EVENT_STT_STATUS, 
+        progress_msg, progress_msg_size,
+        &event);
+
+    if( res == RES_OK ) {
+        broker_publish_coalesced(&event);
+    }
+}
+
 static void stt_status_event_publish( const char * status_msg, 
         size_t status_msg_size ) {    
     event_t event = STRUCT_INIT_ALL_ZEROS;
@@ -143,13 +255,24 @@ static void pipeline_failed_event_publish( void ) {
 static void stt_context_clear( stt_context_t * context ) {
     memset(context->wav_filepath, 0, sizeof(context->wav_filepath));
     memset(context->txt_filepath, 0, sizeof(context->txt_filepath));
+    memset(&context->transcript, 0, sizeof(context->transcript));
     
-    stt_stop_flag = 0;
+    cancel_token_reset(context->stt_cancel);
     stt_progress = 0;
+    context->progress_timer = TIMER_ID_INVALID;
 
     context->status = STT_STATUS_NOT_STARTED;
 }
 
+static void stt_progress_timer_callback( void * user_data ) {
+    stt_context_t * context = (stt_context_t *)user_data;
+
+    char progress_msg[32];
+    snprintf(progress_msg, sizeof(progress_msg), 
+        "STT progress: %d/100%%", *context->stt_progress);
+    stt_progress_event_publish(progress_msg, strlen(progress_msg));
+}
+
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
@@ -157,8 +280,9 @@ static void stt_context_clear( stt_context_t * context ) {
 void * stt_thread( void * arg UNUSED_PARAM ) {
     pthread_t stt_op_thread;
     stt_context_t context = {
-        .stt_stop_flag = &stt_stop_flag,
+        .stt_cancel = &stt_cancel,
         .stt_progress = &stt_progress,
+        .progress_timer = TIMER_ID_INVALID,
 
         .status = STT_STATUS_NOT_STARTED
     };
@@ -170,17 +294,13 @@ void * stt_thread( void * arg UNUSED_PARAM ) {
                 break;
 
             case STT_STATUS_IN_PROGRESS: {
-                DO_WITH_INTERVAL_MS(500, {
-                    char status_msg[32];
-                    snprintf(status_msg, sizeof(status_msg), 
-                        "STT progress: %d/100%%", *context.stt_progress);
-                    stt_status_event_publish(status_msg, 
-                        strlen(status_msg));
-                });
+                // Progress is reported by the periodic timer
                 break;
             }
 
             case STT_STATUS_FINISHED_OK: {
+                pthread_join(stt_op_thread, NULL);
+                timer_service_stop(context.progress_timer);
                 const char * status_msg = "STT finished.\n";
                 stt_status_event_publish(status_msg, 
                     strlen(status_msg));
@@ -191,6 +311,8 @@ void * stt_thread( void * arg UNUSED_PARAM ) {
             }
 
             case STT_STATUS_FINISHED_ERROR: {
+                pthread_join(stt_op_thread, NULL);
+                timer_service_stop(context.progress_timer);
                 const char * error_msg = "\nError: STT failed.\n";
                 stt_status_event_publish(error_msg, 
                     strlen(error_msg));
@@ -205,7 +327,8 @@ void * stt_thread( void * arg UNUSED_PARAM ) {
 
         // Action based on incomming event
         event_t e = STRUCT_INIT_ALL_ZEROS;
-        if( broker_pop(COMPONENT_STT, &e) == RES_OK ) {
+        uint32_t wait_ms = broker_worker_wait_ms(context.status != STT_STATUS_NOT_STARTED);
+        if( broker_pop_timeout(COMPONENT_STT, &e, wait_ms) == RES_OK ) {
             switch( e.type ) {
                 case EVENT_STT_REQUEST: {
                     if( context.status != STT_STATUS_NOT_STARTED ) {
@@ -237,11 +360,31 @@ void * stt_thread( void * arg UNUSED_PARAM ) {
                         continue;
                     }
 
+                    // Read per request, so the mode follows config reloads
+                    config_t config;
+                    config_get(&config);
+                    context.transcript.early_llm_dispatch = 
+                        config.stt.early_llm_dispatch != 0;
+
                     const char * msg = "STT start.\n";
                     stt_status_event_publish(msg, strlen(msg));
 
-                    stt_stop_flag = 0;
-                    pthread_create(&stt_op_thread, NULL, stt_operation_thread, &context);
+                    // Status is set before the thread exists, so the loop 
+                    // keeps polling until the thread reports it finished
+                    cancel_token_reset(&stt_cancel);
+                    context.status = STT_STATUS_IN_PROGRESS;
+                    if( pthread_create(&stt_op_thread, NULL, stt_operation_thread, 
+                            &context) != 0 ) {
+                        const char * error_msg = "\nError: STT failed.\n";
+                        stt_status_event_publish(error_msg, 
+                            strlen(error_msg));
+                        pipeline_failed_event_publish();
+                        stt_context_clear(&context);
+                        continue;
+                    }
+                    timer_service_start_periodic(STT_PROGRESS_PERIOD_MS, 
+                        stt_progress_timer_callback, &context, 
+                        &context.progress_timer);
                     
                     break;
                 }
@@ -255,8 +398,9 @@ void * stt_thread( void * arg UNUSED_PARAM ) {
                         continue;
                     }
 
-                    stt_stop_flag = 1;
-                    pthread_join(stt_op_thread, NULL);
+                    // Operation thread notices the token between sub-chunks 
+                    // and is joined once its status is reported
+                    cancel_token_cancel(&stt_cancel);
                     
                     break;
                 }
@@ -265,13 +409,11 @@ void * stt_thread( void * arg UNUSED_PARAM ) {
                     break;
             }
         }
-
-        usleep(30000);
     }
 
     return NULL;
 }
 
 result_t stt_init( void ) {
-    return RES_OK;
+    return cancel_token_init(&stt_cancel);
 }
@@ -18,6 +18,8 @@
 #include <cjson/cJSON.h>
 
 #include "utils.h"
+#include "cancel_token.h"
+#include "config.h"
 
 #include "stt_ops.h"
 
@@ -25,27 +27,57 @@
  * PRIVATE MACROS AND DEFINES *
  ******************************/
 
-#define DEFAULT_VOSK_ENG_MODEL      "models/vosk-model-small-en-us-0.15" // TODO: make it configurable
 #define DEFAULT_VOSK_SAMPLE_RATE    16000.0
 #define DEFAULT_VOSK_JSON_TEXT_KEY  "text"
+#define DEFAULT_VOSK_JSON_PART_KEY  "partial"
 
 #define READ_BUFFER_SIZE_BYTES      4096
+#define VOSK_FEED_CHUNK_BYTES       1024    // ~32 ms of 16 kHz mono audio
+#define PARTIAL_EVERY_N_CHUNKS      4       // Partial result is not for free
 #define WAV_HEADER_SIZE_BYTES       44
 
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static void handle_result_json( const char * result_json, stt_result_kind_t kind,
+        FILE * txt_file, stt_result_callback_t callback, void * user_data ) {
+    cJSON * json = cJSON_Parse(result_json);
+    if( !json ) {
+        return;
+    }
+
+    const char * key = (kind == STT_RESULT_FINAL) ? DEFAULT_VOSK_JSON_TEXT_KEY :
+                                                    DEFAULT_VOSK_JSON_PART_KEY;
+    cJSON * text = cJSON_GetObjectItemCaseSensitive(json, key);
+    if( cJSON_IsString(text) && (text->valuestring != NULL) ) {
+        if( kind == STT_RESULT_FINAL ) {
+            fprintf(txt_file, "%s\n", text->valuestring);
+        }
+        if( callback ) {
+            callback(kind, text->valuestring, user_data);
+        }
+    }
+    cJSON_Delete(json);
+}
+
 /********************
  * GLOBAL FUNCTIONS *
  ********************/
 
 result_t perform_speech_to_text( const char * txt_filepath, const char * wav_filepath, 
-        volatile int * stop_flag, volatile int * progress ) {
+        cancel_token_t * cancel, volatile int * progress,
+        stt_result_callback_t callback, void * user_data ) {
     RETURN_IF_NULL(txt_filepath);
     RETURN_IF_NULL(wav_filepath);
-    RETURN_IF_NULL(stop_flag);
+    RETURN_IF_NULL(cancel);
     RETURN_IF_NULL(progress);
 
     vosk_set_log_level(-1);
 
-    VoskModel * model = vosk_model_new(DEFAULT_VOSK_ENG_MODEL);
+    config_t config;
+    config_get(&config);
+    VoskModel * model = vosk_model_new(config.stt.vosk_model);
     if( !model ) {
         return RES_ERR_GENERIC;
     }
@@ -78,40 +110,42 @@ result_t perform_speech_to_text( const char * txt_filepath, const char * wav_fil
 
     int read_bytes = 0;
     int total_bytes_read = 0;
+    unsigned int chunks_since_partial = 0;
     char buffer[READ_BUFFER_SIZE_BYTES];
-    while( (read_bytes = (int)fread(buffer, sizeof(char), READ_BUFFER_SIZE_BYTES, wav_file)) > 0 ) {
-        if( *stop_flag ) {
-            break;
-        }
+    bool cancelled = false;
+    while( !cancelled && 
+           (read_bytes = (int)fread(buffer, sizeof(char), READ_BUFFER_SIZE_BYTES, wav_file)) > 0 ) {
+        // Decoding is fed in small sub-chunks, so a stop request is noticed 
+        // after at most one of them instead of a whole read buffer
+        for( int offset = 0; offset < read_bytes; offset += VOSK_FEED_CHUNK_BYTES ) {
+            if( cancel_token_is_cancelled(cancel) ) {
+                cancelled = true;
+                break;
+            }
 
-        total_bytes_read += read_bytes;
-        *progress = (int)((total_bytes_read * 100) / file_size);
-
-        if( vosk_recognizer_accept_waveform(recognizer, buffer, read_bytes) ) {
-            const char * result_json = vosk_recognizer_result(recognizer);
-            cJSON * json = cJSON_Parse(result_json);
-            if( json ) {
-                cJSON *text = cJSON_GetObjectItemCaseSensitive(json, 
-                    DEFAULT_VOSK_JSON_TEXT_KEY);
-                if( cJSON_IsString(text) && (text->valuestring != NULL) ) {
-                    fprintf(txt_file, "%s\n", text->valuestring);
-                }
-                cJSON_Delete(json); 
+            int chunk_bytes = read_bytes - offset;
+            if( chunk_bytes > VOSK_FEED_CHUNK_BYTES ) {
+                chunk_bytes = VOSK_FEED_CHUNK_BYTES;
             }
-        }
-    }
 
-    const char * final_result_json = vosk_recognizer_final_result(recognizer);
-    cJSON * final_json = cJSON_Parse(final_result_json);
-    if( final_json ) {
-        cJSON * final_text = cJSON_GetObjectItemCaseSensitive(final_json, 
-            DEFAULT_VOSK_JSON_TEXT_KEY);
-        if( cJSON_IsString(final_text) && (final_text->valuestring != NULL) ) {
-            fprintf(txt_file, "%s\n", final_text->valuestring);
+            total_bytes_read += chunk_bytes;
+            *progress = (int)((total_bytes_read * 100) / file_size);
+
+            if( vosk_recognizer_accept_waveform(recognizer, buffer + offset, chunk_bytes) ) {
+                handle_result_json(vosk_recognizer_result(recognizer), 
+                    STT_RESULT_FINAL, txt_file, callback, user_data);
+                chunks_since_partial = 0;
+            } else if( callback && ++chunks_since_partial >= PARTIAL_EVERY_N_CHUNKS ) {
+                handle_result_json(vosk_recognizer_partial_result(recognizer), 
+                    STT_RESULT_PARTIAL, txt_file, callback, user_data);
+                chunks_since_partial = 0;
+            }
         }
-        cJSON_Delete(final_json);
     }
 
+    handle_result_json(vosk_recognizer_final_result(recognizer), 
+        STT_RESULT_FINAL, txt_file, callback, user_data);
+
     fclose(wav_file);
     fclose(txt_file);
     vosk_recognizer_free(recognizer);
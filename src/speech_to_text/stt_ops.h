@@ -17,6 +17,19 @@ extern "C" {
  ************/
 
 #include "utils.h"
+#include "cancel_token.h"
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef enum {
+    STT_RESULT_PARTIAL,     // Hypothesis of the utterance being decoded
+    STT_RESULT_FINAL,       // Finalized utterance, will not change anymore
+} stt_result_kind_t;
+
+typedef void (*stt_result_callback_t)(stt_result_kind_t kind, const char * text, 
+    void * user_data);
 
 /******************************
  * GLOBAL FUNCTION PROTOTYPES *
@@ -24,7 +37,8 @@ extern "C" {
 
 extern result_t perform_speech_to_text( 
     const char * txt_filepath, const char * wav_filepath,
-    volatile int * stop_flag, volatile int * progress );
+    cancel_token_t * cancel, volatile int * progress,
+    stt_result_callback_t callback, void * user_data );
 
 #ifdef __cplusplus
 }
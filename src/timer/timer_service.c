@@ -0,0 +1,452 @@
+/**
+ *******************************************************************************
+ * @file    timer_service.c
+ * @brief   Timer service source file.
+ *          Hierarchical timer wheel on CLOCK_MONOTONIC driven by one timerfd.
+ *          The timerfd is armed for the next wheel slot that holds a timer,
+ *          so the service thread sleeps in read() when nothing is due.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+
+#include "utils.h"
+
+#include "timer_service.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define WHEEL_BITS          6
+#define WHEEL_SLOTS         (1U << WHEEL_BITS)
+#define WHEEL_MASK          (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS        4
+#define WHEEL_MAX_TICKS     ((1ULL << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
+#define NS_PER_TICK         (TIMER_SERVICE_TICK_MS * 1000000ULL)
+#define NS_PER_SEC          1000000000ULL
+
+#define TIMER_ID_INDEX_BITS 8
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct timer_entry_t {
+    struct timer_entry_t * prev;
+    struct timer_entry_t * next;
+    struct timer_entry_t ** slot;   // Wheel slot it is linked into
+
+    uint64_t expires;           // Absolute tick
+    uint64_t period_ticks;      // 0 for one-shot timers
+    timer_callback_t callback;
+    void * user_data;
+
+    uint32_t generation;
+    bool active;                // Allocated and not stopped
+    bool queued;                // Linked into a wheel slot
+    bool firing;                // Linked into the local list of due timers
+} timer_entry_t;
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static pthread_mutex_t g_mu = PTHREAD_MUTEX_INITIALIZER;
+static int g_tfd = -1;
+static uint64_t g_base_ns;
+static uint64_t g_current;      // Next tick to be processed
+
+// Callback being run by the service thread, stop waits until it returns
+static pthread_cond_t g_callback_done = PTHREAD_COND_INITIALIZER;
+static timer_id_t g_running = TIMER_ID_INVALID;
+static pthread_t g_service_thread;
+
+static timer_entry_t g_timers[TIMER_SERVICE_MAX_TIMERS];
+static timer_entry_t * g_wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static uint64_t monotonic_now_ns( void ) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t ticks_now( void ) {
+    return (monotonic_now_ns() - g_base_ns) / NS_PER_TICK;
+}
+
+// Rounded up, so a timer never fires before its requested delay
+static uint64_t ticks_after( uint64_t delay_ticks ) {
+    uint64_t elapsed_ns = monotonic_now_ns() - g_base_ns;
+    return (elapsed_ns + delay_ticks * NS_PER_TICK + NS_PER_TICK - 1) / NS_PER_TICK;
+}
+
+static uint64_t ms_to_ticks( uint32_t ms ) {
+    uint64_t ticks = (ms + TIMER_SERVICE_TICK_MS - 1) / TIMER_SERVICE_TICK_MS;
+    return ticks ? ticks : 1;
+}
+
+static timer_id_t entry_to_id( const timer_entry_t * t ) {
+    uint32_t idx = (uint32_t)(t - g_timers);
+    return (t->generation << TIMER_ID_INDEX_BITS) | (idx + 1);
+}
+
+static timer_entry_t * id_to_entry( timer_id_t id ) {
+    uint32_t idx = (id & ((1U << TIMER_ID_INDEX_BITS) - 1));
+    if( idx == 0 || idx > TIMER_SERVICE_MAX_TIMERS ) {
+        return NULL;
+    }
+
+    timer_entry_t * t = &g_timers[idx - 1];
+    if( !t->active || entry_to_id(t) != id ) {
+        return NULL;
+    }
+
+    return t;
+}
+
+// === WHEEL (all called with g_mu held) ===
+
+static void wheel_unlink( timer_entry_t * t, timer_entry_t ** head ) {
+    if( t->prev ) {
+        t->prev->next = t->next;
+    } else {
+        *head = t->next;
+    }
+    if( t->next ) {
+        t->next->prev = t->prev;
+    }
+    t->prev = NULL;
+    t->next = NULL;
+}
+
+static timer_entry_t ** wheel_slot_of( timer_entry_t * t ) {
+    if( t->expires < g_current ) {
+        t->expires = g_current;
+    }
+    uint64_t delta = t->expires - g_current;
+    if( delta > WHEEL_MAX_TICKS ) {
+        t->expires = g_current + WHEEL_MAX_TICKS;
+        delta = WHEEL_MAX_TICKS;
+    }
+
+    int level = 0;
+    while( level < WHEEL_LEVELS - 1 && 
+            delta >= (1ULL << (WHEEL_BITS * (unsigned)(level + 1))) ) {
+        level++;
+    }
+
+    unsigned slot = (unsigned)(t->expires >> (WHEEL_BITS * (unsigned)level)) & WHEEL_MASK;
+    return &g_wheel[level][slot];
+}
+
+static void wheel_insert( timer_entry_t * t ) {
+    timer_entry_t ** head = wheel_slot_of(t);
+    t->prev = NULL;
+    t->next = *head;
+    if( *head ) {
+        (*head)->prev = t;
+    }
+    *head = t;
+    t->slot = head;
+    t->queued = true;
+}
+
+static void wheel_remove( timer_entry_t * t ) {
+    if( t->queued ) {
+        wheel_unlink(t, t->slot);
+        t->slot = NULL;
+        t->queued = false;
+    }
+}
+
+static void wheel_cascade( int level, unsigned slot ) {
+    timer_entry_t * t = g_wheel[level][slot];
+    g_wheel[level][slot] = NULL;
+
+    while( t ) {
+        timer_entry_t * next = t->next;
+        wheel_insert(t);
+        t = next;
+    }
+}
+
+// Moves all timers that are due up to now_tick to the returned list
+static timer_entry_t * wheel_advance( uint64_t now_tick ) {
+    timer_entry_t * due = NULL;
+    timer_entry_t * due_tail = NULL;
+
+    while( g_current <= now_tick ) {
+        unsigned idx = (unsigned)g_current & WHEEL_MASK;
+        if( idx == 0 ) {
+            for( int level = 1; level < WHEEL_LEVELS; level++ ) {
+                unsigned slot = (unsigned)(g_current >> (WHEEL_BITS * (unsigned)level)) 
+                    & WHEEL_MASK;
+                wheel_cascade(level, slot);
+                if( slot != 0 ) {
+                    break;
+                }
+            }
+        }
+
+        timer_entry_t * t = g_wheel[0][idx];
+        g_wheel[0][idx] = NULL;
+        while( t ) {
+            timer_entry_t * next = t->next;
+            t->slot = NULL;
+            t->queued = false;
+            t->firing = true;
+            t->prev = due_tail;
+            t->next = NULL;
+            if( due_tail ) {
+                due_tail->next = t;
+            } else {
+                due = t;
+            }
+            due_tail = t;
+            t = next;
+        }
+
+        g_current++;
+    }
+
+    return due;
+}
+
+static uint64_t wheel_next_expiry( void ) {
+    uint64_t next = UINT64_MAX;
+
+    for( unsigned k = 0; k < WHEEL_SLOTS; k++ ) {
+        if( g_wheel[0][(g_current + k) & WHEEL_MASK] ) {
+            next = g_current + k;
+            break;
+        }
+    }
+
+    // Higher levels only need a wakeup when their slot is due to cascade
+    for( unsigned level = 1; level < WHEEL_LEVELS; level++ ) {
+        uint64_t base = g_current >> (WHEEL_BITS * level);
+        for( unsigned k = 1; k <= WHEEL_SLOTS; k++ ) {
+            if( g_wheel[level][(base + k) & WHEEL_MASK] ) {
+                uint64_t cascade_tick = (base + k) << (WHEEL_BITS * level);
+                if( cascade_tick < next ) {
+                    next = cascade_tick;
+                }
+                break;
+            }
+        }
+    }
+
+    return next;
+}
+
+static void timerfd_rearm( void ) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+
+    uint64_t next = wheel_next_expiry();
+    if( next != UINT64_MAX ) {
+        uint64_t deadline_ns = g_base_ns + next * NS_PER_TICK;
+        its.it_value.tv_sec = (time_t)(deadline_ns / NS_PER_SEC);
+        its.it_value.tv_nsec = (long)(deadline_ns % NS_PER_SEC);
+    }
+
+    // All zeros disarms the timerfd, so the service thread sleeps until 
+    // a new timer is started
+    timerfd_settime(g_tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static result_t timer_start( uint64_t delay_ticks, uint64_t period_ticks, 
+        timer_callback_t callback, void * user_data, timer_id_t * id ) {
+    RETURN_IF_NULL(callback);
+    RETURN_IF_NULL(id);
+    RETURN_ERROR_IF( g_tfd < 0, RES_ERR_NOT_READY );
+
+    pthread_mutex_lock(&g_mu);
+
+    timer_entry_t * t = NULL;
+    for( size_t i = 0; i < NELEMS(g_timers); i++ ) {
+        if( !g_timers[i].active && !g_timers[i].firing ) {
+            t = &g_timers[i];
+            break;
+        }
+    }
+    if( !t ) {
+        pthread_mutex_unlock(&g_mu);
+        return RES_ERR_INVALID_SIZE;
+    }
+
+    t->generation = (t->generation + 1) & ((1U << (32 - TIMER_ID_INDEX_BITS)) - 1);
+    t->expires = ticks_after(delay_ticks);
+    t->period_ticks = period_ticks;
+    t->callback = callback;
+    t->user_data = user_data;
+    t->active = true;
+    wheel_insert(t);
+
+    *id = entry_to_id(t);
+
+    timerfd_rearm();
+    pthread_mutex_unlock(&g_mu);
+
+    return RES_OK;
+}
+
+// Must be called with g_mu held
+static result_t timer_cancel( timer_id_t id ) {
+    timer_entry_t * t = id_to_entry(id);
+    if( !t ) {
+        return RES_ERR_WRONG_ARGS;
+    }
+
+    wheel_remove(t);
+    t->active = false;
+    timerfd_rearm();
+
+    return RES_OK;
+}
+
+static void timer_process_due( void ) {
+    pthread_mutex_lock(&g_mu);
+
+    uint64_t now_tick = ticks_now();
+    timer_entry_t * t = wheel_advance(now_tick);
+
+    while( t ) {
+        timer_entry_t * next = t->next;
+        t->firing = false;
+        t->prev = NULL;
+        t->next = NULL;
+
+        // Stopped while it was waiting in the due list
+        if( !t->active ) {
+            t = next;
+            continue;
+        }
+
+        timer_callback_t callback = t->callback;
+        void * user_data = t->user_data;
+        g_running = entry_to_id(t);
+
+        if( t->period_ticks > 0 ) {
+            // Keep the original phase, skipping periods missed while blocked
+            do {
+                t->expires += t->period_ticks;
+            } while( t->expires <= now_tick );
+            wheel_insert(t);
+        } else {
+            t->active = false;
+        }
+
+        pthread_mutex_unlock(&g_mu);
+        callback(user_data);
+        pthread_mutex_lock(&g_mu);
+
+        g_running = TIMER_ID_INVALID;
+        pthread_cond_broadcast(&g_callback_done);
+
+        t = next;
+    }
+
+    timerfd_rearm();
+    pthread_mutex_unlock(&g_mu);
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+void * timer_service_thread( void * arg UNUSED_PARAM ) {
+    pthread_mutex_lock(&g_mu);
+    g_service_thread = pthread_self();
+    pthread_mutex_unlock(&g_mu);
+
+    while(1) {
+        uint64_t expirations;
+        ssize_t rc = read(g_tfd, &expirations, sizeof(expirations));
+        if( rc < 0 && errno != EINTR && errno != EAGAIN ) {
+            ERROR("Timer service read failed (errno %d)", errno);
+            return NULL;
+        }
+
+        timer_process_due();
+    }
+
+    return NULL;
+}
+
+result_t timer_service_start_oneshot( uint32_t delay_ms, 
+        timer_callback_t callback, void * user_data, timer_id_t * id OUTPUT ) {
+    return timer_start(ms_to_ticks(delay_ms), 0, callback, user_data, id);
+}
+
+result_t timer_service_start_periodic( uint32_t period_ms, 
+        timer_callback_t callback, void * user_data, timer_id_t * id OUTPUT ) {
+    RETURN_ERROR_IF( period_ms == 0, RES_ERR_WRONG_ARGS );
+    uint64_t period_ticks = ms_to_ticks(period_ms);
+    return timer_start(period_ticks, period_ticks, callback, user_data, id);
+}
+
+// One-shot timer whose callback is running is already inactive, stop still
+// waits for it but reports it as unknown
+result_t timer_service_stop( timer_id_t id ) {
+    pthread_mutex_lock(&g_mu);
+
+    result_t res = timer_cancel(id);
+
+    // Callback stopping its own timer would wait for itself
+    if( !pthread_equal(pthread_self(), g_service_thread) ) {
+        while( id != TIMER_ID_INVALID && g_running == id ) {
+            pthread_cond_wait(&g_callback_done, &g_mu);
+        }
+    }
+
+    pthread_mutex_unlock(&g_mu);
+
+    return res;
+}
+
+result_t timer_service_cancel( timer_id_t id ) {
+    pthread_mutex_lock(&g_mu);
+    result_t res = timer_cancel(id);
+    pthread_mutex_unlock(&g_mu);
+
+    return res;
+}
+
+result_t timer_service_init( void ) {
+    pthread_mutex_lock(&g_mu);
+
+    if( g_tfd < 0 ) {
+        g_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    }
+    if( g_tfd < 0 ) {
+        pthread_mutex_unlock(&g_mu);
+        return RES_ERR_NOT_READY;
+    }
+
+    memset(g_timers, 0, sizeof(g_timers));
+    memset(g_wheel, 0, sizeof(g_wheel));
+    g_base_ns = monotonic_now_ns();
+    g_current = 0;
+    timerfd_rearm();
+
+    pthread_mutex_unlock(&g_mu);
+
+    return RES_OK;
+}
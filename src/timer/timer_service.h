@@ -0,0 +1,63 @@
+/**
+ *******************************************************************************
+ * @file    timer_service.h
+ * @brief   Timer service header file.
+ *******************************************************************************
+ */
+
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdint.h>
+
+#include "utils.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define TIMER_SERVICE_TICK_MS       1
+#define TIMER_SERVICE_MAX_TIMERS    32
+
+#define TIMER_ID_INVALID            0
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef uint32_t timer_id_t;
+
+// Called from the timer service thread, keep it short and non-blocking
+typedef void (*timer_callback_t)(void * user_data);
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t timer_service_init( void );
+extern void * timer_service_thread( void * arg );
+
+extern result_t timer_service_start_oneshot( uint32_t delay_ms, 
+    timer_callback_t callback, void * user_data, timer_id_t * id OUTPUT );
+extern result_t timer_service_start_periodic( uint32_t period_ms, 
+    timer_callback_t callback, void * user_data, timer_id_t * id OUTPUT );
+// After it returns the callback is not running and won't run again, so don't
+// call it while holding a lock that the callback takes
+extern result_t timer_service_stop( timer_id_t id );
+
+// Doesn't wait, callback that is already running may still finish after it
+extern result_t timer_service_cancel( timer_id_t id );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMER_SERVICE_H */
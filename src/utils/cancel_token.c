@@ -0,0 +1,73 @@
+/**
+ *******************************************************************************
+ * @file    cancel_token.c
+ * @brief   Cancellation token source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "utils.h"
+
+#include "cancel_token.h"
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t cancel_token_init( cancel_token_t * token ) {
+    RETURN_IF_NULL(token);
+
+    atomic_init(&token->cancelled, false);
+    token->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    RETURN_ERROR_IF( token->event_fd < 0, RES_ERR_NOT_READY );
+
+    return RES_OK;
+}
+
+void cancel_token_deinit( cancel_token_t * token ) {
+    if( token && token->event_fd >= 0 ) {
+        close(token->event_fd);
+        token->event_fd = -1;
+    }
+}
+
+result_t cancel_token_cancel( cancel_token_t * token ) {
+    RETURN_IF_NULL(token);
+
+    if( !atomic_exchange(&token->cancelled, true) ) {
+        uint64_t one = 1;
+        RETURN_ERROR_IF( write(token->event_fd, &one, sizeof(one)) != sizeof(one),
+            RES_ERR_GENERIC );
+    }
+
+    return RES_OK;
+}
+
+result_t cancel_token_reset( cancel_token_t * token ) {
+    RETURN_IF_NULL(token);
+
+    // Drain the counter, so the fd stops being readable (EAGAIN if not set)
+    uint64_t value;
+    if( read(token->event_fd, &value, sizeof(value)) < 0 && errno != EAGAIN ) {
+        return RES_ERR_GENERIC;
+    }
+    atomic_store(&token->cancelled, false);
+
+    return RES_OK;
+}
+
+bool cancel_token_is_cancelled( cancel_token_t * token ) {
+    return token && atomic_load(&token->cancelled);
+}
+
+int cancel_token_fd( cancel_token_t * token ) {
+    return token ? token->event_fd : -1;
+}
@@ -0,0 +1,52 @@
+/**
+ *******************************************************************************
+ * @file    cancel_token.h
+ * @brief   Cancellation token header file.
+ *          Atomic flag for cheap polling between work chunks plus eventfd 
+ *          that becomes readable on cancel, so blocking waits (poll, curl
+ *          multi, ALSA) can be woken up immediately.
+ *******************************************************************************
+ */
+
+#ifndef CANCEL_TOKEN_H
+#define CANCEL_TOKEN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdatomic.h>
+
+#include "utils.h"
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef struct {
+    atomic_bool cancelled;
+    int event_fd;
+} cancel_token_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern result_t cancel_token_init( cancel_token_t * token );
+extern void cancel_token_deinit( cancel_token_t * token );
+
+extern result_t cancel_token_cancel( cancel_token_t * token );
+extern result_t cancel_token_reset( cancel_token_t * token );
+
+extern bool cancel_token_is_cancelled( cancel_token_t * token );
+extern int cancel_token_fd( cancel_token_t * token );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CANCEL_TOKEN_H */
@@ -22,7 +22,7 @@ extern "C" {
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <sys/time.h>
+#include <time.h>
 
 // ===========
 // = General =
@@ -91,7 +91,7 @@ typedef enum {
 #define CYAN    "\033[36m"
 #define MAGENTA "\033[35m"
 
-#ifdef UNIT_TESTS
+#if defined(UNIT_TESTS) || defined(BENCHMARKS)
 #define LOG(level, is_endline, ...) ((void)0)
 #else
 #define LOG(level, is_endline, ...) \
@@ -145,22 +145,15 @@ typedef enum {
 #define MS_PER_SEC 1000ULL
 #define US_PER_SEC 1000000ULL
 
+#define NS_PER_US  1000ULL
+
+// Monotonic, so intervals are not affected by NTP or manual clock changes
 static inline uint64_t get_current_time_us( void ) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return ((uint64_t)tv.tv_sec) * US_PER_SEC + (uint64_t)tv.tv_usec;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec) * US_PER_SEC + (uint64_t)ts.tv_nsec / NS_PER_US;
 }
 
-#define DO_WITH_INTERVAL_MS(milliseconds, code) \
-    do { \
-        static uint64_t last_time = 0; \
-        uint64_t current_time = get_current_time_us(); \
-        if ((current_time - last_time) >= (milliseconds * MS_PER_SEC)) { \
-            last_time = current_time; \
-            code \
-        } \
-    } while (0)
-
 #define HAS_TIME_PASSED(last_time_us, interval_us) \
     ((get_current_time_us() - (last_time_us)) >= (interval_us))
 
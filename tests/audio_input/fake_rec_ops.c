@@ -0,0 +1,42 @@
+/**
+ *******************************************************************************
+ * @file    fake_rec_ops.c
+ * @brief   Fake recording operation source file.
+ *          Stands in for ALSA capture in tests. Recording finishes on its
+ *          own after a short time, without any further event.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <unistd.h>
+
+#include "utils.h"
+#include "cancel_token.h"
+
+#include "audio_input_rec_ops.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define FAKE_REC_DURATION_US    20000
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+result_t record_audio_to_wav( const char * wav_filepath, 
+        int duration_s UNUSED_PARAM, cancel_token_t * cancel, 
+        volatile int * progress ) {
+    RETURN_IF_NULL(wav_filepath);
+    RETURN_IF_NULL(cancel);
+    RETURN_IF_NULL(progress);
+
+    usleep(FAKE_REC_DURATION_US);
+    *progress = 1;
+
+    return RES_OK;
+}
@@ -0,0 +1,90 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "config.h"
+#include "event_broker.h"
+#include "timer_service.h"
+#include "audio_input.h"
+
+#define TEST_RUNS           10
+#define TEST_WAIT_MS        2000
+
+static char work_dir[] = "/tmp/test_audio_input_XXXXXX";
+static char start_dir[512];
+
+static int group_setup( void ** state ) {
+    (void) state;
+    // Recordings folder is relative to the working directory
+    if( !getcwd(start_dir, sizeof(start_dir)) || !mkdtemp(work_dir) || 
+            chdir(work_dir) != 0 || mkdir("data", 0755) != 0 ) {
+        return -1;
+    }
+
+    assert_int_equal(config_init("/nonexistent/pitalkster.ini"), RES_OK);
+    assert_int_equal(broker_init(), RES_OK);
+    assert_int_equal(timer_service_init(), RES_OK);
+    assert_int_equal(audio_input_init(), RES_OK);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, timer_service_thread, NULL);
+    pthread_detach(thread);
+    pthread_create(&thread, NULL, audio_input_thread, NULL);
+    pthread_detach(thread);
+    return 0;
+}
+
+static int group_teardown( void ** state ) {
+    (void) state;
+    rmdir("data");
+    if( chdir(start_dir) != 0 ) {
+        return -1;
+    }
+    rmdir(work_dir);
+    return 0;
+}
+
+static void drain( sys_component_t c ) {
+    event_t e;
+    while( broker_pop(c, &e) == RES_OK ) {
+    }
+}
+
+static void test_audio_input_recording_finishes_without_events( void ** state ) {
+    (void) state;
+
+    // Worker must notice that recording finished on its own, even if it
+    // went back to waiting before the recording thread started
+    for( int i = 0; i < TEST_RUNS; i++ ) {
+        event_t e;
+        event_create(COMPONENT_CORE_DISP, COMPONENT_AUDIO_INPUT, 
+            EVENT_REC_REQUEST, NULL, 0, &e);
+        assert_int_equal(broker_publish(&e), RES_OK);
+
+        event_t request = STRUCT_INIT_ALL_ZEROS;
+        assert_int_equal(broker_pop_timeout(COMPONENT_STT, &request, TEST_WAIT_MS), 
+            RES_OK);
+        assert_int_equal(request.type, EVENT_STT_REQUEST);
+        assert_int_equal(request.src, COMPONENT_AUDIO_INPUT);
+
+        // Fake recording writes no file, only its folder is left
+        rmdir(dirname((char *)request.data));
+        drain(COMPONENT_CORE_DISP);
+    }
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_audio_input_recording_finishes_without_events),
+    };
+
+    return cmocka_run_group_tests(tests, group_setup, group_teardown);
+}
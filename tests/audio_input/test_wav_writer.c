@@ -0,0 +1,153 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "wav_writer.h"
+#include "temp_file.h"
+
+#define TEST_RATE           16000
+#define TEST_MAX_DATA_SIZE  (10u * TEST_RATE * 2u)
+
+static const wav_format_t format = {
+    .rate = TEST_RATE,
+    .channels = 1,
+    .bits_per_sample = 16
+};
+
+static uint8_t * read_file( size_t * size ) {
+    FILE * file = fopen(temp_file_path(), "rb");
+    assert_non_null(file);
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    rewind(file);
+
+    uint8_t * data = malloc(*size + 1);
+    assert_non_null(data);
+    assert_int_equal(fread(data, 1, *size, file), *size);
+    fclose(file);
+    return data;
+}
+
+static uint32_t le32( const uint8_t * p ) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+        (uint32_t)p[3] << 24;
+}
+
+static uint16_t le16( const uint8_t * p ) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static void test_wav_writer_header( void ** state ) {
+    (void) state;
+
+    wav_writer_t w = WAV_WRITER_INIT;
+    assert_int_equal(wav_writer_open(&w, temp_file_path(), &format, TEST_MAX_DATA_SIZE),
+        RES_OK);
+    uint8_t samples[100] = {0};
+    assert_int_equal(wav_writer_append(&w, samples, sizeof(samples)), RES_OK);
+    assert_int_equal(wav_writer_close(&w), RES_OK);
+    assert_int_equal(w.fd, -1);
+
+    size_t size = 0;
+    uint8_t * data = read_file(&size);
+    assert_int_equal(size, WAV_WRITER_HEADER_SIZE + sizeof(samples));
+
+    assert_memory_equal(&data[0], "RIFF", 4);
+    assert_int_equal(le32(&data[4]), size - 8);
+    assert_memory_equal(&data[8], "WAVE", 4);
+    assert_memory_equal(&data[12], "fmt ", 4);
+    assert_int_equal(le32(&data[16]), 16);
+    assert_int_equal(le16(&data[20]), 1);
+    assert_int_equal(le16(&data[22]), 1);
+    assert_int_equal(le32(&data[24]), TEST_RATE);
+    assert_int_equal(le32(&data[28]), TEST_RATE * 2);
+    assert_int_equal(le16(&data[32]), 2);
+    assert_int_equal(le16(&data[34]), 16);
+    assert_memory_equal(&data[36], "data", 4);
+    assert_int_equal(le32(&data[40]), sizeof(samples));
+
+    free(data);
+}
+
+static void test_wav_writer_data_across_blocks( void ** state ) {
+    (void) state;
+
+    // Odd chunk size, so appends straddle block boundaries
+    size_t total = 3 * WAV_WRITER_BLOCK_SIZE + 1234;
+    size_t chunk = 4099;
+    uint8_t * samples = malloc(total);
+    assert_non_null(samples);
+    for( size_t i = 0; i < total; i++ ) {
+        samples[i] = (uint8_t)(i * 31 + i / 251);
+    }
+
+    wav_writer_t w = WAV_WRITER_INIT;
+    assert_int_equal(wav_writer_open(&w, temp_file_path(), &format, TEST_MAX_DATA_SIZE),
+        RES_OK);
+    for( size_t i = 0; i < total; i += chunk ) {
+        size_t n = total - i < chunk ? total - i : chunk;
+        assert_int_equal(wav_writer_append(&w, &samples[i], n), RES_OK);
+    }
+    assert_int_equal(wav_writer_close(&w), RES_OK);
+
+    size_t size = 0;
+    uint8_t * data = read_file(&size);
+    assert_int_equal(size, WAV_WRITER_HEADER_SIZE + total);
+    assert_int_equal(le32(&data[40]), total);
+    assert_memory_equal(&data[WAV_WRITER_HEADER_SIZE], samples, total);
+
+    free(data);
+    free(samples);
+}
+
+static void test_wav_writer_truncates_preallocated_space( void ** state ) {
+    (void) state;
+
+    // Nothing recorded, e.g. stopped right away
+    wav_writer_t w = WAV_WRITER_INIT;
+    assert_int_equal(wav_writer_open(&w, temp_file_path(), &format, TEST_MAX_DATA_SIZE),
+        RES_OK);
+    assert_int_equal(wav_writer_close(&w), RES_OK);
+
+    struct stat st;
+    assert_int_equal(stat(temp_file_path(), &st), 0);
+    assert_int_equal(st.st_size, WAV_WRITER_HEADER_SIZE);
+
+    size_t size = 0;
+    uint8_t * data = read_file(&size);
+    assert_int_equal(le32(&data[40]), 0);
+    free(data);
+}
+
+static void test_wav_writer_wrong_args( void ** state ) {
+    (void) state;
+
+    wav_writer_t w = WAV_WRITER_INIT;
+    wav_format_t bad = format;
+    bad.bits_per_sample = 12;
+    assert_int_equal(wav_writer_open(&w, temp_file_path(), &bad, TEST_MAX_DATA_SIZE),
+        RES_ERR_WRONG_ARGS);
+    assert_int_equal(wav_writer_open(&w, temp_file_path(), &format, UINT32_MAX),
+        RES_ERR_INVALID_SIZE);
+    assert_int_equal(wav_writer_open(&w, NULL, &format, 0), RES_ERR_NULL_PTR);
+
+    // Writer that isn't open is rejected
+    assert_int_equal(wav_writer_append(&w, "x", 1), RES_ERR_NULL_PTR);
+    assert_int_equal(wav_writer_close(&w), RES_ERR_NULL_PTR);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        TEMP_FILE_UNIT_TEST(test_wav_writer_header),
+        TEMP_FILE_UNIT_TEST(test_wav_writer_data_across_blocks),
+        TEMP_FILE_UNIT_TEST(test_wav_writer_truncates_preallocated_space),
+        cmocka_unit_test(test_wav_writer_wrong_args),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,165 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "config.h"
+#include "temp_file.h"
+
+static void write_config( const char * text ) {
+    FILE * file = fopen(temp_file_path(), "w");
+    assert_non_null(file);
+    fputs(text, file);
+    fclose(file);
+}
+
+static void test_config_load_overrides_defaults( void ** state ) {
+    (void) state;
+
+    write_config(
+        "# Device tuning\n"
+        "[audio]\n"
+        "device = hw:2  ; USB mic\n"
+        "max_duration_s = 30\n"
+        "\n"
+        "[display]\n"
+        "spi_clock_hz = 0x2000000\n"
+        "[llm]\n"
+        "ollama_url = \"http://pi:11434/api/generate#x\"\n"
+        "think_mode = hide\n"
+        "temperature = 0.25\n");
+
+    config_t config;
+    assert_int_equal(config_load(temp_file_path(), &config), RES_OK);
+
+    assert_string_equal(config.audio.device, "hw:2");
+    assert_int_equal(config.audio.max_duration_s, 30);
+    assert_int_equal(config.display.spi_clock_hz, 32 * 1024 * 1024);
+    assert_string_equal(config.llm.ollama_url, "http://pi:11434/api/generate#x");
+    assert_string_equal(config.llm.think_mode, "hide");
+    assert_true(config.llm.temperature == 0.25);
+
+    // Not in file
+    config_t defaults;
+    config_defaults(&defaults);
+    assert_int_equal(config.audio.period_frames, defaults.audio.period_frames);
+    assert_string_equal(config.llm.ollama_model, defaults.llm.ollama_model);
+}
+
+static void test_config_load_unknown_key_is_ignored( void ** state ) {
+    (void) state;
+
+    write_config(
+        "[audio]\n"
+        "no_such_key = 1\n"
+        "max_duration_s = 10\n");
+
+    config_t config;
+    assert_int_equal(config_load(temp_file_path(), &config), RES_OK);
+    assert_int_equal(config.audio.max_duration_s, 10);
+}
+
+static void test_config_load_rejects_wrong_values( void ** state ) {
+    (void) state;
+
+    const char * wrong[] = {
+        "[audio]\nmax_duration_s = 0\n",
+        "[audio]\nmax_duration_s = -5\n",
+        "[audio]\nmax_duration_s = 12s\n",
+        "[llm]\nthink_mode = sometimes\n",
+        "[llm]\ntemperature = 2.5\n",
+        "[llm]\ntemperature = warm\n",
+        "[llm]\nbackend =\n",
+        "[llm]\nollama_url = \"unterminated\n",
+        "[audio\ndevice = hw:0\n",
+        "[audio]\ndevice hw:0\n",
+        "[audio]\nperiod_frames = 6000\nbuffer_frames = 8000\n",
+        "[display]\nspi_probe = 2\n",
+    };
+
+    for( size_t i = 0; i < sizeof(wrong) / sizeof(wrong[0]); i++ ) {
+        write_config(wrong[i]);
+        config_t config;
+        assert_int_not_equal(config_load(temp_file_path(), &config), RES_OK);
+    }
+}
+
+static void test_config_init_without_file_uses_defaults( void ** state ) {
+    (void) state;
+
+    unlink(temp_file_path());
+    assert_int_equal(config_init(temp_file_path()), RES_OK);
+
+    config_t config;
+    config_t defaults;
+    config_get(&config);
+    config_defaults(&defaults);
+    assert_string_equal(config.audio.device, defaults.audio.device);
+    assert_string_equal(config.llm.backend, defaults.llm.backend);
+    assert_int_equal(config.controls.debounce_us, defaults.controls.debounce_us);
+    assert_true(config.llm.temperature == defaults.llm.temperature);
+}
+
+static void test_config_reload_keeps_structural_settings( void ** state ) {
+    (void) state;
+
+    write_config(
+        "[controls]\n"
+        "debounce_us = 5000\n"
+        "[llm]\n"
+        "backend = ollama\n");
+    assert_int_equal(config_init(temp_file_path()), RES_OK);
+
+    write_config(
+        "[controls]\n"
+        "debounce_us = 7000\n"
+        "[llm]\n"
+        "backend = llama\n");
+    assert_int_equal(config_reload(), RES_OK);
+
+    config_t config;
+    config_get(&config);
+    assert_int_equal(config.controls.debounce_us, 7000);
+    assert_string_equal(config.llm.backend, "ollama");
+}
+
+static void test_config_reload_broken_file_keeps_old( void ** state ) {
+    (void) state;
+
+    write_config("[controls]\ndebounce_us = 5000\n");
+    assert_int_equal(config_init(temp_file_path()), RES_OK);
+
+    write_config("[controls]\ndebounce_us = lots\n");
+    assert_int_not_equal(config_reload(), RES_OK);
+
+    config_t config;
+    config_get(&config);
+    assert_int_equal(config.controls.debounce_us, 5000);
+}
+
+static void test_config_wrong_args( void ** state ) {
+    (void) state;
+
+    config_t config;
+    assert_int_equal(config_load(NULL, &config), RES_ERR_NULL_PTR);
+    assert_int_equal(config_load(temp_file_path(), NULL), RES_ERR_NULL_PTR);
+    assert_int_equal(config_init(NULL), RES_ERR_NULL_PTR);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        TEMP_FILE_UNIT_TEST(test_config_load_overrides_defaults),
+        TEMP_FILE_UNIT_TEST(test_config_load_unknown_key_is_ignored),
+        TEMP_FILE_UNIT_TEST(test_config_load_rejects_wrong_values),
+        TEMP_FILE_UNIT_TEST(test_config_init_without_file_uses_defaults),
+        TEMP_FILE_UNIT_TEST(test_config_reload_keeps_structural_settings),
+        TEMP_FILE_UNIT_TEST(test_config_reload_broken_file_keeps_old),
+        TEMP_FILE_UNIT_TEST(test_config_wrong_args),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
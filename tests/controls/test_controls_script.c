@@ -0,0 +1,136 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "controls_script.h"
+#include "temp_file.h"
+
+#define MAX_RECORDED    8
+
+typedef struct {
+    button_gpio_t gpio;
+    bool pressed;
+    uint64_t time_us;
+} edge_t;
+
+static edge_t edges[MAX_RECORDED];
+static atomic_int edges_count;
+
+static void record_handler( button_gpio_t gpio, bool pressed, uint64_t time_us ) {
+    int idx = atomic_load(&edges_count);
+    if( idx < MAX_RECORDED ) {
+        edges[idx] = (edge_t){ .gpio = gpio, .pressed = pressed, .time_us = time_us };
+        atomic_store(&edges_count, idx + 1);
+    }
+}
+
+static void test_controls_script_parse_actions( void ** state ) {
+    (void) state;
+
+    script_step_t step;
+    assert_int_equal(controls_script_parse_line("1500 O press\n", 0, &step), RES_OK);
+    assert_int_equal(step.time_ms, 1500);
+    assert_int_equal(step.gpio, BUTTON_OK_GPIO);
+    assert_int_equal(step.action, SCRIPT_ACTION_PRESS);
+    assert_int_equal(step.hold_ms, CONTROLS_SCRIPT_DEFAULT_HOLD_MS);
+
+    assert_int_equal(controls_script_parse_line("+200 > press 900  # long\n", 1500,
+        &step), RES_OK);
+    assert_int_equal(step.time_ms, 1700);
+    assert_int_equal(step.gpio, BUTTON_UP_GPIO);
+    assert_int_equal(step.hold_ms, 900);
+
+    assert_int_equal(controls_script_parse_line("10\tdown\tDOWN", 0, &step), RES_OK);
+    assert_int_equal(step.gpio, BUTTON_DOWN_GPIO);
+    assert_int_equal(step.action, SCRIPT_ACTION_DOWN);
+
+    assert_int_equal(controls_script_parse_line("20 < up", 0, &step), RES_OK);
+    assert_int_equal(step.gpio, BUTTON_DOWN_GPIO);
+    assert_int_equal(step.action, SCRIPT_ACTION_UP);
+}
+
+static void test_controls_script_parse_empty( void ** state ) {
+    (void) state;
+
+    script_step_t step;
+    assert_int_equal(controls_script_parse_line("\n", 0, &step), RES_OK);
+    assert_int_equal(step.action, SCRIPT_ACTION_NONE);
+    assert_int_equal(controls_script_parse_line("  # record, then stop\n", 0, &step),
+        RES_OK);
+    assert_int_equal(step.action, SCRIPT_ACTION_NONE);
+}
+
+static void test_controls_script_parse_wrong( void ** state ) {
+    (void) state;
+
+    const char * wrong[] = {
+        "O press",
+        "-5 O press",
+        "+ O press",
+        "10 X press",
+        "10 O tap",
+        "10 O down 100",
+        "10 O press long",
+        "10 O press 100 extra",
+        "10ms O press",
+    };
+
+    for( size_t i = 0; i < NELEMS(wrong); i++ ) {
+        script_step_t step;
+        assert_int_equal(controls_script_parse_line(wrong[i], 0, &step),
+            RES_ERR_WRONG_ARGS);
+    }
+
+    script_step_t step;
+    assert_int_equal(controls_script_parse_line(NULL, 0, &step), RES_ERR_NULL_PTR);
+    assert_int_equal(controls_script_parse_line("1 O up", 0, NULL), RES_ERR_NULL_PTR);
+}
+
+static void test_controls_script_plays_file( void ** state ) {
+    (void) state;
+
+    FILE * file = fopen(temp_file_path(), "w");
+    assert_non_null(file);
+    fputs("# Short O, then held >\n"
+          "20 O press 30\n"
+          "+60 > down\n"
+          "+40 > up\n", file);
+    fclose(file);
+
+    atomic_store(&edges_count, 0);
+    uint64_t start_us = get_current_time_us();
+    assert_int_equal(controls_script_init_buttons(temp_file_path(), record_handler), 
+        RES_OK);
+    usleep(300000);
+
+    assert_int_equal(atomic_load(&edges_count), 4);
+    assert_int_equal(edges[0].gpio, BUTTON_OK_GPIO);
+    assert_true(edges[0].pressed);
+    assert_false(edges[1].pressed);
+    assert_int_equal(edges[2].gpio, BUTTON_UP_GPIO);
+    assert_true(edges[2].pressed);
+    assert_false(edges[3].pressed);
+
+    // Timestamps follow the script exactly, delivery isn't earlier than that
+    assert_int_equal(edges[1].time_us - edges[0].time_us, 30000);
+    assert_int_equal(edges[2].time_us - edges[0].time_us, 60000);
+    assert_int_equal(edges[3].time_us - edges[2].time_us, 40000);
+    assert_true(edges[0].time_us >= start_us + 20000);
+    assert_true(get_current_time_us() >= edges[3].time_us);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_controls_script_parse_actions),
+        cmocka_unit_test(test_controls_script_parse_empty),
+        cmocka_unit_test(test_controls_script_parse_wrong),
+        TEMP_FILE_UNIT_TEST(test_controls_script_plays_file),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,194 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "gesture.h"
+
+#define MAX_RECORDED    8
+#define MS              1000ULL
+
+typedef struct {
+    gesture_t gestures[MAX_RECORDED];
+    atomic_int count;
+} gesture_record_t;
+
+static const button_gpio_t buttons[] = {
+    BUTTON_UP_GPIO, BUTTON_OK_GPIO, BUTTON_DOWN_GPIO
+};
+
+static gesture_recognizer_t recognizer = GESTURE_RECOGNIZER_INIT;
+static gesture_record_t record;
+static uint64_t t0;
+
+static void record_callback( const gesture_t * gesture, void * user_data ) {
+    gesture_record_t * rec = user_data;
+    int idx = atomic_load(&rec->count);
+    if( idx < MAX_RECORDED ) {
+        rec->gestures[idx] = *gesture;
+        atomic_store(&rec->count, idx + 1);
+    }
+}
+
+static int group_setup( void ** state ) {
+    (void) state;
+    // Timer thread is not running, long presses are checked by hand
+    return timer_service_init() == RES_OK ? 0 : -1;
+}
+
+static int setup( void ** state ) {
+    (void) state;
+    atomic_store(&record.count, 0);
+    t0 = get_current_time_us();
+    if( gesture_recognizer_init(&recognizer, buttons, NELEMS(buttons),
+            record_callback, &record) != RES_OK ) {
+        return -1;
+    }
+    gesture_recognizer_set_timing(&recognizer, 600, 300);
+    return 0;
+}
+
+static void assert_gesture( int idx, gesture_type_t type, button_gpio_t button ) {
+    assert_true(atomic_load(&record.count) > idx);
+    assert_int_equal(record.gestures[idx].type, type);
+    assert_int_equal(record.gestures[idx].button, button);
+}
+
+static void test_gesture_short_on_release( void ** state ) {
+    (void) state;
+
+    assert_int_equal(gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, true, t0), RES_OK);
+    assert_int_equal(atomic_load(&record.count), 0);
+
+    assert_int_equal(gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, false,
+        t0 + 80 * MS), RES_OK);
+    assert_int_equal(atomic_load(&record.count), 1);
+    assert_gesture(0, GESTURE_SHORT, BUTTON_OK_GPIO);
+}
+
+static void test_gesture_long_replaces_short( void ** state ) {
+    (void) state;
+
+    gesture_recognizer_edge(&recognizer, BUTTON_UP_GPIO, true, t0);
+    gesture_recognizer_timeout(&recognizer, BUTTON_UP_GPIO, t0 + 599 * MS);
+    assert_int_equal(atomic_load(&record.count), 0);
+
+    gesture_recognizer_timeout(&recognizer, BUTTON_UP_GPIO, t0 + 600 * MS);
+    assert_int_equal(atomic_load(&record.count), 1);
+    assert_gesture(0, GESTURE_LONG, BUTTON_UP_GPIO);
+
+    gesture_recognizer_edge(&recognizer, BUTTON_UP_GPIO, false, t0 + 900 * MS);
+    assert_int_equal(atomic_load(&record.count), 1);
+}
+
+static void test_gesture_double_press( void ** state ) {
+    (void) state;
+
+    gesture_recognizer_edge(&recognizer, BUTTON_DOWN_GPIO, true, t0);
+    gesture_recognizer_edge(&recognizer, BUTTON_DOWN_GPIO, false, t0 + 80 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_DOWN_GPIO, true, t0 + 250 * MS);
+    assert_int_equal(atomic_load(&record.count), 2);
+    assert_gesture(0, GESTURE_SHORT, BUTTON_DOWN_GPIO);
+    assert_gesture(1, GESTURE_DOUBLE, BUTTON_DOWN_GPIO);
+
+    // Release of second press and late timeout don't add anything
+    gesture_recognizer_timeout(&recognizer, BUTTON_DOWN_GPIO, t0 + 900 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_DOWN_GPIO, false, t0 + 1000 * MS);
+    assert_int_equal(atomic_load(&record.count), 2);
+
+    // Third press starts over
+    gesture_recognizer_edge(&recognizer, BUTTON_DOWN_GPIO, true, t0 + 1100 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_DOWN_GPIO, false, t0 + 1200 * MS);
+    assert_int_equal(atomic_load(&record.count), 3);
+    assert_gesture(2, GESTURE_SHORT, BUTTON_DOWN_GPIO);
+}
+
+static void test_gesture_slow_presses_are_short( void ** state ) {
+    (void) state;
+
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, true, t0);
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, false, t0 + 80 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, true, t0 + 500 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, false, t0 + 580 * MS);
+    assert_int_equal(atomic_load(&record.count), 2);
+    assert_gesture(0, GESTURE_SHORT, BUTTON_OK_GPIO);
+    assert_gesture(1, GESTURE_SHORT, BUTTON_OK_GPIO);
+}
+
+static void test_gesture_chord( void ** state ) {
+    (void) state;
+
+    gesture_recognizer_edge(&recognizer, BUTTON_UP_GPIO, true, t0);
+    gesture_recognizer_edge(&recognizer, BUTTON_DOWN_GPIO, true, t0 + 40 * MS);
+    assert_int_equal(atomic_load(&record.count), 1);
+    assert_gesture(0, GESTURE_CHORD, BUTTON_DOWN_GPIO);
+    assert_int_equal(record.gestures[0].chord_button, BUTTON_UP_GPIO);
+
+    gesture_recognizer_timeout(&recognizer, BUTTON_UP_GPIO, t0 + 700 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_UP_GPIO, false, t0 + 800 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_DOWN_GPIO, false, t0 + 810 * MS);
+    assert_int_equal(atomic_load(&record.count), 1);
+}
+
+static void test_gesture_repeated_edge_is_ignored( void ** state ) {
+    (void) state;
+
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, false, t0);
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, true, t0 + 10 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, true, t0 + 20 * MS);
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, false, t0 + 90 * MS);
+    assert_int_equal(atomic_load(&record.count), 1);
+    assert_gesture(0, GESTURE_SHORT, BUTTON_OK_GPIO);
+}
+
+static void test_gesture_long_from_timer( void ** state ) {
+    (void) state;
+
+    pthread_t timer_thread;
+    pthread_create(&timer_thread, NULL, timer_service_thread, NULL);
+    pthread_detach(timer_thread);
+
+    gesture_recognizer_set_timing(&recognizer, 50, 300);
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, true, get_current_time_us());
+    usleep(150000);
+    assert_int_equal(atomic_load(&record.count), 1);
+    assert_gesture(0, GESTURE_LONG, BUTTON_OK_GPIO);
+
+    gesture_recognizer_edge(&recognizer, BUTTON_OK_GPIO, false, get_current_time_us());
+    assert_int_equal(atomic_load(&record.count), 1);
+}
+
+static void test_gesture_wrong_args( void ** state ) {
+    (void) state;
+
+    gesture_recognizer_t other = GESTURE_RECOGNIZER_INIT;
+    assert_int_equal(gesture_recognizer_init(NULL, buttons, 1, record_callback, NULL),
+        RES_ERR_NULL_PTR);
+    assert_int_equal(gesture_recognizer_init(&other, buttons, 0, record_callback, NULL),
+        RES_ERR_INVALID_SIZE);
+    assert_int_equal(gesture_recognizer_init(&other, buttons, 1, NULL, NULL),
+        RES_ERR_NULL_PTR);
+    assert_int_equal(gesture_recognizer_edge(&recognizer, (button_gpio_t)99, true, t0),
+        RES_ERR_WRONG_ARGS);
+    assert_int_equal(gesture_recognizer_timeout(&recognizer, (button_gpio_t)99, t0),
+        RES_ERR_WRONG_ARGS);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup(test_gesture_short_on_release, setup),
+        cmocka_unit_test_setup(test_gesture_long_replaces_short, setup),
+        cmocka_unit_test_setup(test_gesture_double_press, setup),
+        cmocka_unit_test_setup(test_gesture_slow_presses_are_short, setup),
+        cmocka_unit_test_setup(test_gesture_chord, setup),
+        cmocka_unit_test_setup(test_gesture_repeated_edge_is_ignored, setup),
+        cmocka_unit_test_setup(test_gesture_wrong_args, setup),
+        cmocka_unit_test_setup(test_gesture_long_from_timer, setup),
+    };
+
+    return cmocka_run_group_tests(tests, group_setup, NULL);
+}
@@ -0,0 +1,330 @@
+/**
+ *******************************************************************************
+ * @file    fake_st7789.c
+ * @brief   Fake ST7789 SPI sink source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "utils.h"
+#include "fake_st7789.h"
+
+#include "driver_st7789_interface.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define CMD_IDMOFF          0x38
+#define CMD_IDMON           0x39
+#define CMD_CASET           0x2A
+#define CMD_RASET           0x2B
+#define CMD_RAMWR           0x2C
+#define CMD_RAMWRC          0x3C
+#define DC_COMMAND          0
+
+#define DEFAULT_CLOCK_HZ    8000000
+
+// Rough cost of one transfer (ioctl, CS and DC lines), on top of clocked bits
+#define TRANSACTION_OVERHEAD_NS     5000ULL
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct {
+    uint8_t dc;
+    uint8_t cmd;
+    uint8_t params[4];
+    size_t param_count;
+
+    uint16_t x_start;
+    uint16_t x_end;
+    uint16_t y_start;
+    uint16_t y_end;
+    uint16_t x;
+    uint16_t y;
+
+    uint8_t pixel_msb;
+    bool has_msb;
+} decoder_t;
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static uint16_t framebuffer[FAKE_ST7789_ROWS * FAKE_ST7789_COLUMNS];
+static decoder_t decoder;
+static fake_st7789_stats_t stats;
+static uint32_t clock_hz = DEFAULT_CLOCK_HZ;
+static bool idle;
+
+/********************
+ * STATIC FUNCTIONS *
+ ********************/
+
+static void rgb565_to_rgb888( uint16_t color, uint8_t rgb[3] OUTPUT ) {
+    uint8_t r = (uint8_t)((color >> 11) & 0x1F);
+    uint8_t g = (uint8_t)((color >> 5) & 0x3F);
+    uint8_t b = (uint8_t)(color & 0x1F);
+    rgb[0] = (uint8_t)((r << 3) | (r >> 2));
+    rgb[1] = (uint8_t)((g << 2) | (g >> 4));
+    rgb[2] = (uint8_t)((b << 3) | (b >> 2));
+}
+
+static void decode_command( uint8_t cmd ) {
+    decoder.cmd = cmd;
+    decoder.param_count = 0;
+    decoder.has_msb = false;
+    stats.commands++;
+
+    switch( cmd ) {
+        case CMD_RAMWR:
+            decoder.x = decoder.x_start;
+            decoder.y = decoder.y_start;
+            stats.windows++;
+            break;
+        case CMD_IDMON:
+            idle = true;
+            break;
+        case CMD_IDMOFF:
+            idle = false;
+            break;
+        default:
+            break;
+    }
+}
+
+static void decode_address( uint8_t data ) {
+    if( decoder.param_count >= sizeof(decoder.params) ) {
+        return;
+    }
+
+    decoder.params[decoder.param_count++] = data;
+    if( decoder.param_count < sizeof(decoder.params) ) {
+        return;
+    }
+
+    uint16_t start = (uint16_t)((decoder.params[0] << 8) | decoder.params[1]);
+    uint16_t end = (uint16_t)((decoder.params[2] << 8) | decoder.params[3]);
+    if( decoder.cmd == CMD_CASET ) {
+        decoder.x_start = start;
+        decoder.x_end = end;
+    } else {
+        decoder.y_start = start;
+        decoder.y_end = end;
+    }
+}
+
+// Pixels fill the window row by row, like panel memory with default MADCTL
+static void decode_pixel( uint8_t data ) {
+    if( !decoder.has_msb ) {
+        decoder.pixel_msb = data;
+        decoder.has_msb = true;
+        return;
+    }
+    decoder.has_msb = false;
+
+    if( decoder.x < FAKE_ST7789_COLUMNS && decoder.y < FAKE_ST7789_ROWS ) {
+        framebuffer[decoder.y * FAKE_ST7789_COLUMNS + decoder.x] =
+            (uint16_t)((decoder.pixel_msb << 8) | data);
+    }
+    stats.pixels++;
+
+    if( decoder.x < decoder.x_end ) {
+        decoder.x++;
+        return;
+    }
+    decoder.x = decoder.x_start;
+    decoder.y = (decoder.y < decoder.y_end) ? (uint16_t)(decoder.y + 1) : decoder.y_start;
+}
+
+static void decode( const uint8_t * buf, size_t len ) {
+    for( size_t i = 0; i < len; i++ ) {
+        if( decoder.dc == DC_COMMAND ) {
+            decode_command(buf[i]);
+            continue;
+        }
+
+        switch( decoder.cmd ) {
+            case CMD_CASET:
+            case CMD_RASET:
+                decode_address(buf[i]);
+                break;
+            case CMD_RAMWR:
+            case CMD_RAMWRC:
+                decode_pixel(buf[i]);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+void fake_st7789_reset( void ) {
+    memset(framebuffer, 0, sizeof(framebuffer));
+    memset(&decoder, 0, sizeof(decoder));
+    idle = false;
+    fake_st7789_reset_stats();
+}
+
+void fake_st7789_reset_stats( void ) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void fake_st7789_get_stats( fake_st7789_stats_t * out OUTPUT ) {
+    *out = stats;
+}
+
+uint64_t fake_st7789_bus_time_us( const fake_st7789_stats_t * s ) {
+    uint64_t clock = clock_hz ? clock_hz : DEFAULT_CLOCK_HZ;
+    uint64_t ns = s->bytes * 8ULL * 1000000000ULL / clock +
+        s->transactions * TRANSACTION_OVERHEAD_NS;
+    return ns / 1000;
+}
+
+bool fake_st7789_idle( void ) {
+    return idle;
+}
+
+uint16_t fake_st7789_pixel( uint16_t x, uint16_t y ) {
+    if( x >= FAKE_ST7789_COLUMNS || y >= FAKE_ST7789_ROWS ) {
+        return 0;
+    }
+    return framebuffer[y * FAKE_ST7789_COLUMNS + x];
+}
+
+result_t fake_st7789_write_ppm( const char * path, uint16_t width, uint16_t height ) {
+    RETURN_IF_NULL(path);
+    RETURN_ERROR_IF( width > FAKE_ST7789_COLUMNS || height > FAKE_ST7789_ROWS,
+        RES_ERR_WRONG_ARGS );
+
+    FILE * file = fopen(path, "wb");
+    RETURN_IF_NULL(file);
+
+    fprintf(file, "P6\n%u %u\n255\n", width, height);
+    for( uint16_t y = 0; y < height; y++ ) {
+        for( uint16_t x = 0; x < width; x++ ) {
+            uint8_t rgb[3];
+            rgb565_to_rgb888(fake_st7789_pixel(x, y), rgb);
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+    }
+
+    return fclose(file) == 0 ? RES_OK : RES_ERR_GENERIC;
+}
+
+result_t fake_st7789_compare_ppm( const char * path, uint16_t width,
+        uint16_t height, uint32_t * diff_pixels OUTPUT ) {
+    RETURN_IF_NULL(path);
+    RETURN_IF_NULL(diff_pixels);
+
+    FILE * file = fopen(path, "rb");
+    RETURN_ERROR_IF( !file, RES_ERR_NOT_READY );
+
+    unsigned int w = 0;
+    unsigned int h = 0;
+    unsigned int max = 0;
+    if( fscanf(file, "P6 %u %u %u", &w, &h, &max) != 3 || fgetc(file) == EOF ||
+            w != width || h != height || max != 255 ) {
+        fclose(file);
+        return RES_ERR_INVALID_SIZE;
+    }
+
+    *diff_pixels = 0;
+    for( uint16_t y = 0; y < height; y++ ) {
+        for( uint16_t x = 0; x < width; x++ ) {
+            uint8_t expected[3];
+            uint8_t actual[3];
+            if( fread(expected, 1, sizeof(expected), file) != sizeof(expected) ) {
+                fclose(file);
+                return RES_ERR_INVALID_SIZE;
+            }
+            rgb565_to_rgb888(fake_st7789_pixel(x, y), actual);
+            if( memcmp(expected, actual, sizeof(actual)) != 0 ) {
+                (*diff_pixels)++;
+            }
+        }
+    }
+
+    fclose(file);
+    return RES_OK;
+}
+
+// === ST7789 LIBRARY INTERFACE ===
+
+uint8_t st7789_interface_spi_init( void ) {
+    return 0;
+}
+
+uint8_t st7789_interface_spi_set_clock( uint32_t freq ) {
+    clock_hz = freq;
+    return 0;
+}
+
+uint8_t st7789_interface_spi_deinit( void ) {
+    return 0;
+}
+
+uint8_t st7789_interface_spi_write_cmd( uint8_t * buf, uint16_t len ) {
+    stats.transactions++;
+    stats.bytes += len;
+    decode(buf, len);
+    return 0;
+}
+
+// Nothing is read back, so the SPI probe finds no display and is skipped
+uint8_t st7789_interface_spi_write_read( uint8_t * in_buf, uint32_t in_len,
+        uint8_t * out_buf, uint32_t out_len ) {
+    stats.transactions++;
+    stats.bytes += in_len + out_len;
+    decode(in_buf, in_len);
+    memset(out_buf, 0, out_len);
+    return 0;
+}
+
+void st7789_interface_delay_ms( uint32_t ms UNUSED_PARAM ) {
+}
+
+void st7789_interface_debug_print( const char * const fmt, ... ) {
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+uint8_t st7789_interface_cmd_data_gpio_init( void ) {
+    return 0;
+}
+
+uint8_t st7789_interface_cmd_data_gpio_deinit( void ) {
+    return 0;
+}
+
+uint8_t st7789_interface_cmd_data_gpio_write( uint8_t value ) {
+    decoder.dc = value;
+    return 0;
+}
+
+uint8_t st7789_interface_reset_gpio_init( void ) {
+    return 0;
+}
+
+uint8_t st7789_interface_reset_gpio_deinit( void ) {
+    return 0;
+}
+
+uint8_t st7789_interface_reset_gpio_write( uint8_t value UNUSED_PARAM ) {
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+ *******************************************************************************
+ * @file    fake_st7789.h
+ * @brief   Fake ST7789 SPI sink header file.
+ *          Implements ST7789 library interface for tests. Written bytes are
+ *          decoded (CASET, RASET, RAMWR, RAMWRC, IDMON, IDMOFF) into panel
+ *          framebuffer and idle state and counted, so rendered frames and bus traffic can be checked.
+ *******************************************************************************
+ */
+
+#ifndef FAKE_ST7789_H
+#define FAKE_ST7789_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "utils.h"
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define FAKE_ST7789_COLUMNS     240
+#define FAKE_ST7789_ROWS        320     // Panel memory, only part is visible
+
+/************
+ * TYPEDEFS *
+ ************/
+
+typedef struct {
+    uint64_t bytes;             // Both directions
+    uint64_t transactions;      // SPI transfers, each with its own setup cost
+    uint64_t commands;
+    uint64_t windows;           // RAMWR commands
+    uint64_t pixels;
+} fake_st7789_stats_t;
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern void fake_st7789_reset( void );
+extern void fake_st7789_reset_stats( void );
+extern void fake_st7789_get_stats( fake_st7789_stats_t * stats OUTPUT );
+extern uint64_t fake_st7789_bus_time_us( const fake_st7789_stats_t * stats );
+
+extern bool fake_st7789_idle( void );
+extern uint16_t fake_st7789_pixel( uint16_t x, uint16_t y );
+extern result_t fake_st7789_write_ppm( const char * path, uint16_t width,
+    uint16_t height );
+extern result_t fake_st7789_compare_ppm( const char * path, uint16_t width,
+    uint16_t height, uint32_t * diff_pixels OUTPUT );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAKE_ST7789_H */
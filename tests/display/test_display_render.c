@@ -0,0 +1,231 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "config.h"
+#include "display.h"
+#include "display_hw.h"
+#include "fake_st7789.h"
+
+// Goldens are regenerated with UPDATE_GOLDEN=1 make test
+#define GOLDEN_DIR          "tests/display/golden"
+#define ACTUAL_DIR          "/tmp"
+#define STREAM_TOKEN_SIZE   5
+
+static const char * answer_text =
+    "A display controller keeps its own frame memory, so only changed "
+    "areas have to be sent over SPI. Every window costs a few command "
+    "bytes and one transfer setup, while every pixel costs two bytes.\n\n"
+    "Za\xC5\xBC\xC3\xB3\xC5\x82\xC4\x87 g\xC4\x99\xC5\x9Bl\xC4\x85 "
+    "ja\xC5\xBA\xC5\x84 \xE2\x80\x94 Polish letters and typographic "
+    "quotes \xE2\x80\x9Clike these\xE2\x80\x9D are drawn from the font "
+    "pack, not replaced by question marks. Long answers scroll: when the "
+    "last row is reached, the screen is cleared and text continues from "
+    "the top, and the full answer can be read page by page later on.";
+
+static display_menu_t menu = DEFAULT_DISPLAY_MENU;
+
+static uint64_t now_us( void ) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void scenario_begin( uint64_t * start_us ) {
+    fake_st7789_reset_stats();
+    *start_us = now_us();
+}
+
+// Frame is compared with golden image, bus traffic is only reported
+static void scenario_end( const char * name, uint64_t start_us ) {
+    uint64_t render_us = now_us() - start_us;
+    fake_st7789_stats_t stats;
+    fake_st7789_get_stats(&stats);
+
+    printf("%s: %llu bytes, %llu transactions, %llu windows, "
+        "%llu pixels, ~%llu us on bus, %llu us to render\n", name,
+        (unsigned long long)stats.bytes, (unsigned long long)stats.transactions,
+        (unsigned long long)stats.windows, (unsigned long long)stats.pixels,
+        (unsigned long long)fake_st7789_bus_time_us(&stats),
+        (unsigned long long)render_us);
+
+    char golden[256];
+    snprintf(golden, sizeof(golden), "%s/%s.ppm", GOLDEN_DIR, name);
+    if( getenv("UPDATE_GOLDEN") ) {
+        assert_int_equal(fake_st7789_write_ppm(golden, DISP_WIDTH, DISP_HEIGHT), RES_OK);
+        return;
+    }
+
+    uint32_t diff = 0;
+    result_t res = fake_st7789_compare_ppm(golden, DISP_WIDTH, DISP_HEIGHT, &diff);
+    if( res != RES_OK || diff > 0 ) {
+        char actual[256];
+        snprintf(actual, sizeof(actual), "%s/%s.actual.ppm", ACTUAL_DIR, name);
+        fake_st7789_write_ppm(actual, DISP_WIDTH, DISP_HEIGHT);
+        fprintf(stderr, "%s: %u pixels differ from %s, frame written to %s\n",
+            name, diff, golden, actual);
+    }
+    assert_int_equal(res, RES_OK);
+    assert_int_equal(diff, 0);
+}
+
+static int setup( void ** state ) {
+    (void) state;
+
+    // Defaults are enough, there is no config file
+    config_init(GOLDEN_DIR "/none.conf");
+    fake_st7789_reset();
+    return display_init() == RES_OK ? 0 : -1;
+}
+
+static void test_display_render_init( void ** state ) {
+    (void) state;
+
+    // Visible part of panel memory is cleared
+    for( uint16_t y = 0; y < DISP_HEIGHT; y += 7 ) {
+        for( uint16_t x = 0; x < DISP_WIDTH; x += 7 ) {
+            assert_int_equal(fake_st7789_pixel(x, y), 0);
+        }
+    }
+}
+
+static void test_display_render_welcome( void ** state ) {
+    (void) state;
+
+    uint64_t start_us;
+    scenario_begin(&start_us);
+
+    display_menu_clear(&menu);
+    display_menu_append_text(&menu, "Welcome!\n", COLOR_TIP);
+    display_menu_append_text(&menu, "> To start recording, press \"O\".\n", COLOR_TIP);
+    display_menu_append_text(&menu, "> To stop any processing, press \"O\" again.\n", COLOR_TIP);
+    display_menu_append_text(&menu, "> To start a new conversation, press \"<\".\n", COLOR_TIP);
+    display_menu_append_text(&menu, "> To skip thinking, hold \"O\".\n", COLOR_TIP);
+    assert_int_equal(display_menu_flush(&menu), RES_OK);
+
+    scenario_end("welcome", start_us);
+}
+
+static void test_display_render_streaming_answer( void ** state ) {
+    (void) state;
+
+    uint64_t start_us;
+    scenario_begin(&start_us);
+
+    display_menu_clear(&menu);
+    display_menu_append_text(&menu, "Recording...\n", COLOR_STATUS);
+    display_menu_update_line(&menu, "Transcribing... 50%", COLOR_STATUS);
+    display_menu_update_line(&menu, "Transcribing... 100%", COLOR_STATUS);
+    display_menu_new_line(&menu);
+    display_menu_append_text(&menu, "How does a display driver save time?\n", COLOR_STATUS);
+
+    // Tokens also split UTF-8 characters, like bytes coming from the LLM.
+    // Whole answer is streamed twice, so the screen scrolls.
+    char token[STREAM_TOKEN_SIZE + 1];
+    for( int pass = 0; pass < 2; pass++ ) {
+        size_t len = strlen(answer_text);
+        for( size_t i = 0; i < len; i += STREAM_TOKEN_SIZE ) {
+            size_t n = len - i < STREAM_TOKEN_SIZE ? len - i : STREAM_TOKEN_SIZE;
+            memcpy(token, &answer_text[i], n);
+            token[n] = '\0';
+            assert_int_equal(display_menu_append_text(&menu, token, COLOR_PARTIAL_ANSWER),
+                RES_OK);
+        }
+        display_menu_new_line(&menu);
+    }
+    display_menu_append_text(&menu, "Pipeline done.\n", COLOR_STATUS);
+    assert_int_equal(display_menu_flush(&menu), RES_OK);
+
+    scenario_end("streaming_answer", start_us);
+}
+
+static void test_display_render_merges_updates( void ** state ) {
+    (void) state;
+
+    // Right after a flush, next frame is at least one period away
+    display_menu_clear(&menu);
+    display_menu_append_text(&menu, "Tokens: ", COLOR_STATUS);
+    assert_int_equal(display_menu_flush(&menu), RES_OK);
+
+    fake_st7789_reset_stats();
+    assert_int_equal(display_menu_append_text(&menu, "one ", COLOR_PARTIAL_ANSWER), RES_OK);
+    assert_int_equal(display_menu_append_text(&menu, "two ", COLOR_PARTIAL_ANSWER), RES_OK);
+    assert_int_equal(display_menu_append_text(&menu, "three", COLOR_PARTIAL_ANSWER), RES_OK);
+    assert_int_equal(display_menu_flush_due(&menu), RES_OK);
+
+    fake_st7789_stats_t stats;
+    fake_st7789_get_stats(&stats);
+    assert_int_equal(stats.bytes, 0);
+
+    // All three are drawn as one run of the same color
+    assert_int_equal(display_menu_flush(&menu), RES_OK);
+    fake_st7789_get_stats(&stats);
+    assert_int_equal(stats.windows, 2);     // Text and rest of the row
+    assert_false(menu.dirty);
+}
+
+static void test_display_render_page_flip( void ** state ) {
+    (void) state;
+
+    text_layout_t layout;
+    assert_int_equal(display_menu_layout_init(&layout), RES_OK);
+    for( int i = 0; i < 3; i++ ) {
+        assert_int_equal(text_layout_append(&layout, answer_text, strlen(answer_text),
+            COLOR_FULL_OUTPUT, NULL), RES_OK);
+        assert_int_equal(text_layout_append(&layout, "\n\n", 2, COLOR_FULL_OUTPUT, NULL),
+            RES_OK);
+    }
+
+    uint32_t rows = display_menu_page_rows();
+    assert_true(text_layout_rows(&layout) > rows);
+    assert_int_equal(display_menu_show_rows(&menu, &layout, 0, rows), RES_OK);
+
+    // Only the flip to the next page is measured
+    uint64_t start_us;
+    scenario_begin(&start_us);
+    assert_int_equal(display_menu_show_rows(&menu, &layout, rows, rows), RES_OK);
+    scenario_end("page_flip", start_us);
+
+    text_layout_free(&layout);
+}
+
+static void test_display_render_idle( void ** state ) {
+    (void) state;
+
+    display_menu_clear(&menu);
+    assert_int_equal(display_menu_flush(&menu), RES_OK);
+
+    uint64_t start_us;
+    scenario_begin(&start_us);
+    assert_int_equal(display_idle_on("Idle. Any button wakes up.", COLOR_TIP), RES_OK);
+    assert_true(fake_st7789_idle());
+    scenario_end("idle", start_us);
+
+    // Waking up only removes the hint, rest of panel memory is kept
+    assert_int_equal(display_idle_off(), RES_OK);
+    assert_false(fake_st7789_idle());
+    for( uint16_t y = 0; y < DISP_HEIGHT; y++ ) {
+        for( uint16_t x = 0; x < DISP_WIDTH; x++ ) {
+            assert_int_equal(fake_st7789_pixel(x, y), 0);
+        }
+    }
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_display_render_init),
+        cmocka_unit_test(test_display_render_welcome),
+        cmocka_unit_test(test_display_render_streaming_answer),
+        cmocka_unit_test(test_display_render_merges_updates),
+        cmocka_unit_test(test_display_render_page_flip),
+        cmocka_unit_test(test_display_render_idle),
+    };
+
+    return cmocka_run_group_tests(tests, setup, NULL);
+}
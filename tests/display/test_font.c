@@ -0,0 +1,143 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "font.h"
+
+#define PACK    (&font_pack_6x12)
+
+static font_cache_t cache;
+
+static uint32_t decode_one( const char * text ) {
+    const char * p = text;
+    return font_utf8_next(&p, text + strlen(text));
+}
+
+static void test_font_utf8_decode( void ** state ) {
+    (void) state;
+
+    const char * text = "a\xC3\xA9\xE2\x80\x94\xF0\x9F\x98\x80";
+    const char * end = text + strlen(text);
+    const char * p = text;
+    assert_int_equal(font_utf8_next(&p, end), 'a');
+    assert_int_equal(font_utf8_next(&p, end), 0xE9);
+    assert_int_equal(font_utf8_next(&p, end), 0x2014);
+    assert_int_equal(font_utf8_next(&p, end), 0x1F600);
+    assert_true(p == end);
+}
+
+static void test_font_utf8_invalid( void ** state ) {
+    (void) state;
+
+    // Overlong, surrogate, stray continuation and truncated sequences
+    assert_int_equal(decode_one("\xC0\xAF"), FONT_REPLACEMENT_CHAR);
+    assert_int_equal(decode_one("\xED\xA0\x80"), FONT_REPLACEMENT_CHAR);
+    assert_int_equal(decode_one("\x80"), FONT_REPLACEMENT_CHAR);
+    assert_int_equal(decode_one("\xE2\x80"), FONT_REPLACEMENT_CHAR);
+
+    // Only the bad byte is consumed, the next character survives
+    const char * text = "\xC3" "b";
+    const char * p = text;
+    assert_int_equal(font_utf8_next(&p, text + 2), FONT_REPLACEMENT_CHAR);
+    assert_int_equal(font_utf8_next(&p, text + 2), 'b');
+}
+
+static void test_font_utf8_incomplete_tail( void ** state ) {
+    (void) state;
+
+    assert_int_equal(font_utf8_incomplete_tail("abc", 3), 0);
+    assert_int_equal(font_utf8_incomplete_tail("a\xC3", 2), 1);
+    assert_int_equal(font_utf8_incomplete_tail("a\xE2\x80", 3), 2);
+    assert_int_equal(font_utf8_incomplete_tail("a\xF0\x9F\x98", 4), 3);
+    assert_int_equal(font_utf8_incomplete_tail("a\xE2\x80\x94", 4), 0);
+    assert_int_equal(font_utf8_incomplete_tail("", 0), 0);
+}
+
+static void test_font_every_glyph_is_found( void ** state ) {
+    (void) state;
+
+    for( size_t i = 0; i < PACK->glyph_count; i++ ) {
+        const font_glyph_t * glyph = font_find_glyph(PACK, PACK->glyphs[i].codepoint);
+        assert_true(glyph == &PACK->glyphs[i]);
+    }
+}
+
+static void test_font_fallbacks( void ** state ) {
+    (void) state;
+
+    // Accented letter without glyph falls back to its base letter
+    assert_int_equal(font_find_glyph(PACK, 0x011B)->codepoint, 'e');
+    assert_int_equal(font_find_glyph(PACK, 0x2212)->codepoint, '-');
+    assert_int_equal(font_find_glyph(PACK, 0x00A0)->codepoint, ' ');
+    assert_int_equal(font_find_glyph(PACK, 0x1F600)->codepoint, FONT_REPLACEMENT_CHAR);
+
+    // Own glyphs win over fallbacks
+    assert_int_equal(font_find_glyph(PACK, 0x0119)->codepoint, 0x0119);
+    assert_int_equal(font_find_glyph(PACK, 0x2019)->codepoint, 0x2019);
+
+    assert_null(font_find_glyph(PACK, 0xFE0F));
+    assert_null(font_find_glyph(PACK, '\n'));
+    assert_null(font_find_glyph(NULL, 'a'));
+}
+
+static void test_font_text_width_and_fit( void ** state ) {
+    (void) state;
+
+    const font_glyph_t * i = font_find_glyph(PACK, 'i');
+    const font_glyph_t * m = font_find_glyph(PACK, 'm');
+    assert_true(i->advance < m->advance);
+
+    const char * text = "i\xC5\x82m";
+    uint16_t width = font_text_width(PACK, text, strlen(text));
+    assert_int_equal(width, i->advance + font_find_glyph(PACK, 0x0142)->advance + m->advance);
+
+    // Fit stops at whole characters
+    uint16_t fitted = 0;
+    size_t bytes = font_text_fit(PACK, text, strlen(text), (uint16_t)(width - 1), &fitted);
+    assert_int_equal(bytes, 3);
+    assert_int_equal(fitted, width - m->advance);
+    assert_int_equal(font_text_fit(PACK, text, strlen(text), 0, &fitted), 0);
+    assert_int_equal(fitted, 0);
+}
+
+static void test_font_cache( void ** state ) {
+    (void) state;
+
+    memset(&cache, 0, sizeof(cache));
+    const font_glyph_t * glyph = font_find_glyph(PACK, '|');
+    const uint16_t * pixels = font_cache_get(&cache, PACK, glyph, 0xFFFF, 0x0000);
+    assert_non_null(pixels);
+    assert_int_equal(cache.misses, 1);
+
+    // Bar is one full-height column
+    assert_int_equal(glyph->width, 1);
+    for( size_t row = 0; row < PACK->height; row++ ) {
+        assert_int_equal(pixels[row], 0xFFFF);
+    }
+
+    assert_true(font_cache_get(&cache, PACK, glyph, 0xFFFF, 0x0000) == pixels);
+    assert_int_equal(cache.hits, 1);
+
+    // Other color is rasterized again
+    const uint16_t * other = font_cache_get(&cache, PACK, glyph, 0x001F, 0x0000);
+    assert_non_null(other);
+    assert_int_equal(other[0], 0x001F);
+    assert_int_equal(cache.misses, 2);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_font_utf8_decode),
+        cmocka_unit_test(test_font_utf8_invalid),
+        cmocka_unit_test(test_font_utf8_incomplete_tail),
+        cmocka_unit_test(test_font_every_glyph_is_found),
+        cmocka_unit_test(test_font_fallbacks),
+        cmocka_unit_test(test_font_text_width_and_fit),
+        cmocka_unit_test(test_font_cache),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
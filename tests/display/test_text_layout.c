@@ -0,0 +1,203 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "text_layout.h"
+
+#define PACK            (&font_pack_6x12)
+#define COLOR_A         0x1111
+#define COLOR_B         0x2222
+
+static uint16_t width_of( const char * text ) {
+    return font_text_width(PACK, text, strlen(text));
+}
+
+static void append( text_layout_t * layout, const char * text, uint32_t color ) {
+    assert_int_equal(text_layout_append(layout, text, strlen(text), color, NULL), RES_OK);
+}
+
+static void assert_line( const text_layout_t * layout, size_t idx, const char * text,
+        uint32_t row, uint16_t x ) {
+    assert_true(idx < layout->line_count);
+    const text_line_t * line = &layout->lines[idx];
+    assert_int_equal(line->length, strlen(text));
+    assert_memory_equal(&layout->text[line->offset], text, strlen(text));
+    assert_int_equal(line->row, row);
+    assert_int_equal(line->x, x);
+    assert_int_equal(line->width, width_of(text));
+}
+
+static void test_text_layout_wraps_at_width( void ** state ) {
+    (void) state;
+
+    text_layout_t layout;
+    assert_int_equal(text_layout_init(&layout, PACK, width_of("hello world")), RES_OK);
+
+    append(&layout, "hello world again", COLOR_A);
+    assert_int_equal(layout.line_count, 2);
+    assert_line(&layout, 0, "hello world", 0, 0);
+    assert_line(&layout, 1, "again", 1, 0);
+    assert_int_equal(text_layout_rows(&layout), 2);
+
+    text_layout_free(&layout);
+}
+
+static void test_text_layout_newlines( void ** state ) {
+    (void) state;
+
+    text_layout_t layout;
+    assert_int_equal(text_layout_init(&layout, PACK, 240), RES_OK);
+
+    // Blank row has no line, final "\n" leaves empty open line not counted
+    append(&layout, "one\n\nthree\n", COLOR_A);
+    assert_int_equal(layout.line_count, 3);
+    assert_line(&layout, 0, "one", 0, 0);
+    assert_line(&layout, 1, "three", 2, 0);
+    assert_line(&layout, 2, "", 3, 0);
+    assert_int_equal(text_layout_rows(&layout), 3);
+    assert_int_equal(text_layout_row_line(&layout, 1), 1);
+    assert_int_equal(text_layout_row_line(&layout, 2), 1);
+
+    text_layout_free(&layout);
+}
+
+static void test_text_layout_incremental_equals_whole( void ** state ) {
+    (void) state;
+
+    const char * text = "The quick brown fox jumps over the lazy dog, "
+        "then \xC5\xBC\xC3\xB3\xC5\x82w sleeps.\nAnd again the quick brown fox.";
+    uint16_t width = width_of("The quick brown fox");
+
+    text_layout_t whole;
+    assert_int_equal(text_layout_init(&whole, PACK, width), RES_OK);
+    append(&whole, text, COLOR_A);
+
+    // Tokens of three bytes also split UTF-8 characters
+    text_layout_t tokens;
+    assert_int_equal(text_layout_init(&tokens, PACK, width), RES_OK);
+    size_t len = strlen(text);
+    for( size_t i = 0; i < len; i += 3 ) {
+        size_t n = len - i < 3 ? len - i : 3;
+        size_t first_changed = 0;
+        assert_int_equal(text_layout_append(&tokens, &text[i], n, COLOR_A,
+            &first_changed), RES_OK);
+        assert_true(first_changed < tokens.line_count);
+    }
+
+    assert_int_equal(tokens.line_count, whole.line_count);
+    assert_memory_equal(tokens.lines, whole.lines, whole.line_count * sizeof(text_line_t));
+
+    text_layout_free(&whole);
+    text_layout_free(&tokens);
+}
+
+static void test_text_layout_incomplete_utf8_waits( void ** state ) {
+    (void) state;
+
+    text_layout_t layout;
+    assert_int_equal(text_layout_init(&layout, PACK, 240), RES_OK);
+
+    append(&layout, "a\xC3", COLOR_A);
+    assert_int_equal(layout.laid_out_len, 1);
+    assert_line(&layout, 0, "a", 0, 0);
+
+    append(&layout, "\xA9", COLOR_A);
+    assert_int_equal(layout.laid_out_len, 3);
+    assert_line(&layout, 0, "a\xC3\xA9", 0, 0);
+
+    text_layout_free(&layout);
+}
+
+static void test_text_layout_color_runs( void ** state ) {
+    (void) state;
+
+    text_layout_t layout;
+    assert_int_equal(text_layout_init(&layout, PACK, 240), RES_OK);
+
+    append(&layout, "status ", COLOR_A);
+    size_t first_changed = 0;
+    assert_int_equal(text_layout_append(&layout, "answer", 6, COLOR_B, &first_changed),
+        RES_OK);
+
+    // Earlier line stays, the new one continues the row
+    assert_int_equal(first_changed, 1);
+    assert_int_equal(layout.line_count, 2);
+    assert_line(&layout, 0, "status ", 0, 0);
+    assert_line(&layout, 1, "answer", 0, width_of("status "));
+    assert_int_equal(layout.lines[1].color, COLOR_B);
+    assert_int_equal(text_layout_rows(&layout), 1);
+
+    text_layout_free(&layout);
+}
+
+static void test_text_layout_long_word_split( void ** state ) {
+    (void) state;
+
+    uint16_t width = width_of("abcd");
+    text_layout_t layout;
+    assert_int_equal(text_layout_init(&layout, PACK, width), RES_OK);
+
+    append(&layout, "abcdefghij", COLOR_A);
+    assert_int_equal(text_layout_rows(&layout), 3);
+    for( size_t i = 0; i < layout.line_count; i++ ) {
+        assert_true(layout.lines[i].width <= width);
+        assert_int_equal(layout.lines[i].row, i);
+    }
+
+    text_layout_free(&layout);
+}
+
+static void test_text_layout_truncate_row( void ** state ) {
+    (void) state;
+
+    text_layout_t layout;
+    assert_int_equal(text_layout_init(&layout, PACK, 240), RES_OK);
+
+    append(&layout, "keep\nprogress 10%", COLOR_A);
+    assert_int_equal(text_layout_truncate_row(&layout, 1), RES_OK);
+    append(&layout, "progress 20%", COLOR_A);
+
+    assert_int_equal(layout.line_count, 2);
+    assert_line(&layout, 0, "keep", 0, 0);
+    assert_line(&layout, 1, "progress 20%", 1, 0);
+    assert_string_equal(layout.text, "keep\nprogress 20%");
+
+    text_layout_free(&layout);
+}
+
+static void test_text_layout_clear( void ** state ) {
+    (void) state;
+
+    text_layout_t layout;
+    assert_int_equal(text_layout_init(&layout, PACK, 240), RES_OK);
+    assert_int_equal(text_layout_rows(&layout), 0);
+
+    append(&layout, "some text\n", COLOR_A);
+    text_layout_clear(&layout);
+    assert_int_equal(text_layout_rows(&layout), 0);
+
+    append(&layout, "new", COLOR_B);
+    assert_int_equal(layout.line_count, 1);
+    assert_line(&layout, 0, "new", 0, 0);
+
+    text_layout_free(&layout);
+    assert_true(layout.pack == PACK);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_text_layout_wraps_at_width),
+        cmocka_unit_test(test_text_layout_newlines),
+        cmocka_unit_test(test_text_layout_incremental_equals_whole),
+        cmocka_unit_test(test_text_layout_incomplete_utf8_waits),
+        cmocka_unit_test(test_text_layout_color_runs),
+        cmocka_unit_test(test_text_layout_long_word_split),
+        cmocka_unit_test(test_text_layout_truncate_row),
+        cmocka_unit_test(test_text_layout_clear),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
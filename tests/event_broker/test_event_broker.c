@@ -55,6 +55,85 @@ static void test_broker_publish_event_queue_full( void ** state ) {
     assert_int_equal(broker_publish(&e), RES_ERR_GENERIC);
 }
 
+static void test_broker_publish_coalesced_queue_space( void ** state ) {
+    (void) state;
+
+    event_t e;
+    for( int i = 0; i < 4 * EVENT_QUEUE_SIZE; i++ ) {
+        event_create(COMPONENT_STT, COMPONENT_CORE_DISP, EVENT_STT_STATUS, &i, sizeof(i), &e);
+        assert_int_equal(broker_publish_coalesced(&e), RES_OK);
+    }
+
+    event_t e_pop;
+    assert_int_equal(broker_pop(COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e, &e_pop, sizeof(event_t));
+    assert_int_equal(broker_pop(COMPONENT_CORE_DISP, &e_pop), RES_ERR_GENERIC);
+}
+
+static void test_broker_subscribe_fanout( void ** state ) {
+    (void) state;
+
+    assert_int_equal(broker_subscribe(COMPONENT_STT, EVENT_LLM_STATUS), RES_OK);
+    assert_int_equal(broker_subscribe(COMPONENT_AUDIO_INPUT, EVENT_LLM_STATUS), RES_OK);
+
+    event_t e, e_pop;
+    event_create(COMPONENT_LLM, COMPONENT_CORE_DISP, EVENT_LLM_STATUS, "data", 5, &e);
+    assert_int_equal(broker_publish(&e), RES_OK);
+
+    assert_int_equal(broker_pop(COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e, &e_pop, sizeof(event_t));
+    assert_int_equal(broker_pop(COMPONENT_STT, &e_pop), RES_OK);
+    assert_memory_equal(&e, &e_pop, sizeof(event_t));
+    assert_int_equal(broker_pop(COMPONENT_AUDIO_INPUT, &e_pop), RES_OK);
+    assert_memory_equal(&e, &e_pop, sizeof(event_t));
+    assert_int_equal(broker_pop(COMPONENT_STT, &e_pop), RES_ERR_GENERIC);
+}
+
+static void test_broker_subscriber_never_drains( void ** state ) {
+    (void) state;
+
+    assert_int_equal(broker_subscribe(COMPONENT_STT, EVENT_LLM_STATUS), RES_OK);
+
+    // Dest keeps up, subscriber never pops
+    event_t e, e_pop;
+    for( int i = 0; i < 4 * EVENT_QUEUE_SIZE; i++ ) {
+        event_create(COMPONENT_LLM, COMPONENT_CORE_DISP, EVENT_LLM_STATUS, &i, sizeof(i), &e);
+        assert_int_equal(broker_publish(&e), RES_OK);
+        assert_int_equal(broker_pop(COMPONENT_CORE_DISP, &e_pop), RES_OK);
+        assert_memory_equal(&e, &e_pop, sizeof(event_t));
+    }
+
+    // Oldest copies were given up, the newest ones are still there
+    assert_int_equal(broker_dropped(COMPONENT_STT), 3 * EVENT_QUEUE_SIZE + 1);
+    assert_int_equal(broker_dropped(COMPONENT_CORE_DISP), 0);
+    uint32_t left = 0;
+    while( broker_pop(COMPONENT_STT, &e_pop) == RES_OK ) {
+        left++;
+    }
+    assert_int_equal(left, EVENT_QUEUE_SIZE - 1);
+    assert_memory_equal(&e, &e_pop, sizeof(event_t));
+}
+
+static void test_broker_unsubscribe( void ** state ) {
+    (void) state;
+
+    assert_int_equal(broker_subscribe(COMPONENT_STT, EVENT_LLM_STATUS), RES_OK);
+    assert_int_equal(broker_unsubscribe(COMPONENT_STT, EVENT_LLM_STATUS), RES_OK);
+
+    event_t e, e_pop;
+    event_create(COMPONENT_LLM, COMPONENT_CORE_DISP, EVENT_LLM_STATUS, "data", 5, &e);
+    assert_int_equal(broker_publish(&e), RES_OK);
+
+    assert_int_equal(broker_pop(COMPONENT_STT, &e_pop), RES_ERR_GENERIC);
+    assert_int_equal(broker_pop(COMPONENT_CORE_DISP, &e_pop), RES_OK);
+}
+
+static void test_broker_subscribe_wrong_args( void ** state ) {
+    (void) state;
+    assert_int_equal(broker_subscribe(COMPONENT_COUNT, EVENT_LLM_STATUS), RES_ERR_WRONG_ARGS);
+    assert_int_equal(broker_subscribe(COMPONENT_STT, EVENT_TYPE_COUNT), RES_ERR_WRONG_ARGS);
+}
+
 int main( void ) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup(test_broker_publish_and_pop_success, setup),
@@ -62,6 +141,11 @@ int main( void ) {
         cmocka_unit_test_setup(test_broker_null_event_publish, setup),
         cmocka_unit_test_setup(test_broker_null_event_pop, setup),
         cmocka_unit_test_setup(test_broker_publish_event_queue_full, setup),
+        cmocka_unit_test_setup(test_broker_publish_coalesced_queue_space, setup),
+        cmocka_unit_test_setup(test_broker_subscribe_fanout, setup),
+        cmocka_unit_test_setup(test_broker_subscriber_never_drains, setup),
+        cmocka_unit_test_setup(test_broker_unsubscribe, setup),
+        cmocka_unit_test_setup(test_broker_subscribe_wrong_args, setup),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -1,6 +1,8 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include <pthread.h>
 #include <setjmp.h>
 #include <cmocka.h>
@@ -92,6 +94,174 @@ static void test_event_queue_push_pop_randomized( void ** state ) {
     }
 }
 
+static void test_event_queue_push_coalesced_replaces_undelivered( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+
+    event_t e, e_pop;
+    for( int i = 0; i < 10; i++ ) {
+        event_create(COMPONENT_STT, COMPONENT_CORE_DISP, 
+            EVENT_STT_STATUS, 
+            &i, sizeof(i), 
+            &e);
+        assert_int_equal(event_queue_push_coalesced(&q, &e), RES_OK);
+    }
+
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e, &e_pop, sizeof(event_t));
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_ERR_GENERIC);
+}
+
+static void test_event_queue_push_coalesced_keeps_plain_events( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+
+    event_t e_plain, e_coalesced, e_pop;
+    event_create(COMPONENT_STT, COMPONENT_CORE_DISP, 
+        EVENT_STT_STATUS, 
+        "start", 6, 
+        &e_plain);
+    assert_int_equal(event_queue_push(&q, &e_plain), RES_OK);
+
+    event_create(COMPONENT_STT, COMPONENT_CORE_DISP, 
+        EVENT_STT_STATUS, 
+        "progress", 9, 
+        &e_coalesced);
+    assert_int_equal(event_queue_push_coalesced(&q, &e_coalesced), RES_OK);
+
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e_plain, &e_pop, sizeof(event_t));
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e_coalesced, &e_pop, sizeof(event_t));
+}
+
+static void test_event_queue_push_coalesced_keeps_order( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+
+    event_t e_old, e_other, e_new, e_pop;
+    event_create(COMPONENT_AUDIO_INPUT, COMPONENT_CORE_DISP, 
+        EVENT_REC_STATUS, 
+        "1s", 3, 
+        &e_old);
+    assert_int_equal(event_queue_push_coalesced(&q, &e_old), RES_OK);
+
+    event_create(COMPONENT_AUDIO_INPUT, COMPONENT_CORE_DISP, 
+        EVENT_REC_STATUS, 
+        "done", 5, 
+        &e_other);
+    assert_int_equal(event_queue_push(&q, &e_other), RES_OK);
+
+    event_create(COMPONENT_AUDIO_INPUT, COMPONENT_CORE_DISP, 
+        EVENT_REC_STATUS, 
+        "2s", 3, 
+        &e_new);
+    assert_int_equal(event_queue_push_coalesced(&q, &e_new), RES_OK);
+
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e_other, &e_pop, sizeof(event_t));
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e_new, &e_pop, sizeof(event_t));
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_ERR_GENERIC);
+}
+
+static void test_event_queue_push_coalesced_different_keys( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+
+    event_t e_rec, e_stt, e_pop;
+    event_create(COMPONENT_AUDIO_INPUT, COMPONENT_CORE_DISP, 
+        EVENT_REC_STATUS, 
+        NULL, 0, 
+        &e_rec);
+    event_create(COMPONENT_STT, COMPONENT_CORE_DISP, 
+        EVENT_STT_STATUS, 
+        NULL, 0, 
+        &e_stt);
+    assert_int_equal(event_queue_push_coalesced(&q, &e_rec), RES_OK);
+    assert_int_equal(event_queue_push_coalesced(&q, &e_stt), RES_OK);
+
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e_rec, &e_pop, sizeof(event_t));
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e_stt, &e_pop, sizeof(event_t));
+}
+
+static void test_event_queue_push_fanout_shares_slot( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+
+    event_t e, e_pop;
+    event_create(COMPONENT_LLM, COMPONENT_CORE_DISP, 
+        EVENT_LLM_STATUS, 
+        "token", 6, 
+        &e);
+    assert_int_equal(event_queue_push_fanout(&q, &e, 
+        COMPONENT_BIT(COMPONENT_CORE_DISP) | COMPONENT_BIT(COMPONENT_CONTROLS)), RES_OK);
+    assert_int_equal((q.tail - q.head + EVENT_QUEUE_SIZE) % EVENT_QUEUE_SIZE, 1);
+
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_memory_equal(&e, &e_pop, sizeof(event_t));
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_ERR_GENERIC);
+
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CONTROLS, &e_pop), RES_OK);
+    assert_memory_equal(&e, &e_pop, sizeof(event_t));
+    assert_int_equal(q.head, q.tail);
+}
+
+static void test_event_queue_push_fanout_keeps_dest_events( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+
+    uint32_t consumers = COMPONENT_BIT(COMPONENT_CORE_DISP) | 
+        COMPONENT_BIT(COMPONENT_CONTROLS);
+    event_t e;
+    event_create(COMPONENT_LLM, COMPONENT_CORE_DISP, 
+        EVENT_LLM_STATUS, 
+        NULL, 0, 
+        &e);
+
+    // Subscriber copies are not given up while dest still waits for them
+    for( size_t i = 0; i < EVENT_QUEUE_SIZE - 1; i++ ) {
+        assert_int_equal(event_queue_push_fanout(&q, &e, consumers), RES_OK);
+    }
+    assert_int_equal(event_queue_push_fanout(&q, &e, consumers), RES_ERR_GENERIC);
+    assert_int_equal(event_queue_dropped(&q, COMPONENT_CONTROLS), 0);
+
+    // Once dest popped one, its slot can be reused
+    event_t e_pop;
+    assert_int_equal(event_queue_pop(&q, COMPONENT_CORE_DISP, &e_pop), RES_OK);
+    assert_int_equal(event_queue_push_fanout(&q, &e, consumers), RES_OK);
+    assert_int_equal(event_queue_dropped(&q, COMPONENT_CONTROLS), 1);
+    assert_int_equal(event_queue_dropped(&q, COMPONENT_CORE_DISP), 0);
+}
+
+static void test_event_queue_push_fanout_no_consumers( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+
+    event_t e;
+    event_create(COMPONENT_LLM, COMPONENT_CORE_DISP, 
+        EVENT_LLM_STATUS, 
+        NULL, 0, 
+        &e);
+    assert_int_equal(event_queue_push_fanout(&q, &e, 0), RES_ERR_WRONG_ARGS);
+}
+
 static void * producer_thread( void * arg ) {
     event_queue_t * q = arg;
     event_t e;
@@ -135,6 +305,129 @@ static void test_event_queue_multithreaded( void ** state ) {
     assert_int_equal(q.head, q.tail);
 }
 
+static uint64_t elapsed_ms( const struct timespec * start ) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)((now.tv_sec - start->tv_sec) * 1000 + 
+        (now.tv_nsec - start->tv_nsec) / 1000000);
+}
+
+static void test_event_queue_pop_timeout_expires( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    event_t e;
+    assert_int_equal(event_queue_pop_timeout(&q, COMPONENT_CORE_DISP, &e, 50), 
+        RES_ERR_GENERIC);
+    assert_true(elapsed_ms(&start) >= 50);
+}
+
+static void * delayed_producer_thread( void * arg ) {
+    event_queue_t * q = arg;
+    usleep(20000);
+
+    event_t e;
+    event_create(COMPONENT_CONTROLS, COMPONENT_CORE_DISP, 
+        EVENT_BUT_PRESSED, 
+        NULL, 0, 
+        &e);
+    event_queue_push(q, &e);
+
+    return NULL;
+}
+
+static void test_event_queue_pop_timeout_wakes_on_push( void ** state ) {
+    (void)state;
+
+    pthread_t prod_thread;
+    event_queue_t q;
+    event_queue_init(&q);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&prod_thread, NULL, delayed_producer_thread, &q);
+
+    // Blocked consumer gets event right away, not after timeout
+    event_t e;
+    assert_int_equal(event_queue_pop_timeout(&q, COMPONENT_CORE_DISP, &e, 
+        EVENT_QUEUE_WAIT_FOREVER), RES_OK);
+    assert_int_equal(e.type, EVENT_BUT_PRESSED);
+    assert_true(elapsed_ms(&start) < 1000);
+
+    pthread_join(prod_thread, NULL);
+}
+
+static void fill_queue( event_queue_t * q ) {
+    event_t e;
+    event_create(COMPONENT_CONTROLS, COMPONENT_CORE_DISP, 
+        EVENT_BUT_PRESSED, 
+        NULL, 0, 
+        &e);
+    for( size_t i = 0; i < EVENT_QUEUE_SIZE - 1; i++ ) {
+        assert_int_equal(event_queue_push(q, &e), RES_OK);
+    }
+}
+
+static void test_event_queue_push_timeout_expires( void ** state ) {
+    (void)state;
+
+    event_queue_t q;
+    event_queue_init(&q);
+    fill_queue(&q);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    event_t e;
+    event_create(COMPONENT_LLM, COMPONENT_CORE_DISP, 
+        EVENT_LLM_STATUS, 
+        NULL, 0, 
+        &e);
+    assert_int_equal(event_queue_push_fanout_timeout(&q, &e, 
+        COMPONENT_BIT(COMPONENT_CORE_DISP), 50), RES_ERR_GENERIC);
+    assert_true(elapsed_ms(&start) >= 50);
+}
+
+static void * delayed_consumer_thread( void * arg ) {
+    event_queue_t * q = arg;
+    usleep(20000);
+
+    event_t e;
+    event_queue_pop(q, COMPONENT_CORE_DISP, &e);
+
+    return NULL;
+}
+
+static void test_event_queue_push_timeout_waits_for_space( void ** state ) {
+    (void)state;
+
+    pthread_t cons_thread;
+    event_queue_t q;
+    event_queue_init(&q);
+    fill_queue(&q);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&cons_thread, NULL, delayed_consumer_thread, &q);
+
+    // Producer is held back until the consumer frees a slot
+    event_t e;
+    event_create(COMPONENT_LLM, COMPONENT_CORE_DISP, 
+        EVENT_LLM_STATUS, 
+        NULL, 0, 
+        &e);
+    assert_int_equal(event_queue_push_fanout_timeout(&q, &e, 
+        COMPONENT_BIT(COMPONENT_CORE_DISP), EVENT_QUEUE_WAIT_FOREVER), RES_OK);
+    assert_true(elapsed_ms(&start) < 1000);
+
+    pthread_join(cons_thread, NULL);
+}
+
 int main( void ) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_event_queue_init_success),
@@ -143,6 +436,17 @@ int main( void ) {
         cmocka_unit_test(test_event_queue_pop_empty_queue),
         cmocka_unit_test(test_event_queue_push_pop_randomized),
         cmocka_unit_test(test_event_queue_multithreaded),
+        cmocka_unit_test(test_event_queue_push_coalesced_replaces_undelivered),
+        cmocka_unit_test(test_event_queue_push_coalesced_keeps_plain_events),
+        cmocka_unit_test(test_event_queue_push_coalesced_keeps_order),
+        cmocka_unit_test(test_event_queue_push_coalesced_different_keys),
+        cmocka_unit_test(test_event_queue_push_fanout_shares_slot),
+        cmocka_unit_test(test_event_queue_push_fanout_keeps_dest_events),
+        cmocka_unit_test(test_event_queue_push_fanout_no_consumers),
+        cmocka_unit_test(test_event_queue_pop_timeout_expires),
+        cmocka_unit_test(test_event_queue_pop_timeout_wakes_on_push),
+        cmocka_unit_test(test_event_queue_push_timeout_expires),
+        cmocka_unit_test(test_event_queue_push_timeout_waits_for_space),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
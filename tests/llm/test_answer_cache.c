@@ -0,0 +1,247 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "answer_cache.h"
+#include "temp_file.h"
+
+#define TEST_CACHE_SIZE     (64 * 1024)
+#define TEST_KEY_SIZE       256
+
+static size_t make_key( const char * transcript, char * key ) {
+    size_t key_len = 0;
+    assert_int_equal(answer_cache_make_key(transcript, "model", "{}",
+        key, TEST_KEY_SIZE, &key_len), RES_OK);
+    return key_len;
+}
+
+static void test_answer_cache_make_key_normalizes( void ** state ) {
+    (void) state;
+
+    char key_a[TEST_KEY_SIZE];
+    char key_b[TEST_KEY_SIZE];
+    size_t len_a = make_key("What is  the\nweather?", key_a);
+    size_t len_b = make_key("  what is THE weather ", key_b);
+
+    assert_int_equal(len_a, len_b);
+    assert_memory_equal(key_a, key_b, len_a);
+    assert_string_equal(key_a, "what is the weather\nmodel\n{}");
+}
+
+static void test_answer_cache_make_key_includes_model( void ** state ) {
+    (void) state;
+
+    char key_a[TEST_KEY_SIZE];
+    char key_b[TEST_KEY_SIZE];
+    size_t len_a = 0;
+    size_t len_b = 0;
+    assert_int_equal(answer_cache_make_key("hello", "model-a", "{}",
+        key_a, sizeof(key_a), &len_a), RES_OK);
+    assert_int_equal(answer_cache_make_key("hello", "model-b", "{}",
+        key_b, sizeof(key_b), &len_b), RES_OK);
+
+    assert_int_equal(len_a, len_b);
+    assert_memory_not_equal(key_a, key_b, len_a);
+}
+
+static void test_answer_cache_make_key_too_long( void ** state ) {
+    (void) state;
+
+    char key[8];
+    size_t key_len = 0;
+    assert_int_equal(answer_cache_make_key("hello world", "model", "{}",
+        key, sizeof(key), &key_len), RES_ERR_INVALID_SIZE);
+}
+
+static void test_answer_cache_store_and_lookup( void ** state ) {
+    (void) state;
+
+    answer_cache_t cache = ANSWER_CACHE_INIT;
+    assert_int_equal(answer_cache_open(&cache, temp_file_path(), TEST_CACHE_SIZE),
+        RES_OK);
+
+    char key[TEST_KEY_SIZE];
+    size_t key_len = make_key("hello", key);
+
+    const char * answer = NULL;
+    size_t answer_len = 0;
+    assert_int_equal(answer_cache_lookup(&cache, key, key_len, &answer, &answer_len), RES_OK);
+    assert_null(answer);
+
+    assert_int_equal(answer_cache_store(&cache, key, key_len, "hi there", 8), RES_OK);
+    assert_int_equal(answer_cache_lookup(&cache, key, key_len, &answer, &answer_len), RES_OK);
+    assert_non_null(answer);
+    assert_int_equal(answer_len, 8);
+    assert_memory_equal(answer, "hi there", 8);
+
+    // Newer answer replaces the old one
+    assert_int_equal(answer_cache_store(&cache, key, key_len, "hey", 3), RES_OK);
+    assert_int_equal(answer_cache_lookup(&cache, key, key_len, &answer, &answer_len), RES_OK);
+    assert_int_equal(answer_len, 3);
+    assert_memory_equal(answer, "hey", 3);
+
+    answer_cache_close(&cache);
+}
+
+static void test_answer_cache_persists( void ** state ) {
+    (void) state;
+
+    char key[TEST_KEY_SIZE];
+    size_t key_len = make_key("persistent question", key);
+
+    answer_cache_t cache = ANSWER_CACHE_INIT;
+    assert_int_equal(answer_cache_open(&cache, temp_file_path(), TEST_CACHE_SIZE),
+        RES_OK);
+    assert_int_equal(answer_cache_store(&cache, key, key_len, "answer", 6), RES_OK);
+    answer_cache_close(&cache);
+
+    assert_int_equal(answer_cache_open(&cache, temp_file_path(), TEST_CACHE_SIZE),
+        RES_OK);
+    const char * answer = NULL;
+    size_t answer_len = 0;
+    assert_int_equal(answer_cache_lookup(&cache, key, key_len, &answer, &answer_len), RES_OK);
+    assert_non_null(answer);
+    assert_memory_equal(answer, "answer", 6);
+    answer_cache_close(&cache);
+}
+
+static void test_answer_cache_evicts_least_recently_used( void ** state ) {
+    (void) state;
+
+    answer_cache_t cache = ANSWER_CACHE_INIT;
+    assert_int_equal(answer_cache_open(&cache, temp_file_path(), TEST_CACHE_SIZE),
+        RES_OK);
+
+    static char big_answer[8 * 1024];
+    memset(big_answer, 'a', sizeof(big_answer));
+
+    char key_first[TEST_KEY_SIZE];
+    size_t key_first_len = make_key("first", key_first);
+    char key_second[TEST_KEY_SIZE];
+    size_t key_second_len = make_key("second", key_second);
+
+    assert_int_equal(answer_cache_store(&cache, key_first, key_first_len,
+        big_answer, sizeof(big_answer)), RES_OK);
+    assert_int_equal(answer_cache_store(&cache, key_second, key_second_len,
+        big_answer, sizeof(big_answer)), RES_OK);
+
+    // "first" is asked all the time, "second" never again
+    const char * answer = NULL;
+    size_t answer_len = 0;
+    char key[TEST_KEY_SIZE];
+    for( int i = 0; i < 6; i++ ) {
+        assert_int_equal(answer_cache_lookup(&cache, key_first, key_first_len,
+            &answer, &answer_len), RES_OK);
+        assert_non_null(answer);
+
+        char transcript[16];
+        snprintf(transcript, sizeof(transcript), "filler %d", i);
+        size_t key_len = make_key(transcript, key);
+        assert_int_equal(answer_cache_store(&cache, key, key_len,
+            big_answer, sizeof(big_answer)), RES_OK);
+    }
+
+    assert_int_equal(answer_cache_lookup(&cache, key_second, key_second_len,
+        &answer, &answer_len), RES_OK);
+    assert_null(answer);
+    assert_int_equal(answer_cache_lookup(&cache, key_first, key_first_len,
+        &answer, &answer_len), RES_OK);
+    assert_non_null(answer);
+    assert_int_equal(answer_len, sizeof(big_answer));
+
+    answer_cache_close(&cache);
+}
+
+static void test_answer_cache_index_grows_and_reloads( void ** state ) {
+    (void) state;
+
+    answer_cache_t cache = ANSWER_CACHE_INIT;
+    assert_int_equal(answer_cache_open(&cache, temp_file_path(), TEST_CACHE_SIZE),
+        RES_OK);
+
+    // More records than initial index holds, every second one superseded
+    char key[TEST_KEY_SIZE];
+    char transcript[32];
+    char text[32];
+    for( int pass = 0; pass < 2; pass++ ) {
+        for( int i = 0; i < 100; i += 1 + pass ) {
+            snprintf(transcript, sizeof(transcript), "question %d", i);
+            snprintf(text, sizeof(text), "answer %d.%d", i, pass);
+            size_t key_len = make_key(transcript, key);
+            assert_int_equal(answer_cache_store(&cache, key, key_len,
+                text, strlen(text)), RES_OK);
+        }
+    }
+    assert_int_equal(cache.index_count, 100);
+
+    for( int reopen = 0; reopen < 2; reopen++ ) {
+        for( int i = 0; i < 100; i++ ) {
+            snprintf(transcript, sizeof(transcript), "question %d", i);
+            snprintf(text, sizeof(text), "answer %d.%d", i, i % 2 == 0 ? 1 : 0);
+            size_t key_len = make_key(transcript, key);
+
+            const char * answer = NULL;
+            size_t answer_len = 0;
+            assert_int_equal(answer_cache_lookup(&cache, key, key_len,
+                &answer, &answer_len), RES_OK);
+            assert_non_null(answer);
+            assert_int_equal(answer_len, strlen(text));
+            assert_memory_equal(answer, text, answer_len);
+        }
+
+        answer_cache_close(&cache);
+        assert_int_equal(answer_cache_open(&cache, temp_file_path(), TEST_CACHE_SIZE),
+        RES_OK);
+    }
+
+    answer_cache_close(&cache);
+}
+
+static void test_answer_cache_too_big_answer( void ** state ) {
+    (void) state;
+
+    answer_cache_t cache = ANSWER_CACHE_INIT;
+    assert_int_equal(answer_cache_open(&cache, temp_file_path(), TEST_CACHE_SIZE),
+        RES_OK);
+
+    char key[TEST_KEY_SIZE];
+    size_t key_len = make_key("huge", key);
+    static char huge_answer[TEST_CACHE_SIZE];
+    assert_int_equal(answer_cache_store(&cache, key, key_len,
+        huge_answer, sizeof(huge_answer)), RES_ERR_INVALID_SIZE);
+
+    answer_cache_close(&cache);
+}
+
+static void test_answer_cache_wrong_args( void ** state ) {
+    (void) state;
+
+    answer_cache_t cache = ANSWER_CACHE_INIT;
+    assert_int_equal(answer_cache_open(NULL, temp_file_path(), TEST_CACHE_SIZE), RES_ERR_NULL_PTR);
+    assert_int_equal(answer_cache_open(&cache, NULL, TEST_CACHE_SIZE), RES_ERR_NULL_PTR);
+    assert_int_equal(answer_cache_open(&cache, temp_file_path(), 1024), RES_ERR_WRONG_ARGS);
+
+    const char * answer = NULL;
+    size_t answer_len = 0;
+    assert_int_equal(answer_cache_lookup(&cache, "k", 1, &answer, &answer_len), RES_ERR_NULL_PTR);
+    assert_int_equal(answer_cache_store(&cache, "k", 1, "a", 1), RES_ERR_NULL_PTR);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_answer_cache_make_key_normalizes),
+        cmocka_unit_test(test_answer_cache_make_key_includes_model),
+        cmocka_unit_test(test_answer_cache_make_key_too_long),
+        TEMP_FILE_UNIT_TEST(test_answer_cache_store_and_lookup),
+        TEMP_FILE_UNIT_TEST(test_answer_cache_persists),
+        TEMP_FILE_UNIT_TEST(test_answer_cache_evicts_least_recently_used),
+        TEMP_FILE_UNIT_TEST(test_answer_cache_index_grows_and_reloads),
+        TEMP_FILE_UNIT_TEST(test_answer_cache_too_big_answer),
+        TEMP_FILE_UNIT_TEST(test_answer_cache_wrong_args),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
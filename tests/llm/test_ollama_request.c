@@ -0,0 +1,142 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ollama_request.h"
+
+static config_t test_config( void ) {
+    config_t config;
+    config_defaults(&config);
+    config.llm.ollama_num_thread = 3;
+    config.llm.ollama_num_ctx = 2048;
+    config.llm.max_answer_tokens = 256;
+    config.llm.temperature = 0.5;
+    return config;
+}
+
+static void test_ollama_request_body( void ** state ) {
+    (void) state;
+
+    ollama_request_t request = OLLAMA_REQUEST_INIT;
+    assert_int_equal(ollama_request_init(&request, "deepseek-r1:1.5b"), RES_OK);
+
+    config_t config = test_config();
+    char * body = ollama_request_build(&request, &config, NULL, "Hi", NULL, 0);
+    assert_non_null(body);
+    assert_string_equal(body,
+        "{\"model\":\"deepseek-r1:1.5b\",\"keep_alive\":\"5m\","
+        "\"options\":{\"num_thread\":3,\"num_ctx\":2048,\"num_predict\":256,"
+        "\"temperature\":0.5},\"prompt\":\"Hi\"}");
+    free(body);
+}
+
+static void test_ollama_request_escapes_prompt( void ** state ) {
+    (void) state;
+
+    ollama_request_t request = OLLAMA_REQUEST_INIT;
+    assert_int_equal(ollama_request_init(&request, "m"), RES_OK);
+
+    config_t config = test_config();
+    char * body = ollama_request_build(&request, &config, NULL,
+        "say \"hi\"\\\n\tzażółć\x01", NULL, 0);
+    assert_non_null(body);
+    const char * prompt = strstr(body, "\"prompt\":");
+    assert_non_null(prompt);
+    assert_string_equal(prompt,
+        "\"prompt\":\"say \\\"hi\\\"\\\\\\n\\tzażółć\\u0001\"}");
+    free(body);
+}
+
+static void test_ollama_request_context_and_overrides( void ** state ) {
+    (void) state;
+
+    ollama_request_t request = OLLAMA_REQUEST_INIT;
+    assert_int_equal(ollama_request_init(&request, "m"), RES_OK);
+
+    config_t config = test_config();
+    config.llm.ollama_num_thread = 0;       // Server default, not sent
+    config.llm.ollama_num_ctx = 0;
+    const int context[] = { 1, -2, 300 };
+    const ollama_options_t overrides = {
+        .has_num_predict = true,
+        .num_predict = 0
+    };
+
+    char * body = ollama_request_build(&request, &config, &overrides, "x",
+        context, 3);
+    assert_non_null(body);
+    assert_string_equal(body,
+        "{\"model\":\"m\",\"keep_alive\":\"5m\","
+        "\"options\":{\"num_predict\":0,\"temperature\":0.5},"
+        "\"prompt\":\"x\",\"context\":[1,-2,300]}");
+    free(body);
+}
+
+static void test_ollama_request_template_follows_config( void ** state ) {
+    (void) state;
+
+    ollama_request_t request = OLLAMA_REQUEST_INIT;
+    assert_int_equal(ollama_request_init(&request, "m"), RES_OK);
+
+    config_t config = test_config();
+    const ollama_options_t prefill = { .has_num_predict = true, .num_predict = 0 };
+
+    // Generation and prefill alternate, both templates are kept
+    for( int i = 0; i < 3; i++ ) {
+        char * body = ollama_request_build(&request, &config, NULL, "a", NULL, 0);
+        assert_non_null(strstr(body, "\"num_predict\":256"));
+        free(body);
+        body = ollama_request_build(&request, &config, &prefill, "a", NULL, 0);
+        assert_non_null(strstr(body, "\"num_predict\":0"));
+        free(body);
+    }
+
+    // Reloaded config
+    config.llm.max_answer_tokens = 64;
+    char * body = ollama_request_build(&request, &config, NULL, "a", NULL, 0);
+    assert_non_null(strstr(body, "\"num_predict\":64"));
+    free(body);
+}
+
+static void test_ollama_request_options_json( void ** state ) {
+    (void) state;
+
+    config_t config = test_config();
+    char json[OLLAMA_MAX_OPTIONS_SIZE];
+    assert_int_equal(ollama_request_options_json(&config, NULL, json, sizeof(json)), RES_OK);
+    assert_string_equal(json,
+        "{\"num_thread\":3,\"num_ctx\":2048,\"num_predict\":256,\"temperature\":0.5}");
+
+    char small[8];
+    assert_int_equal(ollama_request_options_json(&config, NULL, small, sizeof(small)),
+        RES_ERR_INVALID_SIZE);
+}
+
+static void test_ollama_request_wrong_args( void ** state ) {
+    (void) state;
+
+    ollama_request_t request = OLLAMA_REQUEST_INIT;
+    config_t config = test_config();
+    assert_int_equal(ollama_request_init(NULL, "m"), RES_ERR_NULL_PTR);
+    assert_int_equal(ollama_request_init(&request, NULL), RES_ERR_NULL_PTR);
+    assert_null(ollama_request_build(&request, &config, NULL, NULL, NULL, 0));
+    assert_null(ollama_request_build(&request, &config, NULL, "a", NULL, 2));
+    assert_null(ollama_request_build(NULL, &config, NULL, "a", NULL, 0));
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ollama_request_body),
+        cmocka_unit_test(test_ollama_request_escapes_prompt),
+        cmocka_unit_test(test_ollama_request_context_and_overrides),
+        cmocka_unit_test(test_ollama_request_template_follows_config),
+        cmocka_unit_test(test_ollama_request_options_json),
+        cmocka_unit_test(test_ollama_request_wrong_args),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
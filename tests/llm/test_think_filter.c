@@ -0,0 +1,132 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "think_filter.h"
+
+typedef struct {
+    char answer[256];
+    char think[256];
+    int begins;
+    int ends;
+} collected_t;
+
+static void collect( think_segment_t segment, const char * data, size_t size,
+        void * user_data ) {
+    collected_t * c = user_data;
+    switch( segment ) {
+        case THINK_SEGMENT_ANSWER:
+            strncat(c->answer, data, size);
+            break;
+        case THINK_SEGMENT_THINK:
+            strncat(c->think, data, size);
+            break;
+        case THINK_SEGMENT_THINK_BEGIN:
+            assert_int_equal(size, 0);
+            c->begins++;
+            break;
+        case THINK_SEGMENT_THINK_END:
+            assert_int_equal(size, 0);
+            c->ends++;
+            break;
+    }
+}
+
+static void feed_in_chunks( think_filter_t * filter, const char * text,
+        size_t chunk_size ) {
+    size_t len = strlen(text);
+    for( size_t off = 0; off < len; off += chunk_size ) {
+        size_t n = (len - off < chunk_size) ? len - off : chunk_size;
+        assert_int_equal(think_filter_feed(filter, text + off, n), RES_OK);
+    }
+    assert_int_equal(think_filter_flush(filter), RES_OK);
+}
+
+static void test_think_filter_splits_sections( void ** state ) {
+    (void) state;
+
+    collected_t c = {0};
+    think_filter_t filter;
+    assert_int_equal(think_filter_init(&filter, collect, &c), RES_OK);
+
+    feed_in_chunks(&filter, "<think>\nLet me see.\n</think>\n\nHello!", 64);
+
+    assert_string_equal(c.think, "\nLet me see.\n");
+    assert_string_equal(c.answer, "Hello!");
+    assert_int_equal(c.begins, 1);
+    assert_int_equal(c.ends, 1);
+}
+
+static void test_think_filter_tags_split_between_chunks( void ** state ) {
+    (void) state;
+
+    const char * text = "<think>abc</think>answer <b>x</b> a<b";
+
+    for( size_t chunk_size = 1; chunk_size <= 8; chunk_size++ ) {
+        collected_t c = {0};
+        think_filter_t filter;
+        assert_int_equal(think_filter_init(&filter, collect, &c), RES_OK);
+
+        feed_in_chunks(&filter, text, chunk_size);
+
+        assert_string_equal(c.think, "abc");
+        assert_string_equal(c.answer, "answer <b>x</b> a<b");
+        assert_int_equal(c.begins, 1);
+        assert_int_equal(c.ends, 1);
+    }
+}
+
+static void test_think_filter_false_tag_start( void ** state ) {
+    (void) state;
+
+    collected_t c = {0};
+    think_filter_t filter;
+    assert_int_equal(think_filter_init(&filter, collect, &c), RES_OK);
+
+    feed_in_chunks(&filter, "<<think>x</thin</think>y <thinking", 3);
+
+    assert_string_equal(c.answer, "<y <thinking");
+    assert_string_equal(c.think, "x</thin");
+    assert_int_equal(c.begins, 1);
+    assert_int_equal(c.ends, 1);
+}
+
+static void test_think_filter_no_think_section( void ** state ) {
+    (void) state;
+
+    collected_t c = {0};
+    think_filter_t filter;
+    assert_int_equal(think_filter_init(&filter, collect, &c), RES_OK);
+
+    feed_in_chunks(&filter, "  Plain answer\n", 4);
+
+    assert_string_equal(c.answer, "  Plain answer\n");
+    assert_string_equal(c.think, "");
+    assert_int_equal(c.begins, 0);
+    assert_int_equal(c.ends, 0);
+}
+
+static void test_think_filter_wrong_args( void ** state ) {
+    (void) state;
+
+    think_filter_t filter;
+    assert_int_equal(think_filter_init(NULL, collect, NULL), RES_ERR_NULL_PTR);
+    assert_int_equal(think_filter_init(&filter, NULL, NULL), RES_ERR_NULL_PTR);
+    assert_int_equal(think_filter_feed(NULL, "a", 1), RES_ERR_NULL_PTR);
+    assert_int_equal(think_filter_flush(NULL), RES_ERR_NULL_PTR);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_think_filter_splits_sections),
+        cmocka_unit_test(test_think_filter_tags_split_between_chunks),
+        cmocka_unit_test(test_think_filter_false_tag_start),
+        cmocka_unit_test(test_think_filter_no_think_section),
+        cmocka_unit_test(test_think_filter_wrong_args),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
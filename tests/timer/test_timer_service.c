@@ -0,0 +1,203 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "timer_service.h"
+
+typedef struct {
+    atomic_int count;
+    atomic_uint_fast64_t first_fire_us;
+} fire_record_t;
+
+typedef struct {
+    atomic_int calls;
+    atomic_int in_callback;
+    timer_id_t id;
+} slow_record_t;
+
+static pthread_t timer_thread;
+
+static void record_callback( void * user_data ) {
+    fire_record_t * record = user_data;
+    uint64_t expected = 0;
+    atomic_compare_exchange_strong(&record->first_fire_us, &expected, 
+        get_current_time_us());
+    atomic_fetch_add(&record->count, 1);
+}
+
+static void slow_callback( void * user_data ) {
+    slow_record_t * record = user_data;
+    atomic_store(&record->in_callback, 1);
+    atomic_fetch_add(&record->calls, 1);
+    usleep(50000);
+    atomic_store(&record->in_callback, 0);
+}
+
+static void self_stopping_callback( void * user_data ) {
+    slow_record_t * record = user_data;
+    atomic_fetch_add(&record->calls, 1);
+    timer_service_stop(record->id);
+}
+
+static int group_setup( void ** state ) {
+    (void) state;
+    assert_int_equal(timer_service_init(), RES_OK);
+    pthread_create(&timer_thread, NULL, timer_service_thread, NULL);
+    return 0;
+}
+
+static void test_timer_oneshot_fires_once( void ** state ) {
+    (void) state;
+
+    fire_record_t record = {0};
+    timer_id_t id;
+    uint64_t start_us = get_current_time_us();
+    assert_int_equal(timer_service_start_oneshot(20, record_callback, &record, &id), RES_OK);
+    assert_int_not_equal(id, TIMER_ID_INVALID);
+
+    usleep(100000);
+
+    assert_int_equal(atomic_load(&record.count), 1);
+    assert_true(atomic_load(&record.first_fire_us) - start_us >= 20000);
+}
+
+static void test_timer_periodic_fires_repeatedly( void ** state ) {
+    (void) state;
+
+    fire_record_t record = {0};
+    timer_id_t id;
+    assert_int_equal(timer_service_start_periodic(10, record_callback, &record, &id), RES_OK);
+
+    usleep(105000);
+    assert_int_equal(timer_service_stop(id), RES_OK);
+    int count = atomic_load(&record.count);
+    assert_in_range(count, 8, 11);
+
+    usleep(50000);
+    assert_int_equal(atomic_load(&record.count), count);
+}
+
+static void test_timer_stop_before_expiry( void ** state ) {
+    (void) state;
+
+    fire_record_t record = {0};
+    timer_id_t id;
+    assert_int_equal(timer_service_start_oneshot(30, record_callback, &record, &id), RES_OK);
+    assert_int_equal(timer_service_stop(id), RES_OK);
+
+    usleep(60000);
+    assert_int_equal(atomic_load(&record.count), 0);
+    assert_int_equal(timer_service_stop(id), RES_ERR_WRONG_ARGS);
+}
+
+static void test_timer_stop_waits_for_running_callback( void ** state ) {
+    (void) state;
+
+    slow_record_t record = {0};
+    timer_id_t id;
+    assert_int_equal(timer_service_start_periodic(10, slow_callback, &record, &id), RES_OK);
+    while( atomic_load(&record.in_callback) == 0 ) {
+        usleep(1000);
+    }
+
+    // Nothing may run after stop returns, e.g. late progress event
+    assert_int_equal(timer_service_stop(id), RES_OK);
+    assert_int_equal(atomic_load(&record.in_callback), 0);
+    int calls = atomic_load(&record.calls);
+    usleep(60000);
+    assert_int_equal(atomic_load(&record.calls), calls);
+}
+
+static void test_timer_stop_from_own_callback( void ** state ) {
+    (void) state;
+
+    slow_record_t record = {0};
+    assert_int_equal(timer_service_start_periodic(10, self_stopping_callback, &record, 
+        &record.id), RES_OK);
+
+    usleep(60000);
+    assert_int_equal(atomic_load(&record.calls), 1);
+    assert_int_equal(timer_service_stop(record.id), RES_ERR_WRONG_ARGS);
+}
+
+static void test_timer_long_delay_cascades( void ** state ) {
+    (void) state;
+
+    // Beyond the first wheel level, so it has to be cascaded down
+    fire_record_t record = {0};
+    timer_id_t id;
+    uint64_t start_us = get_current_time_us();
+    assert_int_equal(timer_service_start_oneshot(300, record_callback, &record, &id), RES_OK);
+
+    usleep(250000);
+    assert_int_equal(atomic_load(&record.count), 0);
+    usleep(150000);
+    assert_int_equal(atomic_load(&record.count), 1);
+
+    uint64_t fired_after_us = atomic_load(&record.first_fire_us) - start_us;
+    assert_in_range(fired_after_us, 300000, 340000);
+}
+
+static void test_timer_oneshots_fire_in_order( void ** state ) {
+    (void) state;
+
+    fire_record_t early = {0};
+    fire_record_t late = {0};
+    timer_id_t id_early, id_late;
+    assert_int_equal(timer_service_start_oneshot(40, record_callback, &late, &id_late), RES_OK);
+    assert_int_equal(timer_service_start_oneshot(10, record_callback, &early, &id_early), RES_OK);
+
+    usleep(80000);
+    assert_int_equal(atomic_load(&early.count), 1);
+    assert_int_equal(atomic_load(&late.count), 1);
+    assert_true(atomic_load(&early.first_fire_us) < atomic_load(&late.first_fire_us));
+}
+
+static void test_timer_wrong_args( void ** state ) {
+    (void) state;
+
+    fire_record_t record = {0};
+    timer_id_t id;
+    assert_int_equal(timer_service_start_oneshot(10, NULL, &record, &id), RES_ERR_NULL_PTR);
+    assert_int_equal(timer_service_start_oneshot(10, record_callback, &record, NULL), RES_ERR_NULL_PTR);
+    assert_int_equal(timer_service_start_periodic(0, record_callback, &record, &id), RES_ERR_WRONG_ARGS);
+    assert_int_equal(timer_service_stop(TIMER_ID_INVALID), RES_ERR_WRONG_ARGS);
+}
+
+static void test_timer_pool_exhausted( void ** state ) {
+    (void) state;
+
+    fire_record_t record = {0};
+    timer_id_t ids[TIMER_SERVICE_MAX_TIMERS];
+    for( int i = 0; i < TIMER_SERVICE_MAX_TIMERS; i++ ) {
+        assert_int_equal(timer_service_start_oneshot(10000, record_callback, &record, &ids[i]), RES_OK);
+    }
+
+    timer_id_t id;
+    assert_int_equal(timer_service_start_oneshot(10000, record_callback, &record, &id), 
+        RES_ERR_INVALID_SIZE);
+
+    for( int i = 0; i < TIMER_SERVICE_MAX_TIMERS; i++ ) {
+        assert_int_equal(timer_service_stop(ids[i]), RES_OK);
+    }
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_timer_oneshot_fires_once),
+        cmocka_unit_test(test_timer_periodic_fires_repeatedly),
+        cmocka_unit_test(test_timer_stop_before_expiry),
+        cmocka_unit_test(test_timer_stop_waits_for_running_callback),
+        cmocka_unit_test(test_timer_stop_from_own_callback),
+        cmocka_unit_test(test_timer_long_delay_cascades),
+        cmocka_unit_test(test_timer_oneshots_fire_in_order),
+        cmocka_unit_test(test_timer_wrong_args),
+        cmocka_unit_test(test_timer_pool_exhausted),
+    };
+
+    return cmocka_run_group_tests(tests, group_setup, NULL);
+}
@@ -0,0 +1,52 @@
+/**
+ *******************************************************************************
+ * @file    temp_file.c
+ * @brief   Temporary file test fixture source file.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "utils.h"
+#include "temp_file.h"
+
+/******************************
+ * PRIVATE MACROS AND DEFINES *
+ ******************************/
+
+#define PATH_TEMPLATE       "/tmp/pitalkster_test_XXXXXX"
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static char g_path[] = PATH_TEMPLATE;
+
+/********************
+ * GLOBAL FUNCTIONS *
+ ********************/
+
+int temp_file_setup( void ** state UNUSED_PARAM ) {
+    memcpy(g_path, PATH_TEMPLATE, sizeof(g_path));
+    int fd = mkstemp(g_path);
+    if( fd < 0 ) {
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+int temp_file_teardown( void ** state UNUSED_PARAM ) {
+    unlink(g_path);
+    return 0;
+}
+
+const char * temp_file_path( void ) {
+    return g_path;
+}
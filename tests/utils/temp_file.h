@@ -0,0 +1,38 @@
+/**
+ *******************************************************************************
+ * @file    temp_file.h
+ * @brief   Temporary file test fixture header file.
+ *          Setup creates empty file with unique name in /tmp, teardown
+ *          removes it. Both match cmocka fixture signature.
+ *******************************************************************************
+ */
+
+#ifndef TEMP_FILE_H
+#define TEMP_FILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************
+ * MACROS AND DEFINES *
+ **********************/
+
+#define TEMP_FILE_UNIT_TEST(f) \
+    cmocka_unit_test_setup_teardown(f, temp_file_setup, temp_file_teardown)
+
+/******************************
+ * GLOBAL FUNCTION PROTOTYPES *
+ ******************************/
+
+extern int temp_file_setup( void ** state );
+extern int temp_file_teardown( void ** state );
+
+// Valid between setup and teardown, test may remove and recreate the file
+extern const char * temp_file_path( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEMP_FILE_H */
@@ -0,0 +1,89 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "cancel_token.h"
+
+static bool is_fd_readable( int fd ) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+    return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+static void test_cancel_token_init( void ** state ) {
+    (void) state;
+
+    cancel_token_t token;
+    assert_int_equal(cancel_token_init(&token), RES_OK);
+    assert_false(cancel_token_is_cancelled(&token));
+    assert_true(cancel_token_fd(&token) >= 0);
+    assert_false(is_fd_readable(cancel_token_fd(&token)));
+
+    cancel_token_deinit(&token);
+    assert_int_equal(cancel_token_fd(&token), -1);
+}
+
+static void test_cancel_token_cancel_wakes_fd( void ** state ) {
+    (void) state;
+
+    cancel_token_t token;
+    assert_int_equal(cancel_token_init(&token), RES_OK);
+
+    assert_int_equal(cancel_token_cancel(&token), RES_OK);
+    assert_true(cancel_token_is_cancelled(&token));
+    assert_true(is_fd_readable(cancel_token_fd(&token)));
+
+    // Second cancel keeps token cancelled
+    assert_int_equal(cancel_token_cancel(&token), RES_OK);
+    assert_true(cancel_token_is_cancelled(&token));
+
+    cancel_token_deinit(&token);
+}
+
+static void test_cancel_token_reset( void ** state ) {
+    (void) state;
+
+    cancel_token_t token;
+    assert_int_equal(cancel_token_init(&token), RES_OK);
+
+    // Reset of not cancelled token is fine
+    assert_int_equal(cancel_token_reset(&token), RES_OK);
+    assert_false(cancel_token_is_cancelled(&token));
+
+    assert_int_equal(cancel_token_cancel(&token), RES_OK);
+    assert_int_equal(cancel_token_cancel(&token), RES_OK);
+    assert_int_equal(cancel_token_reset(&token), RES_OK);
+    assert_false(cancel_token_is_cancelled(&token));
+    assert_false(is_fd_readable(cancel_token_fd(&token)));
+
+    // Token can be reused after reset
+    assert_int_equal(cancel_token_cancel(&token), RES_OK);
+    assert_true(is_fd_readable(cancel_token_fd(&token)));
+
+    cancel_token_deinit(&token);
+}
+
+static void test_cancel_token_null( void ** state ) {
+    (void) state;
+
+    assert_int_equal(cancel_token_init(NULL), RES_ERR_NULL_PTR);
+    assert_int_equal(cancel_token_cancel(NULL), RES_ERR_NULL_PTR);
+    assert_int_equal(cancel_token_reset(NULL), RES_ERR_NULL_PTR);
+    assert_false(cancel_token_is_cancelled(NULL));
+    assert_int_equal(cancel_token_fd(NULL), -1);
+    cancel_token_deinit(NULL);
+}
+
+int main( void ) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_cancel_token_init),
+        cmocka_unit_test(test_cancel_token_cancel_wakes_fd),
+        cmocka_unit_test(test_cancel_token_reset),
+        cmocka_unit_test(test_cancel_token_null),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
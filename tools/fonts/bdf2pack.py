@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""Convert BDF bitmap font into font pack C source for src/display/font.h.
+
+Glyphs are trimmed to their ink columns (proportional advance, no kerning)
+and stored column by column, MSB on top, like the ST7789 driver fonts.
+Lookup table is a minimal perfect hash (hash and displace), so the device
+finds any code point with two hashes and one compare.
+
+Usage: bdf2pack.py <font.bdf> <name> <output.c> [--ranges 0x20-0x7E,...]
+"""
+
+import argparse
+import os
+import sys
+
+HASH_MUL = 0x9E3779B1
+BUCKET_LOAD = 4
+MAX_DISPLACEMENT = 1 << 24
+EMPTY_ADVANCE_DIV = 2
+SPACING = 1
+
+
+def font_hash(cp, seed):
+    # Must match font_hash() in src/display/font.c
+    h = ((cp ^ seed) * HASH_MUL) & 0xFFFFFFFF
+    return h ^ (h >> 15)
+
+
+def parse_ranges(text):
+    ranges = []
+    for part in text.split(','):
+        lo, _, hi = part.partition('-')
+        ranges.append((int(lo, 0), int(hi or lo, 0)))
+    return ranges
+
+
+def parse_bdf(path):
+    ascent = descent = None
+    glyphs = {}
+    with open(path, encoding='ascii') as f:
+        lines = iter(f.read().splitlines())
+
+    for line in lines:
+        key, _, value = line.partition(' ')
+        if key == 'FONT_ASCENT':
+            ascent = int(value)
+        elif key == 'FONT_DESCENT':
+            descent = int(value)
+        elif key == 'STARTCHAR':
+            glyph = {'name': value}
+            for line in lines:
+                key, _, value = line.partition(' ')
+                if key == 'ENCODING':
+                    glyph['cp'] = int(value.split()[0])
+                elif key == 'DWIDTH':
+                    glyph['dwidth'] = int(value.split()[0])
+                elif key == 'BBX':
+                    glyph['bbx'] = [int(v) for v in value.split()]
+                elif key == 'BITMAP':
+                    rows = []
+                    for line in lines:
+                        if line == 'ENDCHAR':
+                            break
+                        rows.append(int(line, 16) << (4 * (8 - len(line))))
+                    glyph['rows'] = rows
+                    break
+            if glyph.get('cp', -1) >= 0:
+                glyphs[glyph['cp']] = glyph
+
+    if ascent is None or descent is None:
+        sys.exit('%s: FONT_ASCENT and FONT_DESCENT are required' % path)
+    return ascent, descent, glyphs
+
+
+def rasterize(glyph, ascent, height):
+    w, h, xoff, yoff = glyph['bbx']
+    top = ascent - (yoff + h)
+    pixels = set()
+    for r, bits in enumerate(glyph['rows']):
+        for c in range(w):
+            if bits & (0x80000000 >> c):
+                x, y = xoff + c, top + r
+                if 0 <= y < height and x >= 0:
+                    pixels.add((x, y))
+    return pixels
+
+
+def encode(pixels, height):
+    col_bytes = (height + 7) // 8
+    if not pixels:
+        return 0, b''
+    xs = [x for x, _ in pixels]
+    left, width = min(xs), max(xs) - min(xs) + 1
+    data = bytearray(width * col_bytes)
+    for x, y in pixels:
+        data[(x - left) * col_bytes + y // 8] |= 0x80 >> (y % 8)
+    return width, bytes(data)
+
+
+def perfect_hash(cps):
+    n = len(cps)
+    bucket_count = max(1, (n + BUCKET_LOAD - 1) // BUCKET_LOAD)
+    buckets = [[] for _ in range(bucket_count)]
+    for cp in cps:
+        buckets[font_hash(cp, 0) % bucket_count].append(cp)
+
+    displacements = [0] * bucket_count
+    slots = [None] * n
+    for b in sorted(range(bucket_count), key=lambda i: -len(buckets[i])):
+        if not buckets[b]:
+            continue
+        for d in range(1, MAX_DISPLACEMENT):
+            taken = [font_hash(cp, d) % n for cp in buckets[b]]
+            if len(set(taken)) == len(taken) and all(slots[s] is None for s in taken):
+                for cp, s in zip(buckets[b], taken):
+                    slots[s] = cp
+                displacements[b] = d
+                break
+        else:
+            sys.exit('perfect hash not found, lower BUCKET_LOAD')
+    return displacements, slots
+
+
+def c_array(values, fmt, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join(fmt % v for v in values[i:i + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('bdf')
+    parser.add_argument('name', help='pack symbol is font_pack_<name>')
+    parser.add_argument('output')
+    parser.add_argument('--ranges', type=parse_ranges,
+                        help='code point subset, e.g. 0x20-0x7E,0xA0-0x17F')
+    args = parser.parse_args()
+
+    ascent, descent, glyphs = parse_bdf(args.bdf)
+    height = ascent + descent
+    if args.ranges:
+        glyphs = {cp: g for cp, g in glyphs.items()
+                  if any(lo <= cp <= hi for lo, hi in args.ranges)}
+    if not glyphs:
+        sys.exit('%s: no glyphs selected' % args.bdf)
+
+    encoded = {}
+    for cp, glyph in glyphs.items():
+        width, data = encode(rasterize(glyph, ascent, height), height)
+        advance = width + SPACING if width else max(2, glyph['dwidth'] // EMPTY_ADVANCE_DIV)
+        if width > 255 or advance > 255:
+            sys.exit('U+%04X is too wide' % cp)
+        encoded[cp] = (width, advance, data)
+
+    displacements, slots = perfect_hash(sorted(encoded))
+
+    bitmaps = bytearray()
+    entries = []
+    for cp in slots:
+        width, advance, data = encoded[cp]
+        entries.append('    { 0x%04X, %5d, %d, %d },   // %s' %
+                       (cp, len(bitmaps), width, advance, glyphs[cp]['name']))
+        bitmaps += data
+    if len(bitmaps) > 0xFFFF:
+        sys.exit('bitmaps exceed 64 KiB')
+
+    symbol = 'font_pack_%s' % args.name
+    source = os.path.basename(args.bdf)
+    out = '''/**
+ *******************************************************************************
+ * @file    {file}
+ * @brief   Font pack generated from {source} by tools/fonts/bdf2pack.py.
+ *          Don't edit by hand, run "make fonts" instead.
+ *******************************************************************************
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+#include "font.h"
+
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+static const uint32_t displacements[{bucket_count}] = {{
+{displacements}
+}};
+
+// Ordered by perfect hash slot
+static const font_glyph_t glyphs[{glyph_count}] = {{
+{entries}
+}};
+
+static const uint8_t bitmaps[{bitmaps_size}] = {{
+{bitmaps}
+}};
+
+/********************
+ * GLOBAL VARIABLES *
+ ********************/
+
+const font_pack_t {symbol} = {{
+    .height = {height},
+    .glyph_count = {glyph_count},
+    .bucket_count = {bucket_count},
+    .displacements = displacements,
+    .glyphs = glyphs,
+    .bitmaps = bitmaps
+}};
+'''.format(file=os.path.basename(args.output), source=source,
+           bucket_count=len(displacements), glyph_count=len(slots),
+           displacements=c_array(displacements, '%u', 8),
+           entries='\n'.join(entries), bitmaps_size=len(bitmaps),
+           bitmaps=c_array(list(bitmaps), '0x%02X', 12),
+           symbol=symbol, height=height)
+
+    with open(args.output, 'w', encoding='ascii') as f:
+        f.write(out)
+    print('%s: %d glyphs, %d bitmap bytes' % (symbol, len(slots), len(bitmaps)))
+
+
+if __name__ == '__main__':
+    main()